@@ -202,8 +202,10 @@ int main(int argc, char *argv[]) {
     // Wait for the interruption that signals the end of the monitor execution
     monitor_stop();  // When adc disabled
 
-    // Read number traces measurements stored in the BRAMS
-    unsigned int number_traces_samples = monitor_get_number_traces_measurements();
+    // Read number traces measurements stored in the BRAMS (single register snapshot)
+    struct monitorStatus_t status;
+    monitor_get_status(&status);
+    unsigned int number_traces_samples = status.traces_samples;
     printf("Number of traces samples : \t%d\n", number_traces_samples);
 
     if (monitor_read_traces(number_traces_samples + number_traces_samples%4) != 0){
@@ -216,11 +218,11 @@ int main(int argc, char *argv[]) {
     }
     printf("\n\n---------------------------------------\n\n\r");
 
-    unsigned elapsed_time = monitor_get_time();
+    unsigned elapsed_time = status.elapsed;
     printf("Elapsed time : \t%d\n\r", elapsed_time);
 
     // Store traces for further processing
-    fd_traces = open("SIG.BIN", O_WRONLY | O_CREAT, 0644);
+    fd_traces = open("SIG.BIN", O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if(fd_traces < 0){
         printf("Error! SIG file cannot be opened.\n\n");
     goto trace_open_err;
@@ -139,13 +139,13 @@ int unified_monitor_read() {
     printf("Elapsed time : \t%d\n\r", elapsed_time);
 
     // [UPM] Store power and traces for further processing
-    fd_power = open("CON.BIN", O_WRONLY | O_CREAT, 0644);
+    fd_power = open("CON.BIN", O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if(fd_power< 0){
         printf("Error! CON file cannot be opened.\n\n");
     goto monitor_err;
     }
     // Store traces for further processing
-    fd_traces = open("SIG.BIN", O_WRONLY | O_CREAT, 0644);
+    fd_traces = open("SIG.BIN", O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if(fd_traces < 0){
         printf("Error! SIG file cannot be opened.\n\n");
     goto trace_open_err;
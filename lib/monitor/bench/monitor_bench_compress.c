@@ -0,0 +1,201 @@
+/*
+ * Monitor traces compression benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark measures the compression ratio and the
+ *               compression and decompression throughput (MB/s of raw
+ *               trace records) of the traces codec, for 1 thread up to one
+ *               per online CPU. Traces are either synthetic or read from a
+ *               recorded traces file (e.g., SIG.BIN written by the demos).
+ *               No Monitor device is used.
+ *
+ * Usage       : monitor_bench_compress [-n records] [-i iterations] [-f traces_file [-a]]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "monitor.h"
+#include "monitor_traces.h"
+#include "monitor_compress.h"
+
+/*
+* Monotonic time in seconds
+*
+*/
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+* Synthetic capture function
+*
+* This function generates increasing timestamps with irregular gaps, and
+* probe toggles that are mostly single-probe, as in a typical capture.
+*
+*/
+static void bench_synthetic(void *traces, unsigned int ndata, int axi) {
+    struct monitorAxiTrace_t *axitraces = traces;
+    monitortdata_t *records = traces;
+    uint32_t ts = 0, probes, r;
+    unsigned int i;
+
+    srand(1);
+    for (i = 0; i < ndata; i++) {
+        r = rand();
+        ts += 1 + (r & 0xff);
+        if (i == 0) {
+            probes = rand();
+        }
+        else if ((r >> 8) % 16 == 0) {
+            probes = (1U << (rand() % 32)) | (1U << (rand() % 32)) | (1U << (rand() % 32));
+        }
+        else {
+            probes = 1U << ((r >> 12) % 32);
+        }
+        if (axi) {
+            axitraces[i].timestamp = ts;
+            axitraces[i].pad = 0;
+            axitraces[i].axi = (r >> 8) % 4 == 0 ? 1U << (r % 32) : 0;
+            axitraces[i].probes = probes;
+        }
+        else {
+            records[i] = ((monitortdata_t)probes << 32) | ts;
+        }
+    }
+}
+
+/*
+* Recorded capture function
+*
+* Return : number of trace records read, 0 on error
+*
+*/
+static unsigned int bench_recorded(const char *path, void **traces, int axi) {
+    size_t record_size = axi ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t);
+    unsigned int ndata;
+    long size;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    ndata = size > 0 ? size / record_size : 0;
+    *traces = malloc(ndata ? ndata * record_size : 1);
+    if (!*traces || fread(*traces, record_size, ndata, fp) != ndata) {
+        ndata = 0;
+    }
+    fclose(fp);
+
+    return ndata;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int ndata = 1 << 20;
+    unsigned int iterations = 16;
+    unsigned int threads, max_threads, i;
+    const char *path = NULL;
+    size_t raw_size, bound;
+    double t0, t_comp, t_decomp;
+    void *traces = NULL;
+    int opt, axi = 0, csize = 0;
+
+    while ((opt = getopt(argc, argv, "n:i:f:a")) != -1) {
+        switch (opt) {
+            case 'n': ndata = strtoul(optarg, NULL, 0); break;
+            case 'i': iterations = strtoul(optarg, NULL, 0); break;
+            case 'f': path = optarg; break;
+            case 'a': axi = 1; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n records] [-i iterations] [-f traces_file [-a]]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (path) {
+        ndata = bench_recorded(path, &traces, axi);
+        if (ndata == 0) {
+            fprintf(stderr, "could not read trace records from %s\n", path);
+            return 1;
+        }
+    }
+    else if (ndata == 0 || iterations == 0) {
+        fprintf(stderr, "records and iterations must be greater than 0\n");
+        return 1;
+    }
+    else {
+        traces = malloc(ndata * (axi ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t)));
+        if (!traces) {
+            fprintf(stderr, "malloc() failed\n");
+            return 1;
+        }
+        bench_synthetic(traces, ndata, axi);
+    }
+
+    raw_size = (size_t)ndata * (axi ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t));
+    bound = monitor_traces_compress_bound(ndata, axi);
+    void *compressed = malloc(bound);
+    void *decompressed = malloc(raw_size);
+    if (!compressed || !decompressed) {
+        fprintf(stderr, "malloc() failed\n");
+        return 1;
+    }
+
+    max_threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+
+    printf("traces: %s, records: %u (%s), iterations: %u\n", path ? path : "synthetic", ndata, axi ? "AXI" : "64-bit", iterations);
+    printf("%8s | %12s %12s | %14s %14s\n", "threads", "raw (B)", "ratio", "comp (MB/s)", "decomp (MB/s)");
+
+    for (threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        t0 = bench_now();
+        for (i = 0; i < iterations; i++) {
+            csize = monitor_traces_compress(traces, ndata, axi, compressed, bound, threads);
+        }
+        t_comp = bench_now() - t0;
+        if (csize < 0) {
+            fprintf(stderr, "monitor_traces_compress() failed (%d)\n", csize);
+            return 1;
+        }
+
+        memset(decompressed, 0, raw_size);
+        t0 = bench_now();
+        for (i = 0; i < iterations; i++) {
+            if (monitor_traces_decompress(compressed, csize, decompressed, ndata, threads) != (int)ndata) {
+                fprintf(stderr, "monitor_traces_decompress() failed\n");
+                return 1;
+            }
+        }
+        t_decomp = bench_now() - t0;
+
+        if (memcmp(traces, decompressed, raw_size)) {
+            fprintf(stderr, "roundtrip mismatch\n");
+            return 1;
+        }
+
+        printf("%8u | %12zu %12.2f | %14.1f %14.1f\n", threads, raw_size, (double)raw_size / csize,
+               (double)raw_size * iterations / t_comp / 1e6, (double)raw_size * iterations / t_decomp / 1e6);
+
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    free(traces);
+    free(compressed);
+    free(decompressed);
+
+    return 0;
+}
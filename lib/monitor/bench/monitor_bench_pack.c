@@ -0,0 +1,154 @@
+/*
+ * Monitor power pack benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark measures the throughput (samples/s) of the
+ *               power pack and unpack kernels, which store 12-bit ADC codes
+ *               8 samples in 12 bytes. It compares a plain per-pair loop
+ *               (2 samples in 3 bytes) against the library kernels (NEON or
+ *               AVX2, depending on the machine). No Monitor device is used.
+ *
+ * Usage       : monitor_bench_pack [-n samples] [-i iterations]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "monitor.h"
+#include "monitor_power.h"
+
+/*
+* Monotonic time in seconds
+*
+*/
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+* Per-pair pack function (reference)
+*
+*/
+static void bench_pack_loop(const monitorpdata_t *power, unsigned int ndata, uint8_t *packed) {
+    uint32_t even, odd;
+    unsigned int i;
+
+    for (i = 0; i < ndata; i += 2) {
+        even = power[i] & MONITOR_ADC_MASK;
+        odd = i + 1 < ndata ? power[i + 1] & MONITOR_ADC_MASK : 0;
+        *packed++ = even;
+        *packed++ = (even >> 8) | (odd << 4);
+        *packed++ = odd >> 4;
+    }
+}
+
+/*
+* Per-pair unpack function (reference)
+*
+*/
+static void bench_unpack_loop(const uint8_t *packed, unsigned int ndata, monitorpdata_t *power) {
+    unsigned int i;
+
+    for (i = 0; i < ndata; i += 2, packed += 3) {
+        power[i] = packed[0] | (packed[1] & 0xf) << 8;
+        if (i + 1 < ndata) {
+            power[i + 1] = (packed[1] >> 4) | packed[2] << 4;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int ndata = 1 << 20;
+    unsigned int iterations = 64;
+    unsigned int i;
+    double t0, t_pack_loop, t_pack, t_unpack_loop, t_unpack;
+    size_t packed_size;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:")) != -1) {
+        switch (opt) {
+            case 'n': ndata = strtoul(optarg, NULL, 0); break;
+            case 'i': iterations = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n samples] [-i iterations]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (ndata == 0 || iterations == 0) {
+        fprintf(stderr, "samples and iterations must be greater than 0\n");
+        return 1;
+    }
+
+    packed_size = monitor_power_packed_size(ndata);
+    monitorpdata_t *power = malloc(ndata * sizeof *power);
+    monitorpdata_t *power_ref = malloc(ndata * sizeof *power_ref);
+    monitorpdata_t *unpacked = malloc(ndata * sizeof *unpacked);
+    uint8_t *packed_ref = calloc(packed_size, 1);
+    uint8_t *packed = malloc(packed_size);
+    if (!power || !power_ref || !unpacked || !packed_ref || !packed) {
+        fprintf(stderr, "malloc() failed\n");
+        return 1;
+    }
+
+    // Synthetic capture (12-bit codes)
+    srand(1);
+    for (i = 0; i < ndata; i++) {
+        power[i] = rand() & MONITOR_ADC_MASK;
+    }
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        bench_pack_loop(power, ndata, packed_ref);
+    }
+    t_pack_loop = bench_now() - t0;
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        monitor_power_pack(power, ndata, packed);
+    }
+    t_pack = bench_now() - t0;
+
+    if (memcmp(packed, packed_ref, packed_size)) {
+        fprintf(stderr, "monitor_power_pack() output mismatch\n");
+        return 1;
+    }
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        bench_unpack_loop(packed, ndata, power_ref);
+    }
+    t_unpack_loop = bench_now() - t0;
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        monitor_power_unpack(packed, ndata, unpacked);
+    }
+    t_unpack = bench_now() - t0;
+
+    if (memcmp(unpacked, power, ndata * sizeof *power) || memcmp(power_ref, power, ndata * sizeof *power)) {
+        fprintf(stderr, "monitor_power_unpack() output mismatch\n");
+        return 1;
+    }
+
+    printf("samples: %u, iterations: %u, size: %zu -> %zu bytes (%.2fx)\n", ndata, iterations, ndata * sizeof *power, packed_size,
+           (double)(ndata * sizeof *power) / packed_size);
+    printf("%8s | %16s %16s | %8s\n", "", "loop (Msmp/s)", "kernel (Msmp/s)", "speedup");
+    printf("%8s | %16.1f %16.1f | %8.2f\n", "pack", (double)ndata * iterations / t_pack_loop / 1e6, (double)ndata * iterations / t_pack / 1e6, t_pack_loop / t_pack);
+    printf("%8s | %16.1f %16.1f | %8.2f\n", "unpack", (double)ndata * iterations / t_unpack_loop / 1e6, (double)ndata * iterations / t_unpack / 1e6, t_unpack_loop / t_unpack);
+
+    free(power);
+    free(power_ref);
+    free(unpacked);
+    free(packed_ref);
+    free(packed);
+
+    return 0;
+}
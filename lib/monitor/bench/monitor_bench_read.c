@@ -0,0 +1,197 @@
+/*
+ * Monitor read benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark measures the per-read latency of the
+ *               Monitor power and traces drains for 64 to 131072 samples.
+ *               It compares the legacy read path (a DMA buffer is mapped
+ *               and unmapped on every read) against the library read path,
+ *               which reuses the staging buffers mapped at init. The
+ *               device is the default one (MONITOR_DEVICE when set), and
+ *               the legacy path is skipped on simulated devices.
+ *
+ * Usage       : monitor_bench_read [-p max_power] [-t max_traces] [-i iterations]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>  // mmap()
+#include <sys/ioctl.h> // ioctl()
+#include <sys/poll.h>  // poll()
+
+#include "drivers/monitor/monitor.h"
+#include "monitor.h"
+#include "monitor_hw.h"
+
+#define MIN_SAMPLES (64)
+
+#ifdef AU250
+int main() {
+    fprintf(stderr, "This benchmark targets the /dev/monitor DMA path (Zynq devices)\n");
+    return 1;
+}
+#else
+
+/*
+* Monotonic time in microseconds
+*
+*/
+static double bench_now_us() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+* Legacy read function
+*
+* This function reproduces the read path used before the staging buffers
+* were introduced: map a DMA buffer, transfer, copy and unmap.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int bench_legacy_read(int fd, unsigned long cmd, void *hwaddr, off_t offset, void *dst, size_t size) {
+    struct dmaproxy_token token;
+    struct pollfd pfd = { .fd = fd, .events = POLLDMA, };
+    void *mem;
+
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if (mem == MAP_FAILED) {
+        return -ENOMEM;
+    }
+
+    token.memaddr = mem;
+    token.memoff = 0x00000000;
+    token.hwaddr = hwaddr;
+    token.hwoff = 0x00000000;
+    token.size = size;
+    if (ioctl(fd, cmd, &token) < 0) {
+        munmap(mem, size);
+        return -errno;
+    }
+    poll(&pfd, 1, -1);
+
+    memcpy(dst, mem, size);
+    munmap(mem, size);
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int max_power = 131072;
+    unsigned int max_traces = 16384;
+    unsigned int iterations = 32;
+    unsigned int ndata, i;
+    double t0, t_legacy_p, t_staged_p, t_legacy_t, t_staged_t;
+    const char *devname;
+    monitor_t *monitor;
+    int opt, ret, fd = -1;
+
+    while ((opt = getopt(argc, argv, "p:t:i:")) != -1) {
+        switch (opt) {
+            case 'p': max_power = strtoul(optarg, NULL, 0); break;
+            case 't': max_traces = strtoul(optarg, NULL, 0); break;
+            case 'i': iterations = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "Usage: %s [-p max_power] [-t max_traces] [-i iterations]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    monitor = monitor_dev_open_capacity(NULL, max_power, max_traces);
+    if (!monitor) {
+        fprintf(stderr, "monitor_dev_open_capacity() failed\n");
+        return 1;
+    }
+    monitorpdata_t *power  = monitor_dev_alloc(monitor, max_power, "power", MONITOR_REG_POWER);
+    monitortdata_t *traces = monitor_dev_alloc(monitor, max_traces, "traces", MONITOR_REG_TRACES);
+    if (!power || !traces) {
+        fprintf(stderr, "monitor_dev_alloc() failed\n");
+        return 1;
+    }
+
+    // Second descriptor for the legacy path (same process, same driver lists)
+    if (!monitor->sim) {
+        devname = getenv("MONITOR_DEVICE");
+        if (!devname || !*devname) {
+            devname = MONITOR_DEFAULT_DEVICE;
+        }
+        fd = open(devname, O_RDWR);
+        if (fd < 0) {
+            fprintf(stderr, "open() %s failed\n", devname);
+            return 1;
+        }
+    }
+    else {
+        printf("simulated device: legacy path skipped\n");
+    }
+
+    printf("%10s | %14s %14s | %14s %14s\n", "samples", "power old(us)", "power new(us)", "traces old(us)", "traces new(us)");
+
+    for (ndata = MIN_SAMPLES; ndata <= max_power || ndata <= max_traces; ndata <<= 1) {
+        // A size that cannot be read (e.g., beyond the memory bank depth) is reported as -1
+        t_legacy_p = t_staged_p = t_legacy_t = t_staged_t = -1.0;
+
+        if (ndata <= max_power) {
+            if (fd >= 0) {
+                t0 = bench_now_us();
+                for (i = 0, ret = 0; i < iterations && !ret; i++) {
+                    ret = bench_legacy_read(fd, MONITOR_IOC_DMA_HW2MEM_POWER, (void *)MONITOR_POWER_ADDR, sysconf(_SC_PAGESIZE), power, ndata * sizeof *power);
+                }
+                if (!ret) {
+                    t_legacy_p = (bench_now_us() - t0) / iterations;
+                }
+            }
+
+            t0 = bench_now_us();
+            for (i = 0, ret = 0; i < iterations && !ret; i++) {
+                ret = monitor_dev_read_power_consumption(monitor, ndata);
+            }
+            if (!ret) {
+                t_staged_p = (bench_now_us() - t0) / iterations;
+            }
+        }
+
+        if (ndata <= max_traces) {
+            if (fd >= 0) {
+                t0 = bench_now_us();
+                for (i = 0, ret = 0; i < iterations && !ret; i++) {
+                    ret = bench_legacy_read(fd, MONITOR_IOC_DMA_HW2MEM_TRACES, (void *)MONITOR_TRACES_ADDR, 2 * sysconf(_SC_PAGESIZE), traces, ndata * sizeof *traces);
+                }
+                if (!ret) {
+                    t_legacy_t = (bench_now_us() - t0) / iterations;
+                }
+            }
+
+            t0 = bench_now_us();
+            for (i = 0, ret = 0; i < iterations && !ret; i++) {
+                ret = monitor_dev_read_traces(monitor, ndata);
+            }
+            if (!ret) {
+                t_staged_t = (bench_now_us() - t0) / iterations;
+            }
+        }
+
+        printf("%10u | %14.2f %14.2f | %14.2f %14.2f\n", ndata, t_legacy_p, t_staged_p, t_legacy_t, t_staged_t);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    monitor_dev_free(monitor, "power");
+    monitor_dev_free(monitor, "traces");
+    monitor_dev_close(monitor);
+
+    return 0;
+}
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Monitor session benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark runs repeated captures through a capture
+ *               session and reports the time spent in every stage, and the
+ *               overhead between the end of a capture and the re-arm of
+ *               the next one. Captures have to be triggered by the
+ *               hardware (see the -m mask). With -l, it also reports the
+ *               readout stage latencies of the Monitor instance. On a
+ *               synthetic simulated device (MONITOR_DEVICE=sim), the start
+ *               and drain stages include generating the synthetic traces
+ *               and power samples; replaying an archive recorded with -a
+ *               (MONITOR_DEVICE=replay:<archive>) leaves that cost out.
+ *
+ * Usage       : monitor_bench_session [-n captures] [-p power_capacity] [-t traces_capacity] [-m mask] [-a archive] [-l]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "monitor.h"
+#include "monitor_session.h"
+#include "monitor_latency.h"
+
+/*
+* Capture callback (touches every sample once)
+*
+*/
+static int bench_capture(const struct monitorSessionCapture_t *capture, void *arg) {
+    uint64_t *checksum = arg;
+    const monitorpdata_t *power = capture->power.data;
+    const monitortdata_t *traces = capture->traces.data;
+    unsigned int i;
+
+    for (i = 0; power && i < capture->power.ndata; i++) {
+        *checksum += power[i];
+    }
+    for (i = 0; traces && i < capture->traces.ndata; i++) {
+        *checksum += traces[i];
+    }
+
+    return 0;
+}
+
+/*
+* Latency report (per-stage counters and the median bucket of the histogram)
+*
+*/
+static void bench_latency(monitor_t *monitor) {
+    static const char *names[MONITOR_STAGES] = {"irq", "dma setup", "dma wait", "copy", "write"};
+    struct monitorLatencyStats_t latency;
+    const struct monitorStageStats_t *stage;
+    uint64_t seen;
+    unsigned int i, b;
+
+    if (monitor_dev_latency_stats(monitor, &latency) != 0) {
+        return;
+    }
+    printf("%10s | %8s %12s %12s %12s %14s\n", "latency", "count", "avg (us)", "min (us)", "max (us)", "median (us)");
+    for (i = 0; i < MONITOR_STAGES; i++) {
+        stage = &latency.stage[i];
+        if (!stage->count) {
+            continue;
+        }
+        for (b = 0, seen = 0; b < MONITOR_LATENCY_BUCKETS - 1; b++) {
+            seen += stage->histogram[b];
+            if (2 * seen >= stage->count) {
+                break;
+            }
+        }
+        printf("%10s | %8llu %12.2f %12.2f %12.2f %6.1f-%-7.1f\n", names[i], (unsigned long long)stage->count, (double)stage->sum / stage->count / 1e3,
+               stage->min / 1e3, stage->max / 1e3, (1ULL << b) / 1e3, (2ULL << b) / 1e3);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    struct monitorSessionConfig_t config = {
+        .power_capacity = 131072, .traces_capacity = 16384, .mask = 0x1,
+    };
+    struct monitorSessionStats_t stats;
+    struct monitorSession_t session;
+    unsigned int captures = 100;
+    uint64_t checksum = 0;
+    int latency = 0;
+    double n;
+    int opt, ret;
+
+    while ((opt = getopt(argc, argv, "n:p:t:m:a:l")) != -1) {
+        switch (opt) {
+            case 'n': captures = strtoul(optarg, NULL, 0); break;
+            case 'p': config.power_capacity = strtoul(optarg, NULL, 0); break;
+            case 't': config.traces_capacity = strtoul(optarg, NULL, 0); break;
+            case 'm': config.mask = strtoul(optarg, NULL, 0); break;
+            case 'a': config.archive = optarg; break;
+            case 'l': latency = 1; break;
+            default:
+                fprintf(stderr, "Usage: %s [-n captures] [-p power_capacity] [-t traces_capacity] [-m mask] [-a archive] [-l]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (monitor_session_open(&session, NULL, &config) != 0) {
+        fprintf(stderr, "monitor_session_open() failed\n");
+        return 1;
+    }
+    if (latency && monitor_dev_latency_enable(session.monitor, 0) != 0) {
+        fprintf(stderr, "monitor_dev_latency_enable() failed\n");
+        monitor_session_close(&session);
+        return 1;
+    }
+
+    ret = monitor_session_run(&session, captures, NULL, bench_capture, &checksum);
+    if (ret < 0) {
+        fprintf(stderr, "monitor_session_run() failed (%d)\n", ret);
+        monitor_session_close(&session);
+        return 1;
+    }
+
+    monitor_session_stats(&session, &stats);
+    if (latency) {
+        bench_latency(session.monitor);
+    }
+    monitor_session_close(&session);
+
+    n = stats.captures ? stats.captures : 1;
+    printf("captures: %u (checksum %llx)\n", stats.captures, (unsigned long long)checksum);
+    printf("%10s | %12s\n", "stage", "avg (us)");
+    printf("%10s | %12.2f\n", "start", stats.start_sum / n / 1e3);
+    printf("%10s | %12.2f\n", "wait", stats.wait_sum / n / 1e3);
+    printf("%10s | %12.2f\n", "drain", stats.drain_sum / n / 1e3);
+    printf("%10s | %12.2f\n", "callback", stats.callback_sum / n / 1e3);
+    printf("%10s | %12.2f\n", "archive", stats.archive_sum / n / 1e3);
+    printf("%10s | %12.2f\n", "clean", stats.clean_sum / n / 1e3);
+    if (stats.captures > 1) {
+        printf("re-arm overhead (us): avg %.2f, min %.2f, max %.2f\n", stats.overhead_sum / (n - 1) / 1e3,
+               stats.overhead_min / 1e3, stats.overhead_max / 1e3);
+    }
+
+    return 0;
+}
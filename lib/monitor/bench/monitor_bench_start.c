@@ -0,0 +1,117 @@
+/*
+ * Monitor start benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark measures the latency and the CPU cost of
+ *               starting an acquisition right after the previous one has
+ *               been stopped and cleaned (i.e., while the Monitor is still
+ *               clearing its memory banks and waiting for the ADC). It compares the
+ *               legacy start (spinning on the busy flag) against
+ *               monitor_start(), which backs off while the Monitor is busy.
+ *               On a simulated device, a lower speed stretches the busy
+ *               time (e.g., MONITOR_DEVICE=sim:speed=0.01 for about 1 ms).
+ *
+ * Usage       : monitor_bench_start [-i iterations]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "monitor.h"
+#include "monitor_hw.h"
+
+/*
+* Time in microseconds
+*
+*/
+static double bench_now_us(clockid_t clock) {
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+* Legacy start function
+*
+* This function reproduces the start used before the bounded backoff was
+* introduced: spin on the busy flag, then issue the start command (on the
+* register map, or on the simulated device).
+*
+*/
+static void bench_legacy_start(struct monitor *monitor) {
+    volatile uint32_t *hw = monitor->hw;
+
+    if (monitor->sim) {
+        while((monitor_sim_read(monitor->sim, MONITOR_REG0) & MONITOR_BUSY) > 0);
+        monitor_sim_write(monitor->sim, MONITOR_REG0, MONITOR_START);
+        return;
+    }
+    while((hw[MONITOR_REG0] & MONITOR_BUSY) > 0);
+    hw[MONITOR_REG0] = MONITOR_START;
+
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int iterations = 256;
+    unsigned int i, timeouts = 0;
+    double wall, cpu;
+    double wall_legacy = 0.0, cpu_legacy = 0.0, wall_new = 0.0, cpu_new = 0.0;
+    struct monitor *monitor;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:")) != -1) {
+        switch (opt) {
+            case 'i': iterations = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "Usage: %s [-i iterations]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (monitor_init() != 0) {
+        fprintf(stderr, "monitor_init() failed\n");
+        return 1;
+    }
+    monitor = monitor_get_default();
+
+    for (i = 0; i < iterations; i++) {
+        // Legacy start right after a stop and a clean (S_READ -> S_CLEAR -> S_ADC_BUSY -> S_IDLE,
+        // the stop ends the capture if it is still running)
+        monitor_stop();
+        monitor_clean();
+        wall = bench_now_us(CLOCK_MONOTONIC);
+        cpu = bench_now_us(CLOCK_THREAD_CPUTIME_ID);
+        bench_legacy_start(monitor);
+        cpu_legacy += bench_now_us(CLOCK_THREAD_CPUTIME_ID) - cpu;
+        wall_legacy += bench_now_us(CLOCK_MONOTONIC) - wall;
+
+        // Library start right after a stop and a clean
+        monitor_stop();
+        monitor_clean();
+        wall = bench_now_us(CLOCK_MONOTONIC);
+        cpu = bench_now_us(CLOCK_THREAD_CPUTIME_ID);
+        if (monitor_start() != 0) {
+            timeouts++;
+        }
+        cpu_new += bench_now_us(CLOCK_THREAD_CPUTIME_ID) - cpu;
+        wall_new += bench_now_us(CLOCK_MONOTONIC) - wall;
+    }
+    monitor_stop();
+    monitor_clean();
+
+    printf("%10s | %14s %14s %10s\n", "start", "latency(us)", "cpu(us)", "cpu/lat");
+    printf("%10s | %14.2f %14.2f %9.1f%%\n", "legacy", wall_legacy / iterations, cpu_legacy / iterations, 100.0 * cpu_legacy / wall_legacy);
+    printf("%10s | %14.2f %14.2f %9.1f%%\n", "backoff", wall_new / iterations, cpu_new / iterations, 100.0 * cpu_new / wall_new);
+    if (timeouts) {
+        printf("%u/%u starts timed out\n", timeouts, iterations);
+    }
+
+    monitor_exit();
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Monitor traces unpack benchmark
+ *
+ * Date        : October 2026
+ * Description : This benchmark measures the throughput (records/s) of the
+ *               trace unpack kernels, which split trace records into
+ *               timestamps, AXI and probes arrays. It compares a plain
+ *               per-record loop against the library kernels (NEON when
+ *               available, the same loop otherwise). No Monitor device is
+ *               used.
+ *
+ * Usage       : monitor_bench_unpack [-n records] [-i iterations]
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "monitor.h"
+#include "monitor_traces.h"
+
+/*
+* Monotonic time in seconds
+*
+*/
+static double bench_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+* Per-record unpack function (reference)
+*
+*/
+static void bench_unpack_loop(const monitortdata_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *probes) {
+    unsigned int i;
+
+    for (i = 0; i < ndata; i++) {
+        timestamps[i] = traces[i] & 0xffffffff;
+        probes[i] = traces[i] >> 32;
+    }
+}
+
+/*
+* Per-record AXI unpack function (reference)
+*
+*/
+static void bench_unpack_axi_loop(const struct monitorAxiTrace_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *axi, uint32_t *probes) {
+    unsigned int i;
+
+    for (i = 0; i < ndata; i++) {
+        timestamps[i] = traces[i].timestamp;
+        axi[i] = traces[i].axi;
+        probes[i] = traces[i].probes;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int ndata = 1 << 20;
+    unsigned int iterations = 64;
+    unsigned int i;
+    double t0, t_loop, t_simd, t_loop_axi, t_simd_axi;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:")) != -1) {
+        switch (opt) {
+            case 'n': ndata = strtoul(optarg, NULL, 0); break;
+            case 'i': iterations = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "Usage: %s [-n records] [-i iterations]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (ndata == 0 || iterations == 0) {
+        fprintf(stderr, "records and iterations must be greater than 0\n");
+        return 1;
+    }
+
+    monitortdata_t *traces = malloc(ndata * sizeof *traces);
+    struct monitorAxiTrace_t *axitraces = malloc(ndata * sizeof *axitraces);
+    uint32_t *ts_ref = malloc(ndata * sizeof *ts_ref);
+    uint32_t *ax_ref = malloc(ndata * sizeof *ax_ref);
+    uint32_t *pr_ref = malloc(ndata * sizeof *pr_ref);
+    uint32_t *ts = malloc(ndata * sizeof *ts);
+    uint32_t *ax = malloc(ndata * sizeof *ax);
+    uint32_t *pr = malloc(ndata * sizeof *pr);
+    if (!traces || !axitraces || !ts_ref || !ax_ref || !pr_ref || !ts || !ax || !pr) {
+        fprintf(stderr, "malloc() failed\n");
+        return 1;
+    }
+
+    // Synthetic capture (increasing timestamps, pseudo-random toggles)
+    srand(1);
+    for (i = 0; i < ndata; i++) {
+        axitraces[i].timestamp = i * 3 + 1;
+        axitraces[i].pad = 0;
+        axitraces[i].axi = rand();
+        axitraces[i].probes = rand();
+        traces[i] = ((monitortdata_t)axitraces[i].probes << 32) | axitraces[i].timestamp;
+    }
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        bench_unpack_loop(traces, ndata, ts_ref, pr_ref);
+    }
+    t_loop = bench_now() - t0;
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        monitor_traces_unpack(traces, ndata, ts, pr);
+    }
+    t_simd = bench_now() - t0;
+
+    if (memcmp(ts, ts_ref, ndata * sizeof *ts) || memcmp(pr, pr_ref, ndata * sizeof *pr)) {
+        fprintf(stderr, "monitor_traces_unpack() output mismatch\n");
+        return 1;
+    }
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        bench_unpack_axi_loop(axitraces, ndata, ts_ref, ax_ref, pr_ref);
+    }
+    t_loop_axi = bench_now() - t0;
+
+    t0 = bench_now();
+    for (i = 0; i < iterations; i++) {
+        monitor_traces_unpack_axi(axitraces, ndata, ts, ax, pr);
+    }
+    t_simd_axi = bench_now() - t0;
+
+    if (memcmp(ts, ts_ref, ndata * sizeof *ts) || memcmp(ax, ax_ref, ndata * sizeof *ax) || memcmp(pr, pr_ref, ndata * sizeof *pr)) {
+        fprintf(stderr, "monitor_traces_unpack_axi() output mismatch\n");
+        return 1;
+    }
+
+    printf("records: %u, iterations: %u, kernel: %s\n", ndata, iterations, monitor_traces_simd());
+    printf("%8s | %16s %16s | %8s\n", "records", "loop (Mrec/s)", "kernel (Mrec/s)", "speedup");
+    printf("%8s | %16.1f %16.1f | %8.2f\n", "64-bit", (double)ndata * iterations / t_loop / 1e6, (double)ndata * iterations / t_simd / 1e6, t_loop / t_simd);
+    printf("%8s | %16.1f %16.1f | %8.2f\n", "AXI", (double)ndata * iterations / t_loop_axi / 1e6, (double)ndata * iterations / t_simd_axi / 1e6, t_loop_axi / t_simd_axi);
+
+    free(traces);
+    free(axitraces);
+    free(ts_ref);
+    free(ax_ref);
+    free(pr_ref);
+    free(ts);
+    free(ax);
+    free(pr);
+
+    return 0;
+}
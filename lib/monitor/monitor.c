@@ -25,10 +25,16 @@
 #include <sys/ioctl.h> // ioctl()
 #include <sys/poll.h>  // poll()
 #include <sys/time.h>  // struct timeval, gettimeofday()
+#include <pthread.h>   // pthread_mutex_lock(), pthread_create(), pthread_join()
+#include <sys/eventfd.h> // eventfd()
 
 #include "drivers/monitor/monitor.h"
 #include "monitor.h"
 #include "monitor_hw.h"
+#include "monitor_traces.h"
+#include "monitor_file.h"
+#include "monitor_sim.h"
+#include "monitor_latency.h"
 #include "monitor_dbg.h"
 
 #include <inttypes.h>
@@ -37,21 +43,17 @@
 /*
 * Monitor global variables
 *
-* @monitor_hw : user-space map of Monitor hardware registers
-* @monitor_fd : /dev/monitor file descriptor (used to access kernels)
-*
-* @monitordata    : structure containing memory banks information
+* @monitor_default      : Monitor instance used by the handle-less API (monitor_init())
+* @monitor_default_lock : serializes monitor_init() and monitor_exit()
 *
 */
-static int monitor_fd;
-uint32_t *monitor_hw = NULL;
+static struct monitor *monitor_default = NULL;
+static pthread_mutex_t monitor_default_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int monitor_dma_wait(struct monitor *monitor, int timeout);
 #ifdef AU250
-uint32_t *monitor_CMS = NULL;
-static pthread_t *thread = NULL;
-int CMS_flag = 0;
-int num_power_measurements = 0;
+static void monitor_dev_CMS_stop(struct monitor *monitor);
 #endif
-static struct monitorData_t *monitordata = NULL;
 
 #ifdef AU250
 /**
@@ -130,20 +132,169 @@ ssize_t read_to_buffer(char *fname, int fd, char *buffer, uint64_t size,
 #endif
 
 /*
-* Monitor init function
+* Monitor staging buffer release function
 *
-* This function sets up the basic software entities required to manage
-* the Monitor low-level functionality (DMA transfers, registers access, etc.).
+* This function releases a persistent DMA staging buffer.
+*
+* @monitor : Monitor instance the staging buffer belongs to
+* @staging : staging buffer to be released
+*
+*/
+static void monitor_staging_release(struct monitor *monitor, struct monitorStaging_t *staging) {
+
+    if (!staging->mem) {
+        return;
+    }
+
+    #ifdef AU250
+    (void)monitor;
+    free(staging->mem);
+    #else
+    if (monitor->sim) {
+        free(staging->mem);
+    }
+    else {
+        munmap(staging->mem, staging->size);
+    }
+    #endif
+    staging->mem = NULL;
+    staging->size = 0;
+    staging->viewed = 0;
+
+}
+
+/*
+* Monitor staging buffer reservation function
+*
+* This function makes sure that a persistent DMA staging buffer is able
+* to hold at least @size bytes. The buffer is only (re)mapped when it
+* does not exist yet or when it is too small, so that repeated reads do
+* not pay for the kernel-side allocation and page-table setup.
+*
+* @monitor : Monitor instance the staging buffer belongs to
+* @staging : staging buffer to be reserved
+* @size    : minimum number of bytes required
+* @offset  : mmap() offset that selects the memory bank in the driver
 *
 * Return : 0 on success, error code otherwise
+*
 */
-int monitor_init() {
+static int monitor_staging_reserve(struct monitor *monitor, struct monitorStaging_t *staging, size_t size, off_t offset) {
+    size_t pagesize = sysconf(_SC_PAGESIZE);
+    void *mem = NULL;
+
+    if (size == 0) {
+        return -EINVAL;
+    }
+
+    // Reuse the current buffer whenever it is big enough
+    if (staging->mem && staging->size >= size) {
+        return 0;
+    }
+
+    // Round up to a whole number of pages (mmap() granularity)
+    size = (size + pagesize - 1) & ~(pagesize - 1);
+
     #ifdef AU250
-    const char *filename = "/dev/xdma0_user";
+    (void)monitor;
+    (void)offset;
+    if (posix_memalign(&mem, pagesize, size) != 0) {
+        monitor_print_error("[monitor-hw] posix_memalign() failed\n");
+        return -ENOMEM;
+    }
     #else
-    const char *filename = "/dev/monitor";
+    // The simulated DMA engine copies into plain memory
+    if (monitor->sim) {
+        if (posix_memalign(&mem, pagesize, size) != 0) {
+            monitor_print_error("[monitor-hw] posix_memalign() failed\n");
+            return -ENOMEM;
+        }
+    }
+    else {
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, monitor->fd, offset);
+        if (mem == MAP_FAILED) {
+            monitor_print_error("[monitor-hw] mmap() failed\n");
+            return -ENOMEM;
+        }
+    }
     #endif
-    int ret;
+
+    // Release the previous (smaller) buffer
+    monitor_staging_release(monitor, staging);
+
+    staging->mem = mem;
+    staging->size = size;
+    monitor_print_debug("[monitor-hw] staging buffer=%p | size=%zu\n", staging->mem, staging->size);
+
+    return 0;
+}
+
+#ifdef AU250
+/*
+* Monitor XDMA card-to-host device name function
+*
+* This function derives the card-to-host DMA device of an XDMA card from
+* its user (registers) device, e.g. /dev/xdma1_user -> /dev/xdma1_c2h_0.
+*
+* @devname : XDMA user device file name
+*
+* Return : newly allocated device file name on success, NULL otherwise
+*
+*/
+static char *monitor_c2h_name(const char *devname) {
+    const char *suffix = "_user";
+    size_t len = strlen(devname);
+    char *c2h;
+
+    if (len < strlen(suffix) || strcmp(devname + len - strlen(suffix), suffix) != 0) {
+        monitor_print_error("[monitor-hw] %s is not an XDMA user device\n", devname);
+        return NULL;
+    }
+
+    c2h = malloc(len - strlen(suffix) + strlen("_c2h_0") + 1);
+    if (!c2h) {
+        return NULL;
+    }
+    memcpy(c2h, devname, len - strlen(suffix));
+    strcpy(c2h + len - strlen(suffix), "_c2h_0");
+
+    return c2h;
+}
+#endif
+
+/*
+* Monitor transfer completion function
+*
+* Return : 1 if DMA completion is signaled through an eventfd (XDMA and
+*          simulated devices), 0 if through POLLDMA on the Monitor device
+*
+*/
+static inline int monitor_transfer_eventfd(struct monitor *monitor) {
+
+    #ifdef AU250
+    (void)monitor;
+    return 1;
+    #else
+    return monitor->sim != NULL;
+    #endif
+
+}
+
+/*
+* Monitor device map function
+*
+* This function opens the Monitor device file and maps the Monitor
+* registers (and the CMS registers on Alveo devices), or creates the
+* simulated device that stands for all of them.
+*
+* @monitor : Monitor instance
+* @devname : Monitor device file name
+* @sim     : simulated device configuration (NULL for the hardware)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_device_map(struct monitor *monitor, const char *devname, const struct monitorSimConfig_t *sim) {
 
     /*
     * NOTE: this function relies on predefined addresses for both control
@@ -165,271 +316,2033 @@ int monitor_init() {
     *
     */
 
-    // Open Monitor device file
-    monitor_fd = open(filename, O_RDWR);
-    if (monitor_fd < 0) {
-        monitor_print_error("[monitor-hw] open() %s failed\n", filename);
+    // Simulated device (no device file, see monitor_sim.c)
+    if (sim) {
+        monitor->sim = monitor_sim_create(sim);
+        if (!monitor->sim) {
+            return -ENODEV;
+        }
+        monitor->fd = -1;
+        monitor->hw = monitor_sim_regs(monitor->sim);
+        #ifdef AU250
+        // Simulated CMS registers (constant 12 V, 4 A board power)
+        monitor->cms = calloc(0x40000, 1);
+        if (!monitor->cms) {
+            monitor_sim_destroy(monitor->sim);
+            monitor->sim = NULL;
+            return -ENOMEM;
+        }
+        monitor->cms[40960 + 58] = 12;
+        monitor->cms[40960 + 61] = 4;
+        #endif
+        monitor_print_debug("[monitor-hw] simulated monitor\n");
+        return 0;
+    }
+
+    #ifdef AU250
+    monitor->c2h = monitor_c2h_name(devname);
+    if (!monitor->c2h) {
         return -ENODEV;
     }
-    monitor_print_debug("[monitor-hw] monitor_fd=%d | dev=%s\n", monitor_fd, filename);
+    #endif
+
+    // Open Monitor device file
+    monitor->fd = open(devname, O_RDWR);
+    if (monitor->fd < 0) {
+        monitor_print_error("[monitor-hw] open() %s failed\n", devname);
+        goto err_open;
+    }
+    monitor_print_debug("[monitor-hw] monitor_fd=%d | dev=%s\n", monitor->fd, devname);
 
     // Obtain access to physical memory map using mmap()
     #ifdef AU250
-    monitor_hw = mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, monitor_fd, 0x2410000);
+    monitor->hw = mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, monitor->fd, 0x2410000);
     #else
-    monitor_hw = mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, monitor_fd, 0);
+    monitor->hw = mmap(NULL, 0x10000, PROT_READ | PROT_WRITE, MAP_SHARED, monitor->fd, 0);
     #endif
-    if (monitor_hw == MAP_FAILED) {
+    if (monitor->hw == MAP_FAILED) {
         monitor_print_error("[monitor-hw] mmap() failed\n");
-        ret = -ENOMEM;
         goto err_mmap;
     }
-    monitor_print_debug("[monitor-hw] monitor_hw=%p\n", monitor_hw);
+    monitor_print_debug("[monitor-hw] monitor_hw=%p\n", monitor->hw);
 
     #ifdef AU250
-    // Memory map the device
-    monitor_CMS = mmap (NULL , 0x40000 , PROT_READ | PROT_WRITE , MAP_SHARED , monitor_fd , 0x1000000);
-    if (monitor_CMS == MAP_FAILED){
-        perror ("mmap()");
-        close(monitor_fd);
-        return EXIT_FAILURE ;
-    }
-    if (monitor_CMS == MAP_FAILED) {
+    // Memory map the CMS
+    monitor->cms = mmap(NULL, 0x40000, PROT_READ | PROT_WRITE, MAP_SHARED, monitor->fd, 0x1000000);
+    if (monitor->cms == MAP_FAILED) {
         monitor_print_error("[monitor-hw] mmap() failed\n");
-        ret = -ENOMEM;
-        goto err_mmap;
+        goto err_mmap_cms;
     }
-    monitor_print_debug("[monitor-hw] monitor_CMS=%p\n", monitor_CMS);
+    monitor_print_debug("[monitor-hw] monitor_CMS=%p\n", monitor->cms);
     #endif
 
-    // Initialize regions structure
-    monitordata = malloc(sizeof *monitordata);
-    if (!monitordata) {
-        monitor_print_error("[monitor-hw] malloc() failed\n");
-        ret = -ENOMEM;
-        goto err_malloc_monitordata;
-    }
-    monitordata->power = NULL;
-    monitordata->traces = NULL;
-    monitor_print_debug("[monitor-hw] monitordata=%p\n", monitordata);
-
     return 0;
 
-err_malloc_monitordata:
-    munmap(monitor_hw, 0x10000);
+#ifdef AU250
+err_mmap_cms:
+    munmap(monitor->hw, 0x10000);
+#endif
+err_mmap:
+    close(monitor->fd);
+err_open:
     #ifdef AU250
-    munmap(monitor_CMS, 0x40000);
+    free(monitor->c2h);
+    monitor->c2h = NULL;
     #endif
-err_mmap:
-    close(monitor_fd);
 
-    return ret;
+    return -ENODEV;
 }
 
 /*
-* Monitor exit function
+* Monitor device unmap function
 *
-* This function cleans the software entities created by monitor_init().
+* This function releases what monitor_device_map() set up.
+*
+* @monitor : Monitor instance
 *
 */
-void monitor_exit() {
-
-    // Release allocated memory for monitordata
-    free(monitordata);
+static void monitor_device_unmap(struct monitor *monitor) {
+
+    if (monitor->sim) {
+        #ifdef AU250
+        free(monitor->cms);
+        #endif
+        monitor_sim_destroy(monitor->sim);
+        monitor->sim = NULL;
+        return;
+    }
 
     // Release memory obtained with mmap()
-    munmap(monitor_hw, 0x10000);
+    munmap(monitor->hw, 0x10000);
     #ifdef AU250
-    munmap(monitor_CMS, 0x40000);
+    munmap(monitor->cms, 0x40000);
+    if (monitor->c2h_fd >= 0) {
+        close(monitor->c2h_fd);
+    }
+    free(monitor->c2h);
     #endif
 
-    // Close ARTICo3 device file
-    close(monitor_fd);
+    // Close Monitor device file
+    close(monitor->fd);
+
 }
 
 /*
-* Monitor normal voltage reference configuration function
+* Monitor instance open function
 *
-* This function sets the monitor ADC voltage reference to 2.5V.
+* This function sets up a Monitor instance on top of a device (or of a
+* simulated device) and maps its persistent DMA staging buffers.
+*
+* @devname         : Monitor device file name
+* @sim             : simulated device configuration (NULL for the hardware)
+* @power_capacity  : maximum number of power samples to be read (0 to map on first read)
+* @traces_capacity : maximum number of traces samples to be read (0 to map on first read)
+*
+* Return : Monitor handle on success, NULL otherwise
 *
 */
-void monitor_config_vref(){
+static monitor_t *monitor_open(const char *devname, const struct monitorSimConfig_t *sim, unsigned int power_capacity, unsigned int traces_capacity) {
+    struct monitor *monitor;
+
+    // Initialize Monitor instance
+    monitor = malloc(sizeof *monitor);
+    if (!monitor) {
+        monitor_print_error("[monitor-hw] malloc() failed\n");
+        return NULL;
+    }
+    memset(monitor, 0, sizeof *monitor);
+    monitor->transfer.fd = -1;
+    pthread_mutex_init(&monitor->ctrl_lock, NULL);
+    pthread_mutex_init(&monitor->dma_lock, NULL);
+    pthread_mutex_init(&monitor->data_lock, NULL);
+    monitor->clock_hz = MONITOR_CLOCK_FREQ;
+    monitor->vref_mv = MONITOR_VREF_MV;
+    #ifdef AU250
+    monitor->c2h_fd = -1;
+    #endif
+
+    // Monitor registers (or simulated device)
+    if (monitor_device_map(monitor, devname, sim)) {
+        goto err_map;
+    }
+
+    // Initialize regions structure
+    monitor->data = malloc(sizeof *monitor->data);
+    if (!monitor->data) {
+        monitor_print_error("[monitor-hw] malloc() failed\n");
+        goto err_malloc_monitordata;
+    }
+    monitor->data->power = NULL;
+    monitor->data->traces = NULL;
+    monitor_print_debug("[monitor-hw] monitordata=%p\n", monitor->data);
+
+    // Completion descriptor for DMA transfers (POLLDMA on the Monitor device)
+    if (monitor_transfer_eventfd(monitor)) {
+        monitor->transfer.fd = eventfd(0, EFD_CLOEXEC);
+        if (monitor->transfer.fd < 0) {
+            monitor_print_error("[monitor-hw] eventfd() failed\n");
+            goto err_staging;
+        }
+    }
+    else {
+        monitor->transfer.fd = monitor->fd;
+    }
+    monitor->transfer.pending = 0;
+
+    // Map persistent DMA staging buffers (reused by every read)
+    #ifndef AU250
+    if (power_capacity) {
+        if (monitor_staging_reserve(monitor, &monitor->staging_power, power_capacity * sizeof(monitorpdata_t), sysconf(_SC_PAGESIZE))) {
+            goto err_staging;
+        }
+    }
+    #else
+    (void)power_capacity;
+    #endif
+    if (traces_capacity) {
+        if (monitor_staging_reserve(monitor, &monitor->staging_traces, traces_capacity * sizeof(monitortdata_t), 2 * sysconf(_SC_PAGESIZE))) {
+            goto err_staging;
+        }
+    }
 
-    monitor_hw_config_vref();
+    return monitor;
+
+err_staging:
+    monitor_staging_release(monitor, &monitor->staging_power);
+    monitor_staging_release(monitor, &monitor->staging_traces);
+    if (monitor_transfer_eventfd(monitor) && monitor->transfer.fd >= 0) {
+        close(monitor->transfer.fd);
+    }
+    free(monitor->data);
+
+err_malloc_monitordata:
+    monitor_device_unmap(monitor);
+err_map:
+    pthread_mutex_destroy(&monitor->ctrl_lock);
+    pthread_mutex_destroy(&monitor->dma_lock);
+    pthread_mutex_destroy(&monitor->data_lock);
+    free(monitor);
 
+    return NULL;
 }
 
 /*
-* Monitor double voltage reference configuration function
+* Monitor open function
 *
-* This function sets the monitor ADC voltage reference to 5V.
+* This function opens a Monitor instance and sets up the basic software
+* entities required to manage its low-level functionality (DMA transfers,
+* registers access, etc.).
+*
+* @devname : Monitor device file name (NULL for the default device)
+*
+* Return : Monitor handle on success, NULL otherwise
 *
 */
-void monitor_config_2vref(){
+monitor_t *monitor_dev_open(const char *devname) {
 
-    monitor_hw_config_2vref();
+    // Staging buffers are mapped on the first read
+    return monitor_dev_open_capacity(devname, 0, 0);
 
 }
 
 /*
-* Monitor CMS get power measurements function
+* Monitor open function (with capacity hints)
 *
-* This function get power measurements from CMS.
+* This function opens a Monitor instance, sets up the basic software
+* entities required to manage its low-level functionality, and maps the
+* persistent DMA staging buffers used by every subsequent read. The
+* default device can be overridden with the MONITOR_DEVICE environment
+* variable, "sim[:<options>]" opens a simulated device and
+* "replay:<file>[,<options>]" a simulated device that replays <file>.
+*
+* @devname         : Monitor device file name (NULL for the default device)
+* @power_capacity  : maximum number of power samples to be read (0 to map on first read)
+* @traces_capacity : maximum number of traces samples to be read (0 to map on first read)
+*
+* Return : Monitor handle on success, NULL otherwise
 *
 */
-void monitor_CMS_get_power_measurements(){
+monitor_t *monitor_dev_open_capacity(const char *devname, unsigned int power_capacity, unsigned int traces_capacity) {
+    struct monitorSimConfig_t sim;
+    size_t len = strlen(MONITOR_SIM_DEVICE);
+    size_t replay_len = strlen(MONITOR_REPLAY_DEVICE);
+    char *options;
+    int ret;
 
-    int max_data;
-    
-    uint32_t* CMS_reg = (monitor_CMS + 40960);
-    max_data =  monitordata->power->size / sizeof(monitorpdata_t);
+    if (!devname) {
+        devname = getenv("MONITOR_DEVICE");
+    }
+    if (!devname || !*devname) {
+        devname = MONITOR_DEFAULT_DEVICE;
+    }
 
-    while(CMS_flag == 1 && num_power_measurements < max_data){
-        // Read power consumption
-        ((monitorpdata_t *)monitordata->power->data)[num_power_measurements] = (CMS_reg[58]*CMS_reg[61]);
-        // Print power consumption
-        monitor_print_info("Board power consumption: %d W\n", ((monitorpdata_t *)monitordata->power->data)[num_power_measurements]);
-        num_power_measurements++;
+    // Simulated device ("sim" or "sim:<options>")
+    if (strncmp(devname, MONITOR_SIM_DEVICE, len) == 0 && (devname[len] == '\0' || devname[len] == ':')) {
+        monitor_sim_config_default(&sim);
+        if (monitor_sim_config_parse(devname[len] ? devname + len + 1 : NULL, &sim)) {
+            return NULL;
+        }
+        return monitor_open(devname, &sim, power_capacity, traces_capacity);
+    }
 
-        // Wait for the CMS to finish
-        usleep(120000);
+    // Replay ("replay:<file>[,<options>]" stands for "sim:replay=<file>[,<options>]")
+    if (strncmp(devname, MONITOR_REPLAY_DEVICE, replay_len) == 0 && devname[replay_len] == ':') {
+        options = malloc(strlen(devname) + 2);
+        if (!options) {
+            return NULL;
+        }
+        sprintf(options, "replay=%s", devname + replay_len + 1);
+        monitor_sim_config_default(&sim);
+        ret = monitor_sim_config_parse(options, &sim);
+        free(options);
+        if (ret) {
+            return NULL;
+        }
+        return monitor_open(devname, &sim, power_capacity, traces_capacity);
     }
 
+    return monitor_open(devname, NULL, power_capacity, traces_capacity);
 }
 
 /*
-* Monitor CMS start function
+* Monitor simulated device open function
 *
-* This function starts the CMS acquisition.
+* This function opens a simulated Monitor instance.
+*
+* @config          : simulated device configuration (NULL for the default one)
+* @power_capacity  : maximum number of power samples to be read (0 to allocate on first read)
+* @traces_capacity : maximum number of traces samples to be read (0 to allocate on first read)
+*
+* Return : Monitor handle on success, NULL otherwise
 *
 */
-void monitor_CMS_start(){
-
-    uint32_t* CMS_reset = (monitor_CMS + 32768);
+monitor_t *monitor_dev_open_sim(const struct monitorSimConfig_t *config, unsigned int power_capacity, unsigned int traces_capacity) {
+    struct monitorSimConfig_t sim;
 
-    //Disable reset
-    *CMS_reset = 1; 
-    CMS_flag = 1;
-
-    // Crear el hilo
-    if (pthread_create(&thread, NULL, monitor_CMS_get_power_measurements,NULL) != 0) {
-        perror("Error al crear el hilo");
-        return 1;
+    if (!config) {
+        monitor_sim_config_default(&sim);
+        config = &sim;
     }
 
+    return monitor_open(MONITOR_SIM_DEVICE, config, power_capacity, traces_capacity);
 }
 
 /*
-* Monitor start function
+* Monitor close function
 *
-* This function starts the monitor acquisition.
+* This function cleans the software entities created by monitor_dev_open()
+* and releases the Monitor instance. No other thread may be using it.
+*
+* @monitor : Monitor instance
 *
 */
-void monitor_start(){
+void monitor_dev_close(monitor_t *monitor) {
+
+    if (!monitor) {
+        return;
+    }
 
-    monitor_hw_start();
     #ifdef AU250
-    // Start CMS
-    monitor_CMS_start();
+    // The CMS thread keeps sampling into the power region until it is stopped
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_dev_CMS_stop(monitor);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
     #endif
 
+    // An asynchronous read may still be writing into the staging buffers
+    pthread_mutex_lock(&monitor->dma_lock);
+    if (monitor->transfer.pending) {
+        monitor_dma_wait(monitor, -1);
+    }
+    pthread_mutex_unlock(&monitor->dma_lock);
+
+    // Release persistent DMA staging buffers
+    monitor_staging_release(monitor, &monitor->staging_power);
+    monitor_staging_release(monitor, &monitor->staging_traces);
+    if (monitor_transfer_eventfd(monitor)) {
+        close(monitor->transfer.fd);
+    }
+
+    // Release allocated memory for monitordata
+    free(monitor->data);
+
+    // Release the Monitor registers (or the simulated device)
+    monitor_device_unmap(monitor);
+    monitor_latency_destroy(monitor->latency);
+
+    pthread_mutex_destroy(&monitor->ctrl_lock);
+    pthread_mutex_destroy(&monitor->dma_lock);
+    pthread_mutex_destroy(&monitor->data_lock);
+    free(monitor);
 }
 
 /*
-* Monitor clean function
+* Monitor normal voltage reference configuration function
 *
-* This function cleans the monitor memory banks.
+* This function sets the monitor ADC voltage reference to 2.5V.
+*
+* @monitor : Monitor instance
 *
 */
-void monitor_clean(){
+void monitor_dev_config_vref(monitor_t *monitor) {
 
-    monitor_hw_clean();
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_hw_config_vref(monitor);
+    monitor->vref_mv = MONITOR_VREF_MV;
+    pthread_mutex_unlock(&monitor->ctrl_lock);
 
 }
 
 /*
-* Monitor CMS stop function
+* Monitor double voltage reference configuration function
 *
-* This function stops the CMS acquisition.
+* This function sets the monitor ADC voltage reference to 5V.
+*
+* @monitor : Monitor instance
 *
 */
-void monitor_CMS_stop(){
-
-    uint32_t* CMS_reset = (monitor_CMS + 32768);
+void monitor_dev_config_2vref(monitor_t *monitor) {
 
-    //Disable reset & stop CMS
-    CMS_flag = 0;
-    *CMS_reset = 0; 
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_hw_config_2vref(monitor);
+    monitor->vref_mv = MONITOR_2VREF_MV;
+    pthread_mutex_unlock(&monitor->ctrl_lock);
 
-    // Wait for the thread to finish
-    if (pthread_join(thread, NULL) != 0) {
-        perror("Error al esperar a que el hilo termine");
-        return 1;
-    }
-    
 }
 
 /*
-* Monitor stop function
+* Monitor get voltage reference function
 *
-* This function stop the monitor acquisition. (only makes sense when power monitoring disabled)
+* This function gets the ADC voltage reference last configured.
+*
+* @monitor : Monitor instance
+*
+* Return : voltage reference in mV
 *
 */
-void monitor_stop(){
-    
-    // Return if monitor is already done, otherwise stop it
-    if (monitor_hw_isdone() == 1){
-        return;
-    }
-    monitor_hw_stop();
-    #ifdef AU250
-    // Stop CMS
-    monitor_CMS_stop();
-    #endif
+unsigned int monitor_dev_get_vref(monitor_t *monitor) {
+    unsigned int vref_mv;
 
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    vref_mv = monitor->vref_mv;
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    return vref_mv;
 }
 
+#ifdef AU250
 /*
-* Monitor set mask function
+* Monitor CMS get power measurements function
 *
-* @mask : Triggering mask
+* This function get power measurements from CMS.
 *
-* This function sets a mask used to decide which signals trigger the monitor execution.
+* @monitor : Monitor instance
 *
 */
-void monitor_set_mask(int mask){
+static void monitor_dev_CMS_get_power_measurements(struct monitor *monitor) {
+
+    struct monitorRegion_t *power;
+    monitorpdata_t sample;
+    
+    uint32_t* CMS_reg = (monitor->cms + 40960);
+
+    while(monitor->cms_flag == 1){
+        // The power region may be released by another thread at any time
+        pthread_mutex_lock(&monitor->data_lock);
+        power = monitor->data->power;
+        if (!power || (size_t)monitor->num_power_measurements >= power->size / sizeof(monitorpdata_t)) {
+            pthread_mutex_unlock(&monitor->data_lock);
+            break;
+        }
+        // Read power consumption
+        sample = (CMS_reg[58]*CMS_reg[61]);
+        ((monitorpdata_t *)power->data)[monitor->num_power_measurements] = sample;
+        monitor->num_power_measurements++;
+        pthread_mutex_unlock(&monitor->data_lock);
+
+        // Print power consumption
+        monitor_print_info("Board power consumption: %d W\n", sample);
 
-    monitor_hw_set_mask(mask);
+        // Wait for the CMS to finish
+        usleep(120000);
+    }
 
 }
 
 /*
-* Monitor set AXI mask function
+* Monitor CMS thread function
 *
-* @mask : AXI triggering mask
+* This function is the entry point of the CMS power sampling thread.
 *
-* This function sets a mask used to decide which AXI communication triggers the monitor execution.
+* @arg : Monitor instance
 *
 */
-void monitor_set_axi_mask(int mask){
+static void *monitor_CMS_thread(void *arg) {
 
-    monitor_hw_set_axi_mask(mask);
+    monitor_dev_CMS_get_power_measurements(arg);
+    return NULL;
 
 }
 
 /*
-* Monitor get acquisition time function
+* Monitor CMS start function
 *
-* This function gets the acquisition elapsed cycles used for data plotting in post-processing.
+* This function starts the CMS acquisition.
 *
-* Return : Elapsed cycles
+* @monitor : Monitor instance
 *
 */
-int monitor_get_time(){
+static void monitor_dev_CMS_start(struct monitor *monitor) {
 
-    return monitor_hw_get_time();
+    uint32_t* CMS_reset = (monitor->cms + 32768);
 
-}
+    //Disable reset
+    *CMS_reset = 1; 
+    monitor->cms_flag = 1;
+
+    // Crear el hilo
+    if (pthread_create(&monitor->cms_thread, NULL, monitor_CMS_thread, monitor) != 0) {
+        perror("Error al crear el hilo");
+        monitor->cms_flag = 0;
+        return;
+    }
+
+}
+#endif
+
+/*
+* Monitor start function
+*
+* This function starts the monitor acquisition, waiting at most
+* MONITOR_START_TIMEOUT ms for the monitor to be idle.
+*
+* @monitor : Monitor instance
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
+*
+*/
+int monitor_dev_start(monitor_t *monitor) {
+
+    return monitor_dev_start_timeout(monitor, MONITOR_START_TIMEOUT);
+
+}
+
+/*
+* Monitor start function (with timeout)
+*
+* This function waits for the monitor to be idle (without spinning on its
+* registers) and starts the monitor acquisition.
+*
+* @monitor : Monitor instance
+* @timeout : maximum time to wait for the monitor to be idle in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
+*
+*/
+int monitor_dev_start_timeout(monitor_t *monitor, int timeout) {
+    int ret;
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    ret = monitor_hw_start(monitor, timeout);
+    if (!ret) {
+        clock_gettime(CLOCK_MONOTONIC, &monitor->t_start);
+        monitor->done = 0;
+        if (monitor->latency) {
+            monitor_latency_capture(monitor->latency);
+        }
+    }
+    #ifdef AU250
+    // Start CMS
+    if (!ret) {
+        monitor_dev_CMS_start(monitor);
+    }
+    #endif
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    return ret;
+}
+
+#ifdef AU250
+/*
+* Monitor CMS stop function
+*
+* This function stops the CMS acquisition.
+*
+* @monitor : Monitor instance
+*
+*/
+static void monitor_dev_CMS_stop(struct monitor *monitor) {
+
+    uint32_t* CMS_reset = (monitor->cms + 32768);
+
+    // Nothing to do if the CMS thread is not running
+    if (!monitor->cms_flag) {
+        return;
+    }
+
+    //Disable reset & stop CMS
+    monitor->cms_flag = 0;
+    *CMS_reset = 0; 
+
+    // Wait for the thread to finish
+    if (pthread_join(monitor->cms_thread, NULL) != 0) {
+        perror("Error al esperar a que el hilo termine");
+        return;
+    }
+    
+}
+#endif
+
+/*
+* Monitor clean function
+*
+* This function cleans the monitor memory banks.
+*
+* @monitor : Monitor instance
+*
+*/
+void monitor_dev_clean(monitor_t *monitor) {
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_hw_clean(monitor);
+    #ifdef AU250
+    // The CMS samples belong to the capture being cleaned
+    monitor_dev_CMS_stop(monitor);
+    pthread_mutex_lock(&monitor->data_lock);
+    monitor->num_power_measurements = 0;
+    pthread_mutex_unlock(&monitor->data_lock);
+    #endif
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor stop function
+*
+* This function stop the monitor acquisition. (only makes sense when power monitoring disabled)
+*
+* @monitor : Monitor instance
+*
+*/
+void monitor_dev_stop(monitor_t *monitor) {
+    
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    // Return if monitor is already done, otherwise stop it
+    if (monitor_hw_isdone(monitor) == 1){
+        pthread_mutex_unlock(&monitor->ctrl_lock);
+        return;
+    }
+    monitor_hw_stop(monitor);
+    #ifdef AU250
+    // Stop CMS
+    monitor_dev_CMS_stop(monitor);
+    #endif
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor set mask function
+*
+* @monitor : Monitor instance
+* @mask    : Triggering mask
+*
+* This function sets a mask used to decide which signals trigger the monitor execution.
+*
+*/
+void monitor_dev_set_mask(monitor_t *monitor, int mask) {
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_hw_set_mask(monitor, mask);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor set AXI mask function
+*
+* @monitor : Monitor instance
+* @mask    : AXI triggering mask
+*
+* This function sets a mask used to decide which AXI communication triggers the monitor execution.
+*
+*/
+void monitor_dev_set_axi_mask(monitor_t *monitor, int mask) {
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor_hw_set_axi_mask(monitor, mask);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor get acquisition time function
+*
+* This function gets the acquisition elapsed cycles used for data plotting in post-processing.
+*
+* @monitor : Monitor instance
+*
+* Return : Elapsed cycles
+*
+*/
+int monitor_dev_get_time(monitor_t *monitor) {
+
+    return monitor_hw_get_time(monitor);
+
+}
+
+/*
+* Monitor get 64-bit acquisition time function
+*
+* This function gets the acquisition elapsed cycles, extended to 64 bits
+* with the host time between the last start and the end of the acquisition.
+*
+* @monitor : Monitor instance
+*
+* Return : Elapsed cycles
+*
+*/
+uint64_t monitor_dev_get_elapsed(monitor_t *monitor) {
+    struct timespec t_end;
+    uint64_t approx;
+    int64_t ns;
+    uint32_t elapsed;
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    elapsed = monitor_hw_get_time(monitor);
+    if (monitor->done) {
+        t_end = monitor->t_done;
+    }
+    else {
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+    }
+    // Signed nanoseconds first (tv_nsec alone can go backwards), then cycles
+    ns = (int64_t)(t_end.tv_sec - monitor->t_start.tv_sec) * 1000000000LL + (t_end.tv_nsec - monitor->t_start.tv_nsec);
+    if (ns < 0) {
+        ns = 0;
+    }
+    approx = (uint64_t)(ns / 1000000000LL) * monitor->clock_hz + (uint64_t)(ns % 1000000000LL) * monitor->clock_hz / 1000000000ULL;
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    return monitor_elapsed_extend(elapsed, approx);
+}
+
+/*
+* Monitor set clock frequency function
+*
+* This function sets the Monitor clock frequency.
+*
+* @monitor : Monitor instance
+* @hz      : Monitor clock frequency in Hz
+*
+*/
+void monitor_dev_set_clock_frequency(monitor_t *monitor, unsigned long hz) {
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    monitor->clock_hz = hz;
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor get power measurements function
+*
+* This function gets the number of power consumption measurements stored in the BRAM used in post-processing.
+*
+* @monitor : Monitor instance
+*
+* Return : Number of power consupmtion measurements
+*
+*/
+int monitor_dev_get_number_power_measurements(monitor_t *monitor) {
+
+    #ifdef AU250
+    int ret;
+
+    pthread_mutex_lock(&monitor->data_lock);
+    ret = monitor->num_power_measurements;
+    pthread_mutex_unlock(&monitor->data_lock);
+
+    return ret;
+    #else
+    return monitor_hw_get_number_power_measurements(monitor);
+    #endif
+
+}
+
+/*
+* Monitor get traces measurements function
+*
+* This function gets the number of probes events stored in the BRAM used in post-processing.
+*
+* @monitor : Monitor instance
+*
+* Return : Number of probes events
+*
+*/
+int monitor_dev_get_number_traces_measurements(monitor_t *monitor) {
+
+    return monitor_hw_get_number_traces_measurements(monitor);
+
+}
+
+/*
+* Monitor is done function
+*
+* This function checks if the acquisition has finished.
+*
+* @monitor : Monitor instance
+*
+* Return : 1 if acquisition finished, 0 otherwise
+*
+*/
+int monitor_dev_isdone(monitor_t *monitor) {
+
+    return monitor_hw_isdone(monitor);
+
+}
+
+/*
+* Monitor is busy function
+*
+* This function checks if the monitor is busy.
+*
+* @monitor : Monitor instance
+*
+* Return : 1 if busy, 0 if idle
+*
+*/
+int monitor_dev_isbusy(monitor_t *monitor) {
+
+    return monitor_hw_isbusy(monitor);
+
+}
+
+/*
+* Monitor get number of power errors function
+*
+* This function return the number of incorrect power samples received from ADC
+*
+* @monitor : Monitor instance
+*
+* Return : Number of errors [0,$number_power_measurements]
+*
+*/
+int monitor_dev_get_power_errors(monitor_t *monitor) {
+
+    return monitor_hw_get_number_power_erros(monitor);
+
+}
+
+/*
+* Monitor get status function
+*
+* This function reads every Monitor register once and decodes them.
+*
+* @monitor : Monitor instance
+* @status  : status to be filled
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_get_status(monitor_t *monitor, struct monitorStatus_t *status) {
+
+    if (!status) {
+        return -EINVAL;
+    }
+
+    monitor_hw_get_status(monitor, status);
+    #ifdef AU250
+    // Power samples are gathered from CMS
+    pthread_mutex_lock(&monitor->data_lock);
+    status->power_samples = monitor->num_power_measurements;
+    pthread_mutex_unlock(&monitor->data_lock);
+    #endif
+
+    return 0;
+}
+
+/*
+* Monitor host time conversion function
+*
+* This function converts a CLOCK_MONOTONIC time into CLOCK_REALTIME.
+*
+*/
+static struct timespec monitor_realtime(struct timespec mono) {
+    struct timespec now_mono, now_real;
+    int64_t ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &now_mono);
+    clock_gettime(CLOCK_REALTIME, &now_real);
+    ns = (now_real.tv_sec - now_mono.tv_sec + mono.tv_sec) * 1000000000LL + now_real.tv_nsec - now_mono.tv_nsec + mono.tv_nsec;
+
+    return (struct timespec){ .tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL };
+}
+
+/*
+* Monitor get capture function
+*
+* This function describes the last capture of the Monitor, leaving the data
+* buffers empty.
+*
+* @monitor : Monitor instance
+* @capture : capture description
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_get_capture(monitor_t *monitor, struct monitorCapture_t *capture) {
+    struct monitorStatus_t status;
+    struct timespec t_start, t_done;
+    int ret;
+
+    if (!capture) {
+        return -EINVAL;
+    }
+    memset(capture, 0, sizeof *capture);
+
+    ret = monitor_dev_get_status(monitor, &status);
+    if (ret < 0) {
+        return ret;
+    }
+    capture->elapsed = monitor_dev_get_elapsed(monitor);
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    capture->clock_hz = monitor->clock_hz;
+    capture->vref_mv = monitor->vref_mv;
+    t_start = monitor->t_start;
+    if (monitor->done) {
+        t_done = monitor->t_done;
+    }
+    else {
+        clock_gettime(CLOCK_MONOTONIC, &t_done);
+    }
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    capture->host_start = monitor_realtime(t_start);
+    capture->host_done = monitor_realtime(t_done);
+    capture->probes = MONITOR_EDGE_PROBES;
+    capture->axi_bits = status.axi_sniffer ? 32 : 0;
+    capture->power_errors = status.power_errors;
+    #ifdef AU250
+    capture->flags = MONITOR_FILE_CMS_POWER;
+    #endif
+
+    return 0;
+}
+
+
+/*
+* Monitor no busy-wait waiting function
+*
+* This function waits for the monitor to finish in a not busy-wait manner.
+*
+* @monitor : Monitor instance
+*
+*/
+void monitor_dev_wait(monitor_t *monitor) {
+    uint64_t t_begin = 0;
+
+    if (monitor->latency) {
+        t_begin = monitor_latency_now();
+    }
+
+    // Monitor management using interrupts and blocking system calls
+    if (monitor->sim) {
+        monitor_sim_wait(monitor->sim);
+    }
+    else {
+        struct pollfd pfd = { .fd = monitor->fd, .events = POLLIRQ, };
+        poll(&pfd, 1, -1);
+    }
+
+    // Keep the end of the acquisition (used to extend the elapsed cycles)
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    // Not timed if the instrumentation was enabled while waiting
+    if (t_begin && monitor->latency) {
+        monitor_latency_stage(monitor->latency, MONITOR_STAGE_IRQ, t_begin);
+    }
+    if (!monitor->done) {
+        clock_gettime(CLOCK_MONOTONIC, &monitor->t_done);
+        monitor->done = 1;
+    }
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor DMA token function
+*
+* This function prepares the persistent DMA staging buffer of a Monitor
+* memory bank and fills the DMA token used to drain @ndata samples into it.
+*
+* @monitor : Monitor instance
+* @regtype : memory bank type (power or traces)
+* @ndata   : amount of data to be read from the memory bank
+* @token   : DMA token to be filled
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_dma_token(struct monitor *monitor, enum monitorregtype_t regtype, unsigned int ndata, struct dmaproxy_token *token) {
+    struct monitorStaging_t *staging;
+    size_t size;
+    int ret;
+
+    if (regtype == MONITOR_REG_POWER) {
+        staging = &monitor->staging_power;
+        size = ndata * sizeof(monitorpdata_t);
+    }
+    else {
+        staging = &monitor->staging_traces;
+        size = ndata * sizeof(monitortdata_t);
+    }
+
+    // The staging buffer cannot be overwritten while a view is held
+    if (staging->viewed) {
+        monitor_print_error("[monitor-hw] %s staging buffer is in use by a view\n", regtype == MONITOR_REG_POWER ? "power" : "traces");
+        return -EBUSY;
+    }
+
+    // Reuse (or map on first use) the persistent DMA staging buffer
+    ret = monitor_staging_reserve(monitor, staging, size, (regtype == MONITOR_REG_POWER ? 1 : 2) * sysconf(_SC_PAGESIZE));
+    if (ret) {
+        return ret;
+    }
+
+    token->memaddr = staging->mem;
+    token->memoff = 0x00000000;
+    #ifdef AU250
+    token->hwaddr = (void *)MONITOR_TRACES_ADDR;
+    #else
+    token->hwaddr = (regtype == MONITOR_REG_POWER) ? (void *)MONITOR_POWER_ADDR : (void *)MONITOR_TRACES_ADDR;
+    #endif
+    token->hwoff = 0x00000000;
+    token->size = size;
+
+    return 0;
+}
+
+/*
+* Monitor DMA submit function
+*
+* This function starts the transfer of the first @power_ndata power samples
+* and the first @traces_ndata traces samples into their persistent DMA
+* staging buffers, without waiting for it to finish (see monitor_dma_wait()).
+* When both memory banks are requested, both transfers are queued with a
+* single ioctl() and their completion is signaled once (monitor->dma_lock
+* must be held).
+*
+* @monitor      : Monitor instance
+* @power_ndata  : amount of data to be read from power memory bank (0 to skip it)
+* @traces_ndata : amount of data to be read from traces memory bank (0 to skip it)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_dma_submit(struct monitor *monitor, unsigned int power_ndata, unsigned int traces_ndata) {
+    struct monitorLatency_t *latency = monitor->latency;
+    struct dmaproxy_drain drain;
+    uint64_t one = 1, t_begin = 0;
+    int ret;
+
+    if (latency) {
+        t_begin = monitor_latency_now();
+    }
+
+    #ifdef AU250
+    const char *device = monitor->c2h;
+    ssize_t rc;
+
+    // Power samples are gathered from CMS, there is no power memory bank
+    if (power_ndata) {
+        return -EOPNOTSUPP;
+    }
+    #endif
+
+    if (!power_ndata && !traces_ndata) {
+        return -EINVAL;
+    }
+
+    // Only one transfer can be in flight
+    if (monitor->transfer.pending) {
+        monitor_print_error("[monitor-hw] a DMA transfer is already pending\n");
+        return -EBUSY;
+    }
+
+    memset(&drain, 0, sizeof drain);
+    if (power_ndata) {
+        ret = monitor_dma_token(monitor, MONITOR_REG_POWER, power_ndata, &drain.power);
+        if (ret) {
+            return ret;
+        }
+    }
+    if (traces_ndata) {
+        ret = monitor_dma_token(monitor, MONITOR_REG_TRACES, traces_ndata, &drain.traces);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    // The simulated DMA engine copies the memory banks right away
+    if (monitor->sim) {
+        if (power_ndata) {
+            ret = monitor_sim_dma(monitor->sim, MONITOR_REG_POWER, drain.power.memaddr, drain.power.size);
+            if (ret) {
+                return ret;
+            }
+        }
+        if (traces_ndata) {
+            ret = monitor_sim_dma(monitor->sim, MONITOR_REG_TRACES, drain.traces.memaddr, drain.traces.size);
+            if (ret) {
+                return ret;
+            }
+        }
+        if (write(monitor->transfer.fd, &one, sizeof one) != sizeof one) {
+            return -errno;
+        }
+    }
+    else {
+        #ifdef AU250
+        // Open the DMA device once, it is kept open until monitor_dev_close()
+        if (monitor->c2h_fd < 0) {
+            monitor->c2h_fd = open(device, O_RDWR);
+            if (monitor->c2h_fd < 0) {
+                ret = -errno;
+                monitor_print_error("[monitor-hw] open() %s failed (dma transfer)\n", device);
+                return ret;
+            }
+        }
+
+        // XDMA reads are synchronous, completion is signaled right away (only if the whole memory bank was read)
+        rc = read_to_buffer((char *)device, monitor->c2h_fd, (char *)drain.traces.memaddr, (uint64_t)drain.traces.size, (uint64_t)(drain.traces.hwaddr+drain.traces.hwoff));
+        if (rc < 0 || (size_t)rc != drain.traces.size) {
+            monitor_print_error("[monitor-hw] read() %s failed (dma transfer)\n", device);
+            return -EIO;
+        }
+        if (write(monitor->transfer.fd, &one, sizeof one) != sizeof one) {
+            return -errno;
+        }
+        #else
+        // Start DMA transfer(s)
+        if (power_ndata && traces_ndata) {
+            ret = ioctl(monitor->fd, MONITOR_IOC_DMA_HW2MEM_DRAIN, &drain);
+        }
+        else if (power_ndata) {
+            ret = ioctl(monitor->fd, MONITOR_IOC_DMA_HW2MEM_POWER, &drain.power);
+        }
+        else {
+            ret = ioctl(monitor->fd, MONITOR_IOC_DMA_HW2MEM_TRACES, &drain.traces);
+        }
+        if (ret < 0) {
+            monitor_print_error("[monitor-hw] ioctl() failed (dma transfer)\n");
+            return -errno;
+        }
+        #endif
+    }
+
+    monitor->transfer.pending = 1;
+    monitor->transfer.power_ndata = power_ndata;
+    monitor->transfer.traces_ndata = traces_ndata;
+
+    // DMA completion is timed from here (see monitor_dma_wait())
+    monitor->transfer.t_submit = 0;
+    if (latency) {
+        monitor_latency_stage(latency, MONITOR_STAGE_DMA_SETUP, t_begin);
+        monitor->transfer.t_submit = monitor_latency_now();
+    }
+
+    return 0;
+}
+
+/*
+* Monitor DMA wait function
+*
+* This function waits for the pending DMA transfer to finish (monitor->dma_lock
+* must be held).
+*
+* @monitor : Monitor instance
+* @timeout : maximum time to wait in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfer has not finished, error code otherwise
+*
+*/
+static int monitor_dma_wait(struct monitor *monitor, int timeout) {
+    struct monitorLatency_t *latency = monitor->latency;
+    struct pollfd pfd;
+    int ret;
+
+    if (!monitor->transfer.pending) {
+        return -EINVAL;
+    }
+
+    // Completion is level-triggered (it may have already been seen through epoll())
+    pfd.fd = monitor->transfer.fd;
+    pfd.events = monitor_transfer_eventfd(monitor) ? POLLIN : POLLDMA;
+    ret = poll(&pfd, 1, timeout);
+    if (ret < 0) {
+        return -errno;
+    }
+    if (ret == 0) {
+        return -ETIMEDOUT;
+    }
+
+    if (monitor_transfer_eventfd(monitor)) {
+        uint64_t count;
+        if (read(monitor->transfer.fd, &count, sizeof count) != sizeof count) {
+            return -errno;
+        }
+    }
+
+    monitor->transfer.pending = 0;
+    if (latency && monitor->transfer.t_submit) {
+        monitor_latency_stage(latency, MONITOR_STAGE_DMA_WAIT, monitor->transfer.t_submit);
+    }
+
+    return 0;
+}
+
+/*
+* Monitor staging buffer copy function
+*
+* This function copies the first @ndata samples of a staging buffer into the
+* region allocated with monitor_alloc() for the same memory bank
+* (monitor->dma_lock must be held).
+*
+* @monitor : Monitor instance
+* @regtype : memory bank type (power or traces)
+* @ndata   : amount of data to be copied
+*
+* Return : 0 on success, -ENOSPC if the region is too small, error code otherwise
+*
+*/
+static int monitor_staging_copy(struct monitor *monitor, enum monitorregtype_t regtype, unsigned int ndata) {
+    struct monitorLatency_t *latency = monitor->latency;
+    uint64_t t_begin = 0;
+    int ret = 0;
+
+    if (latency) {
+        t_begin = monitor_latency_now();
+    }
+
+    pthread_mutex_lock(&monitor->data_lock);
+    if (regtype == MONITOR_REG_POWER) {
+        if (!monitor->data->power){
+            monitor_print_error("[monitor-hw] no power region found (dma transfer)\n");
+            ret = -1;
+        }
+        else if (ndata * sizeof(monitorpdata_t) > monitor->data->power->size) {
+            monitor_print_error("[monitor-hw] power region too small (%u samples, dma transfer)\n", ndata);
+            ret = -ENOSPC;
+        }
+        else {
+            memcpy(monitor->data->power->data, monitor->staging_power.mem, ndata * sizeof(monitorpdata_t));
+        }
+    }
+    else {
+        if (!monitor->data->traces){
+            monitor_print_error("[monitor-hw] no traces region found (dma transfer)\n");
+            ret = -1;
+        }
+        else if (ndata * sizeof(monitortdata_t) > monitor->data->traces->size) {
+            monitor_print_error("[monitor-hw] traces region too small (%u samples, dma transfer)\n", ndata);
+            ret = -ENOSPC;
+        }
+        else {
+            memcpy(monitor->data->traces->data, monitor->staging_traces.mem, ndata * sizeof(monitortdata_t));
+        }
+    }
+    pthread_mutex_unlock(&monitor->data_lock);
+
+    if (latency && ret == 0) {
+        monitor_latency_stage(latency, MONITOR_STAGE_COPY, t_begin);
+    }
+
+    return ret;
+}
+
+/*
+* Monitor staging buffer view function
+*
+* This function locks the staging buffer of a memory bank and exposes its
+* first @ndata samples through @view.
+*
+* @monitor : Monitor instance
+*
+*/
+static void monitor_staging_view(struct monitor *monitor, enum monitorregtype_t regtype, unsigned int ndata, struct monitorView_t *view) {
+    struct monitorStaging_t *staging = (regtype == MONITOR_REG_POWER) ? &monitor->staging_power : &monitor->staging_traces;
+
+    // Lock the staging buffer until the view is released
+    staging->viewed = 1;
+
+    view->data = staging->mem;
+    view->ndata = ndata;
+    view->regtype = regtype;
+
+}
+
+
+/*
+* Monitor DMA read completion function
+*
+* This function waits for the pending DMA transfer and hands out every
+* memory bank it drained, either in place through its view or as a copy
+* into its monitor_alloc() region (monitor->dma_lock must be held).
+*
+* @monitor     : Monitor instance
+* @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+* @timeout     : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfer has not finished, error code otherwise
+*          (no view is held on error)
+*
+*/
+static int monitor_dma_complete(struct monitor *monitor, struct monitorView_t *power_view, struct monitorView_t *traces_view, int timeout) {
+    unsigned int power_ndata = monitor->transfer.power_ndata;
+    unsigned int traces_ndata = monitor->transfer.traces_ndata;
+    int err = 0;
+    int ret;
+
+    ret = monitor_dma_wait(monitor, timeout);
+    if (ret) {
+        return ret;
+    }
+
+    // Copy every bank before taking any view, so that a failed copy neither
+    // skips the other bank nor leaves a staging buffer locked by a view
+    if (power_ndata && !power_view) {
+        err = monitor_staging_copy(monitor, MONITOR_REG_POWER, power_ndata);
+    }
+    if (traces_ndata && !traces_view) {
+        ret = monitor_staging_copy(monitor, MONITOR_REG_TRACES, traces_ndata);
+        if (!err) {
+            err = ret;
+        }
+    }
+    if (err) {
+        return err;
+    }
+
+    if (power_ndata && power_view) {
+        monitor_staging_view(monitor, MONITOR_REG_POWER, power_ndata, power_view);
+    }
+    if (traces_ndata && traces_view) {
+        monitor_staging_view(monitor, MONITOR_REG_TRACES, traces_ndata, traces_view);
+    }
+
+    return 0;
+}
+
+#ifndef AU250
+/*
+* Monitor power consumption read function
+*
+* This function reads the monitor power consumption data sampled.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be read from power memory bank
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_read_power_consumption(monitor_t *monitor, unsigned int ndata) {
+
+    return monitor_dev_drain(monitor, ndata, 0, NULL, NULL);
+
+}
+#endif
+
+/*
+* Monitor traces read function
+*
+* This function reads the monitor traces data sampled.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be read from traces memory bank
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_read_traces(monitor_t *monitor, unsigned int ndata) {
+
+    return monitor_dev_drain(monitor, 0, ndata, NULL, NULL);
+
+}
+
+#ifndef AU250
+/*
+* Monitor asynchronous power consumption read function
+*
+* This function starts reading the monitor power consumption data sampled
+* and returns without waiting for the DMA transfer to finish.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be read from power memory bank
+*
+* Return : completion file descriptor on success, error code otherwise
+*
+*/
+int monitor_dev_read_power_consumption_async(monitor_t *monitor, unsigned int ndata) {
+
+    return monitor_dev_drain_async(monitor, ndata, 0);
+
+}
+#endif
+
+/*
+* Monitor asynchronous traces read function
+*
+* This function starts reading the monitor traces data sampled and returns
+* without waiting for the DMA transfer to finish.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be read from traces memory bank
+*
+* Return : completion file descriptor on success, error code otherwise
+*
+*/
+int monitor_dev_read_traces_async(monitor_t *monitor, unsigned int ndata) {
+
+    return monitor_dev_drain_async(monitor, 0, ndata);
+
+}
+
+/*
+* Monitor asynchronous read finish function
+*
+* This function waits (if needed) for the transfer started by an
+* asynchronous read, and then either copies the data into the region
+* allocated with monitor_alloc() or, when @view is provided, exposes it
+* in place.
+*
+* @monitor : Monitor instance
+* @view    : view to be filled (NULL to copy into the monitor_alloc() region)
+* @timeout : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfer has not finished, error code otherwise
+*
+*/
+int monitor_dev_read_finish(monitor_t *monitor, struct monitorView_t *view, int timeout) {
+    int ret;
+
+    pthread_mutex_lock(&monitor->dma_lock);
+    // Drains of both memory banks are completed with monitor_drain_finish()
+    if (monitor->transfer.pending && monitor->transfer.power_ndata && monitor->transfer.traces_ndata) {
+        ret = -EINVAL;
+    }
+    else {
+        ret = monitor_dma_complete(monitor, view, view, timeout);
+    }
+    pthread_mutex_unlock(&monitor->dma_lock);
+
+    return ret;
+}
+
+/*
+* Monitor drain function
+*
+* This function reads the monitor power consumption and traces data sampled
+* with a single DMA request, and then either copies each memory bank into
+* its monitor_alloc() region or, when a view is provided, exposes it in place.
+*
+* @monitor      : Monitor instance
+* @power_ndata  : amount of data to be read from power memory bank
+* @traces_ndata : amount of data to be read from traces memory bank
+* @power_view   : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view  : traces view to be filled (NULL to copy into the monitor_alloc() region)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_drain(monitor_t *monitor, unsigned int power_ndata, unsigned int traces_ndata, struct monitorView_t *power_view, struct monitorView_t *traces_view) {
+    int ret;
+
+    pthread_mutex_lock(&monitor->dma_lock);
+    ret = monitor_dma_submit(monitor, power_ndata, traces_ndata);
+    if (!ret) {
+        ret = monitor_dma_complete(monitor, power_view, traces_view, -1);
+    }
+    pthread_mutex_unlock(&monitor->dma_lock);
+
+    return ret;
+}
+
+/*
+* Monitor asynchronous drain function
+*
+* This function starts reading the monitor power consumption and traces data
+* sampled with a single DMA request and returns without waiting for it.
+*
+* @monitor      : Monitor instance
+* @power_ndata  : amount of data to be read from power memory bank
+* @traces_ndata : amount of data to be read from traces memory bank
+*
+* Return : completion file descriptor on success, error code otherwise
+*
+*/
+int monitor_dev_drain_async(monitor_t *monitor, unsigned int power_ndata, unsigned int traces_ndata) {
+    int ret;
+
+    pthread_mutex_lock(&monitor->dma_lock);
+    ret = monitor_dma_submit(monitor, power_ndata, traces_ndata);
+    pthread_mutex_unlock(&monitor->dma_lock);
+    if (ret) {
+        return ret;
+    }
+
+    // The completion descriptor does not change while the handle is open
+    return monitor->transfer.fd;
+}
+
+/*
+* Monitor asynchronous drain finish function
+*
+* This function waits (if needed) for the transfers started by
+* monitor_drain_async(), and then hands out each memory bank either as a
+* copy into its monitor_alloc() region or in place through its view.
+*
+* @monitor     : Monitor instance
+* @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+* @timeout     : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfers have not finished, error code otherwise
+*
+*/
+int monitor_dev_drain_finish(monitor_t *monitor, struct monitorView_t *power_view, struct monitorView_t *traces_view, int timeout) {
+    int ret;
+
+    pthread_mutex_lock(&monitor->dma_lock);
+    ret = monitor_dma_complete(monitor, power_view, traces_view, timeout);
+    pthread_mutex_unlock(&monitor->dma_lock);
+
+    return ret;
+}
+
+/*
+* Monitor capture read function
+*
+* This function takes a status snapshot and drains every sample of the
+* last acquisition with a single DMA request.
+*
+* @monitor     : Monitor instance
+* @status      : status to be filled (may be NULL)
+* @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_read_capture(monitor_t *monitor, struct monitorStatus_t *status, struct monitorView_t *power_view, struct monitorView_t *traces_view) {
+    struct monitorStatus_t snapshot;
+    unsigned int power_ndata;
+
+    monitor_dev_get_status(monitor, &snapshot);
+    if (status) {
+        *status = snapshot;
+    }
+
+    #ifdef AU250
+    // Power samples are already in the power region (CMS)
+    power_ndata = 0;
+    (void)power_view;
+    #else
+    power_ndata = snapshot.power_samples;
+    #endif
+
+    return monitor_dev_drain(monitor, power_ndata, snapshot.traces_samples, power_view, traces_view);
+}
+
+/*
+* Monitor view acquire function
+*
+* This function drains a Monitor memory bank into its DMA staging buffer
+* and gives the application read-only access to it, without copying the
+* data into a monitor_alloc() region.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be read from the memory bank
+* @regtype : memory bank type (power or traces)
+* @view    : view to be filled
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_view_acquire(monitor_t *monitor, unsigned int ndata, enum monitorregtype_t regtype, struct monitorView_t *view) {
+
+    if (!view) {
+        return -EINVAL;
+    }
+
+    if (regtype == MONITOR_REG_POWER) {
+        return monitor_dev_drain(monitor, ndata, 0, view, NULL);
+    }
+    return monitor_dev_drain(monitor, 0, ndata, NULL, view);
+}
+
+/*
+* Monitor view release function
+*
+* This function releases a view obtained with monitor_view_acquire(). The
+* view data must not be accessed afterwards, since the next read reuses
+* the same staging buffer.
+*
+* @monitor : Monitor instance
+* @view    : view to be released
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_view_release(monitor_t *monitor, struct monitorView_t *view) {
+    struct monitorStaging_t *staging;
+    int ret = 0;
+
+    if (!view || !view->data) {
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&monitor->dma_lock);
+    staging = (view->regtype == MONITOR_REG_POWER) ? &monitor->staging_power : &monitor->staging_traces;
+    if (!staging->viewed || view->data != staging->mem) {
+        monitor_print_error("[monitor-hw] view does not match any held staging buffer\n");
+        ret = -EINVAL;
+    }
+    else {
+        staging->viewed = 0;
+    }
+    pthread_mutex_unlock(&monitor->dma_lock);
+    if (ret) {
+        return ret;
+    }
+
+    view->data = NULL;
+    view->ndata = 0;
+
+    return 0;
+}
+
+/*
+* Monitor allocate buffer memory
+*
+* This function allocates dynamic memory to be used as a buffer between
+* the application and the local memories in the hardware kernels.
+*
+* @monitor : Monitor instance
+* @ndata   : amount of data to be allocated for the buffer
+* @regname : memory bank name to associate this buffer with
+* @regtype : memory bank type (power or traces)
+*
+* Return : pointer to allocated memory on success, NULL otherwise
+*
+*/
+void *monitor_dev_alloc(monitor_t *monitor, int ndata, const char *regname, enum monitorregtype_t regtype) {
+    struct monitorRegion_t *region = NULL;
+    int exists = 0;
+
+    // Allocate memory for kernel port configuration
+    region = malloc(sizeof *region);
+    if (!region) {
+        return NULL;
+    }
+
+    // Set port name
+    region->name = malloc(strlen(regname) + 1);
+    if (!region->name) {
+        goto err_malloc_reg_name;
+    }
+    strcpy(region->name, regname);
+
+    // Set port size
+    if (regtype == MONITOR_REG_POWER)
+        region->size = ndata * sizeof(monitorpdata_t);
+    else
+        region->size = ndata * sizeof(monitortdata_t);
+
+    // Allocate memory for application
+    region->data = malloc(region->size);
+    if (!region->data) {
+        goto err_malloc_region_data;
+    }
+
+    // Critical section: search for port in port lists and publish the new one
+    pthread_mutex_lock(&monitor->data_lock);
+    if (monitor->data->power){
+        if (regtype == MONITOR_REG_POWER){
+            monitor_print_error("[monitor-hw] power region already exist\n");
+            exists = 1;
+        }
+        else if (strcmp(monitor->data->power->name, regname) == 0){
+            monitor_print_error("[monitor-hw] a region has been found with name %s\n", regname);
+            exists = 1;
+        }
+    }
+    if (!exists && monitor->data->traces){
+        if (regtype == MONITOR_REG_TRACES){
+            monitor_print_error("[monitor-hw] traces region already exist\n");
+            exists = 1;
+        }
+        else if (strcmp(monitor->data->traces->name, regname) == 0){
+            monitor_print_error("[monitor-hw] a region has been found with name %s\n", regname);
+            exists = 1;
+        }
+    }
+    if (!exists) {
+        // Check port direction flag : POWER / TRACES
+        if (regtype == MONITOR_REG_POWER)
+            monitor->data->power = region;
+        else
+            monitor->data->traces = region;
+    }
+    pthread_mutex_unlock(&monitor->data_lock);
+    if (exists) {
+        goto err_region_exists;
+    }
+
+    // Return allocated memory
+    return region->data;
+
+err_region_exists:
+    free(region->data);
+
+err_malloc_region_data:
+    free(region->name);
+
+err_malloc_reg_name:
+    free(region);
+    region = NULL;
+
+    return NULL;
+}
+
+
+/*
+* Monitor release buffer memory
+*
+* This function frees dynamic memory allocated as a buffer between the
+* application and the hardware kernel.
+*
+* @monitor : Monitor instance
+* @regname : memory bank this buffer is associated with
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_free(monitor_t *monitor, const char *regname) {
+    struct monitorRegion_t *region = NULL;
+
+    // Critical section: search for port in port lists and unlink it
+    pthread_mutex_lock(&monitor->data_lock);
+    if (monitor->data->power != NULL){
+        if (strcmp(monitor->data->power->name, regname) == 0){
+            region = monitor->data->power;
+            monitor->data->power = NULL;
+        }
+    }
+    if (monitor->data->traces != NULL){
+        if (strcmp(monitor->data->traces->name, regname) == 0){
+            region = monitor->data->traces;
+            monitor->data->traces = NULL;
+        }
+    }
+    pthread_mutex_unlock(&monitor->data_lock);
+
+    if (region == NULL) {
+        monitor_print_error("[monitor-hw] no region found with name %s\n", regname);
+        return -ENODEV;
+    }
+
+    // Free application memory
+    free(region->data);
+    free(region->name);
+    free(region);
+
+    return 0;
+}
+
+
+/*
+ * DEFAULT INSTANCE API
+ *
+ * The functions below keep the original single-Monitor API. They operate
+ * on the default Monitor instance opened by monitor_init().
+ *
+ */
+
+/*
+* Monitor init function
+*
+* This function sets up the basic software entities required to manage
+* the Monitor low-level functionality (DMA transfers, registers access, etc.).
+*
+* Return : 0 on success, error code otherwise
+*/
+int monitor_init() {
+
+    // Staging buffers are mapped on the first read
+    return monitor_init_capacity(0, 0);
+
+}
+
+/*
+* Monitor init function (with capacity hints)
+*
+* This function opens the default Monitor instance and maps the persistent
+* DMA staging buffers used by every subsequent read.
+*
+* @power_capacity  : maximum number of power samples to be read (0 to map on first read)
+* @traces_capacity : maximum number of traces samples to be read (0 to map on first read)
+*
+* Return : 0 on success, error code otherwise
+*/
+int monitor_init_capacity(unsigned int power_capacity, unsigned int traces_capacity) {
+    int ret = 0;
+
+    pthread_mutex_lock(&monitor_default_lock);
+    if (monitor_default) {
+        monitor_print_error("[monitor-hw] default Monitor already initialized\n");
+        ret = -EBUSY;
+    }
+    else {
+        monitor_default = monitor_dev_open_capacity(NULL, power_capacity, traces_capacity);
+        if (!monitor_default) {
+            ret = -ENODEV;
+        }
+    }
+    pthread_mutex_unlock(&monitor_default_lock);
+
+    return ret;
+}
+
+/*
+* Monitor exit function
+*
+* This function cleans the software entities created by monitor_init().
+*
+*/
+void monitor_exit() {
+
+    pthread_mutex_lock(&monitor_default_lock);
+    monitor_dev_close(monitor_default);
+    monitor_default = NULL;
+    pthread_mutex_unlock(&monitor_default_lock);
+
+}
+
+/*
+* Monitor default instance function
+*
+* This function gets the Monitor instance used by the handle-less API.
+*
+* Return : default Monitor handle (NULL before monitor_init())
+*
+*/
+monitor_t *monitor_get_default() {
+
+    return monitor_default;
+
+}
+
+/*
+* Monitor normal voltage reference configuration function
+*
+* This function sets the monitor ADC voltage reference to 2.5V.
+*
+*/
+void monitor_config_vref(){
+
+    monitor_dev_config_vref(monitor_default);
+
+}
+
+/*
+* Monitor double voltage reference configuration function
+*
+* This function sets the monitor ADC voltage reference to 5V.
+*
+*/
+void monitor_config_2vref(){
+
+    monitor_dev_config_2vref(monitor_default);
+
+}
+
+/*
+* Monitor get voltage reference function
+*
+* This function gets the ADC voltage reference last configured.
+*
+* Return : voltage reference in mV
+*
+*/
+unsigned int monitor_get_vref(){
+
+    return monitor_dev_get_vref(monitor_default);
+
+}
+
+#ifdef AU250
+/*
+* Monitor CMS get power measurements function
+*
+* This function get power measurements from CMS.
+*
+*/
+void monitor_CMS_get_power_measurements(){
+
+    monitor_dev_CMS_get_power_measurements(monitor_default);
+
+}
+
+/*
+* Monitor CMS start function
+*
+* This function starts the CMS acquisition.
+*
+*/
+void monitor_CMS_start(){
+
+    monitor_dev_CMS_start(monitor_default);
+
+}
+
+/*
+* Monitor CMS stop function
+*
+* This function stops the CMS acquisition.
+*
+*/
+void monitor_CMS_stop(){
+
+    monitor_dev_CMS_stop(monitor_default);
+
+}
+#endif
+
+/*
+* Monitor start function
+*
+* This function starts the monitor acquisition.
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
+*
+*/
+int monitor_start(){
+
+    return monitor_dev_start(monitor_default);
+
+}
+
+/*
+* Monitor start function (with timeout)
+*
+* This function starts the monitor acquisition.
+*
+* @timeout : maximum time to wait for the monitor to be idle in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
+*
+*/
+int monitor_start_timeout(int timeout){
+
+    return monitor_dev_start_timeout(monitor_default, timeout);
+
+}
+
+/*
+* Monitor clean function
+*
+* This function cleans the monitor memory banks.
+*
+*/
+void monitor_clean(){
+
+    monitor_dev_clean(monitor_default);
+
+}
+
+/*
+* Monitor stop function
+*
+* This function stop the monitor acquisition. (only makes sense when power monitoring disabled)
+*
+*/
+void monitor_stop(){
+
+    monitor_dev_stop(monitor_default);
+
+}
+
+/*
+* Monitor set mask function
+*
+* @mask : Triggering mask
+*
+* This function sets a mask used to decide which signals trigger the monitor execution.
+*
+*/
+void monitor_set_mask(int mask){
+
+    monitor_dev_set_mask(monitor_default, mask);
+
+}
+
+/*
+* Monitor set AXI mask function
+*
+* @mask : AXI triggering mask
+*
+* This function sets a mask used to decide which AXI communication triggers the monitor execution.
+*
+*/
+void monitor_set_axi_mask(int mask){
+
+    monitor_dev_set_axi_mask(monitor_default, mask);
+
+}
+
+/*
+* Monitor get acquisition time function
+*
+* This function gets the acquisition elapsed cycles used for data plotting in post-processing.
+*
+* Return : Elapsed cycles
+*
+*/
+int monitor_get_time(){
+
+    return monitor_dev_get_time(monitor_default);
+
+}
+
+/*
+* Monitor get 64-bit acquisition time function
+*
+* This function gets the acquisition elapsed cycles, extended to 64 bits.
+*
+* Return : Elapsed cycles
+*
+*/
+uint64_t monitor_get_elapsed(){
+
+    return monitor_dev_get_elapsed(monitor_default);
+
+}
+
+/*
+* Monitor set clock frequency function
+*
+* This function sets the Monitor clock frequency.
+*
+* @hz : Monitor clock frequency in Hz
+*
+*/
+void monitor_set_clock_frequency(unsigned long hz){
+
+    monitor_dev_set_clock_frequency(monitor_default, hz);
+
+}
 
 /*
 * Monitor get power measurements function
@@ -441,7 +2354,7 @@ int monitor_get_time(){
 */
 int monitor_get_number_power_measurements() {
 
-    return monitor_hw_get_number_power_measurements();
+    return monitor_dev_get_number_power_measurements(monitor_default);
 
 }
 
@@ -455,7 +2368,7 @@ int monitor_get_number_power_measurements() {
 */
 int monitor_get_number_traces_measurements() {
 
-    return monitor_hw_get_number_traces_measurements();
+    return monitor_dev_get_number_traces_measurements(monitor_default);
 
 }
 
@@ -469,7 +2382,7 @@ int monitor_get_number_traces_measurements() {
 */
 int monitor_isdone(){
 
-    return monitor_hw_isdone();
+    return monitor_dev_isdone(monitor_default);
 
 }
 
@@ -483,7 +2396,7 @@ int monitor_isdone(){
 */
 int monitor_isbusy(){
 
-    return monitor_hw_isbusy();
+    return monitor_dev_isbusy(monitor_default);
 
 }
 
@@ -497,10 +2410,42 @@ int monitor_isbusy(){
 */
 int monitor_get_power_errors(){
 
-    return monitor_hw_get_number_power_erros();
+    return monitor_dev_get_power_errors(monitor_default);
+
+}
+
+/*
+* Monitor get status function
+*
+* This function reads every Monitor register once and decodes them.
+*
+* @status : status to be filled
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_get_status(struct monitorStatus_t *status){
+
+    return monitor_dev_get_status(monitor_default, status);
 
 }
 
+/*
+* Monitor get capture function
+*
+* This function describes the last capture of the Monitor, leaving the data
+* buffers empty.
+*
+* @capture : capture description
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_get_capture(struct monitorCapture_t *capture){
+
+    return monitor_dev_get_capture(monitor_default, capture);
+
+}
 
 /*
 * Monitor no busy-wait waiting function
@@ -510,12 +2455,10 @@ int monitor_get_power_errors(){
 */
 void monitor_wait(){
 
-    // Monitor management using interrupts and blocking system calls
-    { struct pollfd pfd = { .fd = monitor_fd, .events = POLLIRQ, };  poll(&pfd, 1, -1); }
+    monitor_dev_wait(monitor_default);
 
 }
 
-
 #ifndef AU250
 /*
 * Monitor power consumption read function
@@ -528,44 +2471,9 @@ void monitor_wait(){
 *
 */
 int monitor_read_power_consumption(unsigned int ndata) {
-    struct dmaproxy_token token;
-    monitorpdata_t *mem = NULL;
 
-    struct pollfd pfd;
-    pfd.fd = monitor_fd;
-    pfd.events = POLLDMA;
-   
-    // Allocate DMA physical memory
-    mem = mmap(NULL, ndata * sizeof *mem, PROT_READ | PROT_WRITE, MAP_SHARED, monitor_fd, sysconf(_SC_PAGESIZE));
-    if (mem == MAP_FAILED) {
-        monitor_print_error("[monitor-hw] mmap() failed\n");
-        return -ENOMEM;
-    }
-
-    // Start DMA transfer
-    token.memaddr = mem;
-    token.memoff = 0x00000000;
-    token.hwaddr = (void *)MONITOR_POWER_ADDR;
-    token.hwoff = 0x00000000;
-    token.size = ndata * sizeof *mem;
-    ioctl(monitor_fd, MONITOR_IOC_DMA_HW2MEM_POWER, &token);
-
-    // Wait for DMA transfer to finish
-    poll(&pfd, 1, -1);
-
-
-    if (!monitordata->power){
-        monitor_print_error("[monitor-hw] no power region found (dma transfer)\n");
-        return -1;
-    }
-    // Copy data from DMA-allocated memory buffer to userspace memory buffer
-
-    memcpy(monitordata->power->data, mem, ndata * sizeof *mem);
+    return monitor_dev_read_power_consumption(monitor_default, ndata);
 
-    // Release allocated DMA memory
-    munmap(mem, ndata * sizeof *mem);
-
-    return 0;
 }
 #endif
 
@@ -580,178 +2488,192 @@ int monitor_read_power_consumption(unsigned int ndata) {
 *
 */
 int monitor_read_traces(unsigned int ndata) {
-    struct dmaproxy_token token;
-    monitortdata_t *mem = NULL;
 
-    #ifdef AU250
-    int fpga_fd;
-    char *device = NULL;
-    char *allocated = NULL;
-    #else
-    struct pollfd pfd;
-    pfd.fd = monitor_fd;
-    pfd.events = POLLDMA;
-    #endif
+    return monitor_dev_read_traces(monitor_default, ndata);
 
-    #ifdef AU250
-    //DMA transfer parameters
-    device = "/dev/xdma0_c2h_0";
+}
 
-    fpga_fd = open(device, O_RDWR);
+#ifndef AU250
+/*
+* Monitor asynchronous power consumption read function
+*
+* This function starts reading the monitor power consumption data sampled
+* and returns without waiting for the DMA transfer to finish.
+*
+* @ndata   : amount of data to be read from power memory bank
+*
+* Return : completion file descriptor on success, error code otherwise
+*
+*/
+int monitor_read_power_consumption_async(unsigned int ndata) {
 
-    if (fpga_fd < 0) {
-        fprintf(stderr, "unable to open device %s, %d.\n",
-                device, fpga_fd);
-        perror("open device");
-                return -1;
-    }
+    return monitor_dev_read_power_consumption_async(monitor_default, ndata);
 
-    token.size = ndata * sizeof *mem;
-    token.memoff = 0x00000000;
-    #endif
+}
+#endif
 
-    // Allocate DMA physical memory
-    #ifdef AU250
-    posix_memalign((void **)&allocated, 4096 /*alignment */ , token.size + 4096);
-    if (!allocated) {
-        fprintf(stderr, "OOM %lu.\n", token.size + 4096);
-        monitor_print_error("[artico3-hw] memalign() failed\n");
-        return -ENOMEM;
-        printf("Error allocation\n");
-    }
-    mem = (monitortdata_t *)allocated + token.memoff;
+/*
+* Monitor asynchronous traces read function
+*
+* This function starts reading the monitor traces data sampled and returns
+* without waiting for the DMA transfer to finish.
+*
+* @ndata   : amount of data to be read from traces memory bank
+*
+* Return : completion file descriptor on success, error code otherwise
+*
+*/
+int monitor_read_traces_async(unsigned int ndata) {
 
-    monitor_print_debug("host buffer 0x%lx = %p\n", token.size + 4096, mem); 
-    #else
-    mem = mmap(NULL, ndata * sizeof *mem, PROT_READ | PROT_WRITE, MAP_SHARED, monitor_fd, 2 * sysconf(_SC_PAGESIZE));
-    if (mem == MAP_FAILED) {
-        monitor_print_error("[monitor-hw] mmap() failed\n");
-        return -ENOMEM;
-    }
-    #endif
+    return monitor_dev_read_traces_async(monitor_default, ndata);
 
-    // Start DMA transfer
-    token.memaddr = mem;
-    token.memoff = 0x00000000;
-    token.hwaddr = (void *)MONITOR_TRACES_ADDR;
-    token.hwoff = 0x00000000;
-    token.size = ndata * sizeof *mem;
-    #ifdef AU250
-    read_to_buffer(device, fpga_fd, (char *)token.memaddr, (uint64_t)token.size, (uint64_t)(token.hwaddr+token.hwoff));
-    #else
-    ioctl(monitor_fd, MONITOR_IOC_DMA_HW2MEM_TRACES, &token);
-    #endif
+}
 
-    // Wait for DMA transfer to finish
-    #ifndef AU250
-    poll(&pfd, 1, -1);
-    #endif
+/*
+* Monitor asynchronous read finish function
+*
+* This function completes the transfer started by an asynchronous read.
+*
+* @view    : view to be filled (NULL to copy into the monitor_alloc() region)
+* @timeout : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfer has not finished, error code otherwise
+*
+*/
+int monitor_read_finish(struct monitorView_t *view, int timeout) {
 
-    if (!monitordata->traces){
-        monitor_print_error("[monitor-hw] no traces region found (dma transfer)\n");
-        return -1;
-    }
+    return monitor_dev_read_finish(monitor_default, view, timeout);
 
-    // Copy data from DMA-allocated memory buffer to userspace memory buffer
-    memcpy(monitordata->traces->data, mem, ndata * sizeof *mem);
+}
 
-    // Release allocated DMA memory
-    #ifdef AU250
-    free(allocated);
-    close(fpga_fd);
-    #else
-    munmap(mem, ndata * sizeof *mem);
-    #endif
+/*
+* Monitor drain function
+*
+* This function reads the monitor power consumption and traces data sampled
+* with a single DMA request.
+*
+* @power_ndata  : amount of data to be read from power memory bank
+* @traces_ndata : amount of data to be read from traces memory bank
+* @power_view   : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view  : traces view to be filled (NULL to copy into the monitor_alloc() region)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_drain(unsigned int power_ndata, unsigned int traces_ndata, struct monitorView_t *power_view, struct monitorView_t *traces_view) {
+
+    return monitor_dev_drain(monitor_default, power_ndata, traces_ndata, power_view, traces_view);
 
-    return 0;
 }
 
 /*
-* Monitor allocate buffer memory
+* Monitor asynchronous drain function
 *
-* This function allocates dynamic memory to be used as a buffer between
-* the application and the local memories in the hardware kernels.
+* This function starts reading the monitor power consumption and traces data
+* sampled with a single DMA request and returns without waiting for it.
 *
-* @ndata   : amount of data to be allocated for the buffer
-* @regname : memory bank name to associate this buffer with
-* @regtype : memory bank type (power or traces)
+* @power_ndata  : amount of data to be read from power memory bank
+* @traces_ndata : amount of data to be read from traces memory bank
 *
-* Return : pointer to allocated memory on success, NULL otherwise
+* Return : completion file descriptor on success, error code otherwise
 *
 */
-void *monitor_alloc(int ndata, const char *regname, enum monitorregtype_t regtype) {
-    struct monitorRegion_t *region = NULL;
+int monitor_drain_async(unsigned int power_ndata, unsigned int traces_ndata) {
 
-    // Search for port in port lists
-    if (monitordata->power){
-        if (regtype == MONITOR_REG_POWER){
-            monitor_print_error("[monitor-hw] power region already exist\n");
-            return NULL;
-        }
-        if (strcmp(monitordata->power->name, regname) == 0){
-            monitor_print_error("[monitor-hw] a region has been found with name %s\n", regname);
-            return NULL;
-        }
-    }
-    if (monitordata->traces){
-        if (regtype == MONITOR_REG_TRACES){
-            monitor_print_error("[monitor-hw] traces region already exist\n");
-            return NULL;
-        }
-        if (strcmp(monitordata->traces->name, regname) == 0){
-            monitor_print_error("[monitor-hw] a region has been found with name %s\n", regname);
-            return NULL;
-        }
-    }
+    return monitor_dev_drain_async(monitor_default, power_ndata, traces_ndata);
 
-    // Allocate memory for kernel port configuration
-    region = malloc(sizeof *region);
-    if (!region) {
-        return NULL;
-    }
+}
 
-    // Set port name
-    region->name = malloc(strlen(regname) + 1);
-    if (!region->name) {
-        goto err_malloc_reg_name;
-    }
-    strcpy(region->name, regname);
+/*
+* Monitor asynchronous drain finish function
+*
+* This function completes the transfers started by monitor_drain_async().
+*
+* @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+* @timeout     : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the transfers have not finished, error code otherwise
+*
+*/
+int monitor_drain_finish(struct monitorView_t *power_view, struct monitorView_t *traces_view, int timeout) {
 
-    // Set port size
-    if (regtype == MONITOR_REG_POWER)
-        region->size = ndata * sizeof(monitorpdata_t);
+    return monitor_dev_drain_finish(monitor_default, power_view, traces_view, timeout);
 
-    if (regtype == MONITOR_REG_TRACES)
-        region->size = ndata * sizeof(monitortdata_t);
+}
 
-    // Allocate memory for application
-    region->data = malloc(region->size);
-    if (!region->data) {
-        goto err_malloc_region_data;
-    }
+/*
+* Monitor capture read function
+*
+* This function takes a status snapshot and drains every sample of the
+* last acquisition with a single DMA request.
+*
+* @status      : status to be filled (may be NULL)
+* @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+* @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_read_capture(struct monitorStatus_t *status, struct monitorView_t *power_view, struct monitorView_t *traces_view) {
 
-    // Check port direction flag : POWER
-    if (regtype == MONITOR_REG_POWER)
-        monitordata->power = region;
+    return monitor_dev_read_capture(monitor_default, status, power_view, traces_view);
 
-    // Check port direction flag : TRACES
-    if (regtype == MONITOR_REG_TRACES)
-        monitordata->traces = region;
+}
 
-    // Return allocated memory
-    return region->data;
+/*
+* Monitor view acquire function
+*
+* This function drains a Monitor memory bank into its DMA staging buffer
+* and gives the application read-only access to it.
+*
+* @ndata   : amount of data to be read from the memory bank
+* @regtype : memory bank type (power or traces)
+* @view    : view to be filled
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_view_acquire(unsigned int ndata, enum monitorregtype_t regtype, struct monitorView_t *view) {
 
-err_malloc_reg_name:
-    free(region->name);
-    region->name = NULL;
+    return monitor_dev_view_acquire(monitor_default, ndata, regtype, view);
 
-err_malloc_region_data:
-    free(region);
-    region = NULL;
+}
+
+/*
+* Monitor view release function
+*
+* This function releases a view obtained with monitor_view_acquire().
+*
+* @view : view to be released
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_view_release(struct monitorView_t *view) {
+
+    return monitor_dev_view_release(monitor_default, view);
 
-    return NULL;
 }
 
+/*
+* Monitor allocate buffer memory
+*
+* This function allocates dynamic memory to be used as a buffer between
+* the application and the local memories in the hardware kernels.
+*
+* @ndata   : amount of data to be allocated for the buffer
+* @regname : memory bank name to associate this buffer with
+* @regtype : memory bank type (power or traces)
+*
+* Return : pointer to allocated memory on success, NULL otherwise
+*
+*/
+void *monitor_alloc(int ndata, const char *regname, enum monitorregtype_t regtype) {
+
+    return monitor_dev_alloc(monitor_default, ndata, regname, regtype);
+
+}
 
 /*
 * Monitor release buffer memory
@@ -765,31 +2687,7 @@ err_malloc_region_data:
 *
 */
 int monitor_free(const char *regname) {
-    struct monitorRegion_t *region = NULL;
-
-    // Search for port in port lists
-    if (monitordata->power != NULL){
-        if (strcmp(monitordata->power->name, regname) == 0){
-            region = monitordata->power;
-            monitordata->power = NULL;
-        }
-    }
-    if (monitordata->traces != NULL){
-        if (strcmp(monitordata->traces->name, regname) == 0){
-            region = monitordata->traces;
-            monitordata->traces = NULL;
-        }
-    }
-
-    if (region == NULL) {
-        monitor_print_error("[monitor-hw] no region found with name %s\n", regname);
-        return -ENODEV;
-    }
 
-    // Free application memory
-    free(region->data);
-    free(region->name);
-    free(region);
+    return monitor_dev_free(monitor_default, regname);
 
-    return 0;
 }
@@ -39,8 +39,130 @@
   *
   */
  enum monitorregtype_t {MONITOR_REG_POWER, MONITOR_REG_TRACES};
+
+
+ /*
+  * Default maximum time (in ms) monitor_start() waits for the monitor to be idle
+  *
+  */
+ #define MONITOR_START_TIMEOUT (1000)
+
+
+ /*
+  * Default Monitor clock frequency (in Hz)
+  *
+  */
+ #define MONITOR_CLOCK_FREQ (100000000UL)
+
+
+ /*
+  * ADC voltage references (in mV) set by monitor_config_vref() and
+  * monitor_config_2vref() (the former is assumed until one is called)
+  *
+  */
+ #define MONITOR_VREF_MV  (2500)
+ #define MONITOR_2VREF_MV (5000)
+
+
+ /*
+  * MONITOR status type
+  *
+  * Decoded copy of the Monitor registers, obtained with monitor_get_status()
+  * (each register is read only once).
+  *
+  * @busy           : 1 if the monitor is busy, 0 if idle
+  * @done           : 1 if the acquisition has finished, 0 otherwise
+  * @axi_sniffer    : 1 if the AXI sniffer is enabled, 0 otherwise
+  * @power_errors   : number of incorrect power samples received from the ADC
+  * @power_samples  : number of power consumption measurements
+  * @traces_samples : number of probes events
+  * @elapsed        : acquisition elapsed cycles
+  *
+  */
+ struct monitorStatus_t {
+     unsigned int busy;
+     unsigned int done;
+     unsigned int axi_sniffer;
+     unsigned int power_errors;
+     unsigned int power_samples;
+     unsigned int traces_samples;
+     uint32_t elapsed;
+ };
+
+
+ /*
+  * MONITOR view type
+  *
+  * Read-only window into the DMA staging buffer of a memory bank, obtained
+  * with monitor_view_acquire(). Samples are accessed in place (no copy into
+  * a monitor_alloc() region) until the view is released.
+  *
+  *     struct monitorView_t view;
+  *     monitor_view_acquire(ndata, MONITOR_REG_TRACES, &view);
+  *     const monitortdata_t *traces = view.data;
+  *     ...
+  *     monitor_view_release(&view);
+  *
+  * @data    : pointer to the first sample of the memory bank
+  * @ndata   : number of samples available through @data
+  * @regtype : memory bank the view belongs to
+  *
+  */
+ struct monitorView_t {
+     const void *data;
+     unsigned int ndata;
+     enum monitorregtype_t regtype;
+ };
+
+
+ /*
+  * MONITOR handle type
+  *
+  * Opaque Monitor instance, obtained with monitor_dev_open(). Each handle
+  * owns its device file, register map, staging buffers and memory bank
+  * regions, so that several Monitor infrastructures can be driven from the
+  * same process (each one from its own thread, if needed).
+  *
+  *     monitor_t *slr0 = monitor_dev_open("/dev/monitor");
+  *     monitor_t *slr1 = monitor_dev_open("/dev/monitor1");
+  *
+  */
+ typedef struct monitor monitor_t;
  
  
+ /*
+  * THREADING MODEL
+  *
+  * Every function can be called from any thread. Each Monitor instance
+  * (see monitor_t) is split into three groups of functions, each one with
+  * its own lock, so that a call only waits for calls of its own group:
+  *
+  *     capture control   -> monitor_config_*(), monitor_start*(), monitor_stop(),
+  *                          monitor_clean(), monitor_set_*mask()
+  *     readout           -> monitor_read_*(), monitor_drain*(), monitor_view_*()
+  *     buffer management -> monitor_alloc(), monitor_free()
+  *
+  * A dedicated drain thread can therefore read a capture while the control
+  * thread configures the next one. Readout calls of the same instance are
+  * serialized (there is a single DMA staging path), and a blocking read
+  * keeps later readout calls waiting until it completes. Status getters
+  * (monitor_get_*(), monitor_isdone(), monitor_isbusy()) and monitor_wait()
+  * never wait for a capture control call to finish: they only take its lock
+  * briefly to timestamp the acquisition (monitor_wait(), monitor_get_elapsed()),
+  * and monitor_get_status() on AU250 takes the buffer management lock to
+  * read the CMS sample count.
+  *
+  * The library does not synchronize the application accesses to its own
+  * monitor_alloc() regions: a region must not be read while another thread
+  * is draining into it. On Alveo U250, the CMS thread fills the power
+  * region under the buffer management lock, so it can be released at any
+  * time. monitor_init() and monitor_exit() are serialized against each
+  * other, but monitor_exit() (monitor_dev_close()) must not race with any
+  * other call on the same instance.
+  *
+  */
+
+
  /*
   * SYSTEM INITIALIZATION
   *
@@ -55,6 +177,23 @@
   * Return : 0 on success, error code otherwise
   */
  int monitor_init();
+
+
+ /*
+  * Monitor init function (with capacity hints)
+  *
+  * This function sets up the same software entities as monitor_init(), and
+  * also maps the DMA staging buffers used to drain the Monitor memory banks.
+  * These buffers are kept until monitor_exit() and reused by every read, so
+  * that no DMA memory has to be allocated in the read path. Reads larger
+  * than the hinted capacity are still possible (the buffer grows once).
+  *
+  * @power_capacity  : maximum number of power samples to be read (0 to map on first read)
+  * @traces_capacity : maximum number of traces samples to be read (0 to map on first read)
+  *
+  * Return : 0 on success, error code otherwise
+  */
+ int monitor_init_capacity(unsigned int power_capacity, unsigned int traces_capacity);
  
  
  /*
@@ -88,7 +227,19 @@
   *
   */
  void monitor_config_2vref();
+
+
+ /*
+  * Monitor get voltage reference function
+  *
+  * This function gets the ADC voltage reference last configured.
+  *
+  * Return : voltage reference in mV (MONITOR_VREF_MV or MONITOR_2VREF_MV)
+  *
+  */
+ unsigned int monitor_get_vref();
  
+ #ifdef AU250
  /*
   * Monitor CMS get power meadurements function
   *
@@ -104,14 +255,33 @@
   *
   */
  void monitor_CMS_start();
+ #endif
  
  /*
   * Monitor start function
   *
-  * This function starts the monitor acquisition.
+  * This function starts the monitor acquisition. If the monitor is still
+  * busy (e.g., clearing the memory banks of the previous acquisition), it
+  * first waits for it to become idle, sleeping instead of spinning on its
+  * registers, for at most MONITOR_START_TIMEOUT ms.
+  *
+  * Return : 0 on success, -ETIMEDOUT if the monitor never became idle
+  *
+  */
+ int monitor_start();
+
+
+ /*
+  * Monitor start function (with timeout)
+  *
+  * This function starts the monitor acquisition (see monitor_start()).
+  *
+  * @timeout : maximum time to wait for the monitor to be idle in milliseconds (-1 to wait forever)
+  *
+  * Return : 0 on success, -ETIMEDOUT if the monitor never became idle
   *
   */
- void monitor_start();
+ int monitor_start_timeout(int timeout);
  
  /*
   * Monitor clean function
@@ -121,6 +291,7 @@
   */
  void monitor_clean();
  
+ #ifdef AU250
  /*
  * Monitor CMS stop function
  *
@@ -128,6 +299,7 @@
  *
  */
  void monitor_CMS_stop();
+ #endif
  
  /*
   * Monitor stop function
@@ -167,6 +339,33 @@
   */
  int monitor_get_time();
  
+ /*
+  * Monitor get 64-bit acquisition time function
+  *
+  * This function gets the acquisition elapsed cycles, extended to 64 bits.
+  * The elapsed-cycles register wraps every 2^32 cycles (about 43 s at
+  * 100 MHz); the number of wraps is recovered from the host time between
+  * monitor_start() and the end of the acquisition (as seen by monitor_wait(),
+  * or now if the application did not wait), assuming the Monitor clock
+  * frequency set with monitor_set_clock_frequency().
+  *
+  * Return : Elapsed cycles
+  *
+  */
+ uint64_t monitor_get_elapsed();
+
+
+ /*
+  * Monitor set clock frequency function
+  *
+  * This function sets the Monitor clock frequency (MONITOR_CLOCK_FREQ by default).
+  *
+  * @hz : Monitor clock frequency in Hz
+  *
+  */
+ void monitor_set_clock_frequency(unsigned long hz);
+
+
  /*
   * Monitor get power measurements function
   *
@@ -218,6 +417,22 @@
  int monitor_get_power_errors();
  
  
+ /*
+  * Monitor get status function
+  *
+  * This function reads every Monitor register once and decodes them, so it
+  * replaces a sequence of monitor_get_*(), monitor_isdone() and
+  * monitor_isbusy() calls (one bus access per register instead of one
+  * per call).
+  *
+  * @status : status to be filled
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_get_status(struct monitorStatus_t *status);
+
+
  /*
   * Monitor no busy-wait waiting function
   *
@@ -230,7 +445,9 @@
  /*
   * Monitor power consumption read function
   *
-  * This function reads the monitor power consumption data sampled.
+  * This function reads the monitor power consumption data sampled into the
+  * region allocated with monitor_alloc() (see monitor_view_acquire() for a
+  * zero-copy alternative).
   *
   * @ndata  	: amount of data to be read from power memory bank
   *
@@ -243,7 +460,9 @@
  /*
   * Monitor traces read function
   *
-  * This function reads the monitor traces data sampled.
+  * This function reads the monitor traces data sampled into the region
+  * allocated with monitor_alloc() (see monitor_view_acquire() for a
+  * zero-copy alternative).
   *
   * @ndata  	: amount of data to be read from traces memory bank
   *
@@ -253,6 +472,156 @@
  int monitor_read_traces(unsigned int ndata);
  
  
+ #ifndef AU250
+ /*
+  * Monitor asynchronous power consumption read function
+  *
+  * This function starts reading the monitor power consumption data sampled
+  * and returns as soon as the DMA transfer has been submitted. The returned
+  * descriptor becomes readable (POLLIN/EPOLLIN) when the transfer finishes,
+  * so it can be added to an epoll()/select() set. The transfer must then be
+  * completed with monitor_read_finish(). Only one transfer can be pending.
+  *
+  * @ndata  	: amount of data to be read from power memory bank
+  *
+  * Return : completion file descriptor on success, error code otherwise
+  *
+  */
+ int monitor_read_power_consumption_async(unsigned int ndata);
+ #endif
+
+
+ /*
+  * Monitor asynchronous traces read function
+  *
+  * This function starts reading the monitor traces data sampled and returns
+  * as soon as the DMA transfer has been submitted (see
+  * monitor_read_power_consumption_async()).
+  *
+  * @ndata  	: amount of data to be read from traces memory bank
+  *
+  * Return : completion file descriptor on success, error code otherwise
+  *
+  */
+ int monitor_read_traces_async(unsigned int ndata);
+
+
+ /*
+  * Monitor asynchronous read finish function
+  *
+  * This function completes the transfer started by an asynchronous read.
+  * The data is copied into the region allocated with monitor_alloc(), or
+  * exposed in place when @view is provided (see monitor_view_acquire()).
+  *
+  * @view    : view to be filled (NULL to copy into the monitor_alloc() region)
+  * @timeout : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+  *
+  * Return : 0 on success, -ETIMEDOUT if the transfer has not finished, error code otherwise
+  *
+  */
+ int monitor_read_finish(struct monitorView_t *view, int timeout);
+
+
+ /*
+  * Monitor drain function
+  *
+  * This function reads the monitor power consumption and traces data sampled
+  * at once: both transfers are queued back-to-back on the DMA engine and the
+  * caller is woken up a single time. Each memory bank is copied into its
+  * monitor_alloc() region, or exposed in place when its view is provided.
+  * A memory bank can be skipped by requesting 0 samples from it. On AU250,
+  * only traces can be drained (power samples come from CMS).
+  *
+  * @power_ndata  : amount of data to be read from power memory bank
+  * @traces_ndata : amount of data to be read from traces memory bank
+  * @power_view   : power view to be filled (NULL to copy into the monitor_alloc() region)
+  * @traces_view  : traces view to be filled (NULL to copy into the monitor_alloc() region)
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_drain(unsigned int power_ndata, unsigned int traces_ndata, struct monitorView_t *power_view, struct monitorView_t *traces_view);
+
+
+ /*
+  * Monitor asynchronous drain function
+  *
+  * This function starts draining both memory banks (see monitor_drain()) and
+  * returns the completion descriptor (see monitor_read_power_consumption_async()).
+  * The transfer must then be completed with monitor_drain_finish().
+  *
+  * @power_ndata  : amount of data to be read from power memory bank
+  * @traces_ndata : amount of data to be read from traces memory bank
+  *
+  * Return : completion file descriptor on success, error code otherwise
+  *
+  */
+ int monitor_drain_async(unsigned int power_ndata, unsigned int traces_ndata);
+
+
+ /*
+  * Monitor asynchronous drain finish function
+  *
+  * This function completes the transfers started by monitor_drain_async().
+  *
+  * @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+  * @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+  * @timeout     : maximum time to wait in milliseconds (0 to check, -1 to wait forever)
+  *
+  * Return : 0 on success, -ETIMEDOUT if the transfers have not finished, error code otherwise
+  *
+  */
+ int monitor_drain_finish(struct monitorView_t *power_view, struct monitorView_t *traces_view, int timeout);
+
+
+ /*
+  * Monitor capture read function
+  *
+  * This function takes a status snapshot (see monitor_get_status()) and
+  * drains every sample of the last acquisition (see monitor_drain()).
+  * On AU250, only traces are drained (power samples come from CMS).
+  *
+  * @status      : status to be filled (may be NULL)
+  * @power_view  : power view to be filled (NULL to copy into the monitor_alloc() region)
+  * @traces_view : traces view to be filled (NULL to copy into the monitor_alloc() region)
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_read_capture(struct monitorStatus_t *status, struct monitorView_t *power_view, struct monitorView_t *traces_view);
+
+
+ /*
+  * Monitor view acquire function
+  *
+  * This function reads the monitor data sampled in a memory bank and gives
+  * read-only access to it directly in the DMA staging buffer, so that every
+  * sample is touched only once. While the view is held, any other read of
+  * the same memory bank fails with -EBUSY.
+  *
+  * @ndata   : amount of data to be read from the memory bank
+  * @regtype : memory bank type (power or traces)
+  * @view    : view to be filled
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_view_acquire(unsigned int ndata, enum monitorregtype_t regtype, struct monitorView_t *view);
+
+
+ /*
+  * Monitor view release function
+  *
+  * This function releases a view obtained with monitor_view_acquire().
+  *
+  * @view : view to be released
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_view_release(struct monitorView_t *view);
+
+
  /*
   * Monitor allocate buffer memory
   *
@@ -283,5 +652,110 @@
  int monitor_free(const char *regname);
  
  
+ /*
+  * MULTI-INSTANCE API
+  *
+  * Every function of the API above has a monitor_dev_<name>() counterpart
+  * that takes the Monitor handle as first parameter and otherwise behaves
+  * exactly the same. The API above works on the default Monitor instance,
+  * opened by monitor_init(). Different handles are fully independent.
+  *
+  */
+
+ /*
+  * Monitor open function
+  *
+  * This function opens a Monitor instance and sets up the basic software
+  * entities required to manage it (see monitor_init()).
+  *
+  * @devname : Monitor device file name (NULL for the default device, or
+  *            for the MONITOR_DEVICE environment variable when it is set)
+  *            Zynq devices  -> /dev/monitor, /dev/monitor1, ...
+  *            Alveo devices -> /dev/xdma0_user, /dev/xdma1_user, ...
+  *                             (DMA reads use the matching xdma<N>_c2h_0)
+  *            Simulated     -> sim, sim:<options> (see monitor_sim.h)
+  *            Replayed      -> replay:<file>[,<options>] (see monitor_sim.h)
+  *
+  * Return : Monitor handle on success, NULL otherwise
+  *
+  */
+ monitor_t *monitor_dev_open(const char *devname);
+
+
+ /*
+  * Monitor open function (with capacity hints)
+  *
+  * This function opens a Monitor instance and maps its DMA staging buffers
+  * (see monitor_init_capacity()).
+  *
+  * @devname         : Monitor device file name (NULL for the default device)
+  * @power_capacity  : maximum number of power samples to be read (0 to map on first read)
+  * @traces_capacity : maximum number of traces samples to be read (0 to map on first read)
+  *
+  * Return : Monitor handle on success, NULL otherwise
+  *
+  */
+ monitor_t *monitor_dev_open_capacity(const char *devname, unsigned int power_capacity, unsigned int traces_capacity);
+
+
+ /*
+  * Monitor close function
+  *
+  * This function cleans the software entities created by monitor_dev_open().
+  *
+  * @monitor : Monitor handle
+  *
+  */
+ void monitor_dev_close(monitor_t *monitor);
+
+
+ /*
+  * Monitor default instance function
+  *
+  * This function gets the Monitor instance used by the API above, so that
+  * both APIs can be mixed.
+  *
+  * Return : default Monitor handle (NULL before monitor_init())
+  *
+  */
+ monitor_t *monitor_get_default();
+
+
+ void monitor_dev_config_vref(monitor_t *monitor);
+ void monitor_dev_config_2vref(monitor_t *monitor);
+ unsigned int monitor_dev_get_vref(monitor_t *monitor);
+ int monitor_dev_start(monitor_t *monitor);
+ int monitor_dev_start_timeout(monitor_t *monitor, int timeout);
+ void monitor_dev_clean(monitor_t *monitor);
+ void monitor_dev_stop(monitor_t *monitor);
+ void monitor_dev_set_mask(monitor_t *monitor, int mask);
+ void monitor_dev_set_axi_mask(monitor_t *monitor, int mask);
+ int monitor_dev_get_time(monitor_t *monitor);
+ uint64_t monitor_dev_get_elapsed(monitor_t *monitor);
+ void monitor_dev_set_clock_frequency(monitor_t *monitor, unsigned long hz);
+ int monitor_dev_get_number_power_measurements(monitor_t *monitor);
+ int monitor_dev_get_number_traces_measurements(monitor_t *monitor);
+ int monitor_dev_isdone(monitor_t *monitor);
+ int monitor_dev_isbusy(monitor_t *monitor);
+ int monitor_dev_get_power_errors(monitor_t *monitor);
+ int monitor_dev_get_status(monitor_t *monitor, struct monitorStatus_t *status);
+ void monitor_dev_wait(monitor_t *monitor);
+ #ifndef AU250
+ int monitor_dev_read_power_consumption(monitor_t *monitor, unsigned int ndata);
+ int monitor_dev_read_power_consumption_async(monitor_t *monitor, unsigned int ndata);
+ #endif
+ int monitor_dev_read_traces(monitor_t *monitor, unsigned int ndata);
+ int monitor_dev_read_traces_async(monitor_t *monitor, unsigned int ndata);
+ int monitor_dev_read_finish(monitor_t *monitor, struct monitorView_t *view, int timeout);
+ int monitor_dev_drain(monitor_t *monitor, unsigned int power_ndata, unsigned int traces_ndata, struct monitorView_t *power_view, struct monitorView_t *traces_view);
+ int monitor_dev_drain_async(monitor_t *monitor, unsigned int power_ndata, unsigned int traces_ndata);
+ int monitor_dev_drain_finish(monitor_t *monitor, struct monitorView_t *power_view, struct monitorView_t *traces_view, int timeout);
+ int monitor_dev_read_capture(monitor_t *monitor, struct monitorStatus_t *status, struct monitorView_t *power_view, struct monitorView_t *traces_view);
+ int monitor_dev_view_acquire(monitor_t *monitor, unsigned int ndata, enum monitorregtype_t regtype, struct monitorView_t *view);
+ int monitor_dev_view_release(monitor_t *monitor, struct monitorView_t *view);
+ void *monitor_dev_alloc(monitor_t *monitor, int ndata, const char *regname, enum monitorregtype_t regtype);
+ int monitor_dev_free(monitor_t *monitor, const char *regname);
+
+
  #endif /* _MONITOR_H_ */
  
\ No newline at end of file
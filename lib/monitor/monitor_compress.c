@@ -0,0 +1,724 @@
+/*
+ * Monitor traces compression API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor traces compression API, a
+*               lossless codec for trace records (timestamp deltas as
+*               varints, bit-packed probe toggles) that compresses
+*               independent chunks in parallel.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <pthread.h>   // pthread_create(), pthread_join()
+
+#include "monitor.h"
+#include "monitor_traces.h"
+#include "monitor_compress.h"
+#include "monitor_dbg.h"
+
+#define MONITOR_CHUNK_CODED (0)
+#define MONITOR_CHUNK_RAW   (1)
+
+/*
+* MONITOR compressed traces header type
+*
+* Followed by the size (uint32_t) of every chunk, and then the chunks.
+*
+*/
+struct monitorCompressHeader_t {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t ndata;
+    uint32_t chunk_records;
+    uint32_t nchunks;
+};
+
+/*
+* MONITOR compressed chunk header type
+*
+* Coded chunks are followed by their first record, the timestamp deltas
+* (@varint_size bytes of varints) and the bit-packed toggles.
+*
+*/
+struct monitorCompressChunk_t {
+    uint32_t mode;
+    uint32_t varint_size;
+};
+
+/*
+* MONITOR bit stream type
+*
+*/
+struct monitorBits_t {
+    uint8_t *p;
+    uint8_t *end;
+    uint64_t acc;
+    unsigned int n;
+    int overrun;
+};
+
+/*
+* MONITOR compression job type
+*
+* @src         : first record of the job
+* @dst         : first chunk of the job
+* @ndata       : number of records of the job
+* @record_size : size of a record (in bytes)
+* @nchunks     : number of chunks of the job
+* @offsets     : offset of every chunk from @dst
+* @sizes       : size of every chunk
+* @ret         : job result
+*
+*/
+struct monitorCompressJob_t {
+    const uint8_t *src;
+    uint8_t *dst;
+    unsigned int ndata;
+    unsigned int record_size;
+    unsigned int nchunks;
+    const size_t *offsets;
+    uint32_t *sizes;
+    int ret;
+};
+
+/*
+* Monitor bits put function
+*
+* This function appends the @nbits (up to 32) lower bits of @value.
+*
+*/
+static inline int monitor_bits_put(struct monitorBits_t *bits, uint32_t value, unsigned int nbits) {
+    uint32_t word;
+
+    bits->acc |= (uint64_t)value << bits->n;
+    bits->n += nbits;
+    if (bits->n >= 32) {
+        if (bits->end - bits->p < 4) {
+            return -ENOSPC;
+        }
+        word = (uint32_t)bits->acc;
+        memcpy(bits->p, &word, sizeof word);
+        bits->p += sizeof word;
+        bits->acc >>= 32;
+        bits->n -= 32;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor bits flush function
+*
+* This function writes the bits that are still in the accumulator.
+*
+*/
+static inline int monitor_bits_flush(struct monitorBits_t *bits) {
+
+    while (bits->n) {
+        if (bits->p == bits->end) {
+            return -ENOSPC;
+        }
+        *bits->p++ = (uint8_t)bits->acc;
+        bits->acc >>= 8;
+        bits->n = bits->n > 8 ? bits->n - 8 : 0;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor bits get function
+*
+* This function reads the next @nbits (up to 32) bits.
+*
+*/
+static inline uint32_t monitor_bits_get(struct monitorBits_t *bits, unsigned int nbits) {
+    uint32_t value, word = 0;
+    size_t avail;
+
+    if (bits->n < nbits) {
+        avail = bits->end - bits->p;
+        if (avail > sizeof word) {
+            avail = sizeof word;
+        }
+        if (!avail) {
+            bits->overrun = 1;
+        }
+        memcpy(&word, bits->p, avail);
+        bits->p += avail;
+        bits->acc |= (uint64_t)word << bits->n;
+        bits->n += 32;
+    }
+
+    value = bits->acc & ((1ULL << nbits) - 1);
+    bits->acc >>= nbits;
+    bits->n -= nbits;
+
+    return value;
+}
+
+/*
+* Monitor mask put function
+*
+* This function appends a toggle mask: a 2-bit count followed by the probe
+* indices (1 or 2 toggles), or by the raw mask (more than 2 toggles).
+*
+*/
+static inline int monitor_mask_put(struct monitorBits_t *bits, uint32_t mask) {
+    int ret;
+
+    switch (__builtin_popcount(mask)) {
+        case 0:
+            return monitor_bits_put(bits, 0, 2);
+        case 1:
+            return monitor_bits_put(bits, 1 | (__builtin_ctz(mask) << 2), 7);
+        case 2:
+            return monitor_bits_put(bits, 2 | (__builtin_ctz(mask) << 2) | (__builtin_ctz(mask & (mask - 1)) << 7), 12);
+        default:
+            ret = monitor_bits_put(bits, 3, 2);
+            if (ret < 0) {
+                return ret;
+            }
+            return monitor_bits_put(bits, mask, 32);
+    }
+}
+
+/*
+* Monitor mask get function
+*
+* This function reads a toggle mask (see monitor_mask_put()).
+*
+*/
+static inline uint32_t monitor_mask_get(struct monitorBits_t *bits) {
+    uint32_t mask;
+
+    switch (monitor_bits_get(bits, 2)) {
+        case 0:
+            return 0;
+        case 1:
+            return 1U << monitor_bits_get(bits, 5);
+        case 2:
+            mask = 1U << monitor_bits_get(bits, 5);
+            return mask | (1U << monitor_bits_get(bits, 5));
+        default:
+            return monitor_bits_get(bits, 32);
+    }
+}
+
+/*
+* Monitor varint get function
+*
+* This function reads an unsigned LEB128 varint.
+*
+* Return : 0 on success, -EINVAL on truncated data
+*
+*/
+static inline int monitor_varint_get(const uint8_t **p, const uint8_t *end, uint32_t *value) {
+    unsigned int shift = 0;
+    uint32_t v = 0;
+    uint8_t byte;
+
+    while (*p < end && shift < 35) {
+        byte = *(*p)++;
+        v |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = v;
+            return 0;
+        }
+        shift += 7;
+    }
+
+    return -EINVAL;
+}
+
+/*
+* Monitor record accessors
+*
+* Trace records are either 64-bit (timestamp, probes) or 128-bit
+* (timestamp, pad, axi, probes) words.
+*
+*/
+static inline uint32_t monitor_record_ts(const uint8_t *record) {
+    uint32_t ts;
+
+    memcpy(&ts, record, sizeof ts);
+    return ts;
+}
+
+static inline uint32_t monitor_record_word(const uint8_t *record, unsigned int word) {
+    uint32_t value;
+
+    memcpy(&value, record + word * sizeof value, sizeof value);
+    return value;
+}
+
+/*
+* Monitor chunk compress function
+*
+* This function compresses @ndata records into @dst, which has room for the
+* chunk stored raw. Chunks that do not compress are stored raw.
+*
+* Return : size of the compressed chunk
+*
+*/
+static uint32_t monitor_compress_chunk(const uint8_t *src, unsigned int ndata, unsigned int record_size, uint8_t *dst) {
+    struct monitorCompressChunk_t chunk = { .mode = MONITOR_CHUNK_CODED, };
+    uint8_t *data = dst + sizeof chunk;
+    uint8_t *end = data + (size_t)ndata * record_size;
+    struct monitorBits_t bits;
+    const uint8_t *record;
+    uint32_t dt, pad;
+    uint8_t *p;
+    unsigned int i;
+
+    // First record as is
+    memcpy(data, src, record_size);
+    p = data + record_size;
+
+    // Timestamp deltas (varints)
+    for (i = 1; i < ndata; i++) {
+        if (end - p < 5) {
+            goto raw;
+        }
+        dt = monitor_record_ts(src + i * record_size) - monitor_record_ts(src + (i - 1) * record_size);
+        while (dt >= 0x80) {
+            *p++ = (uint8_t)dt | 0x80;
+            dt >>= 7;
+        }
+        *p++ = (uint8_t)dt;
+    }
+    chunk.varint_size = p - (data + record_size);
+
+    // Probe (and AXI) toggles, bit-packed
+    bits = (struct monitorBits_t){ .p = p, .end = end, };
+    for (i = 1; i < ndata; i++) {
+        record = src + i * record_size;
+        if (record_size == sizeof(monitortdata_t)) {
+            if (monitor_mask_put(&bits, monitor_record_word(record, 1)) < 0) {
+                goto raw;
+            }
+        }
+        else {
+            pad = monitor_record_word(record, 1);
+            if (monitor_mask_put(&bits, monitor_record_word(record, 3)) < 0 ||
+                monitor_mask_put(&bits, monitor_record_word(record, 2)) < 0 ||
+                monitor_bits_put(&bits, pad != 0, 1) < 0 ||
+                (pad && monitor_bits_put(&bits, pad, 32) < 0)) {
+                goto raw;
+            }
+        }
+    }
+    if (monitor_bits_flush(&bits) < 0 || bits.p == end) {
+        goto raw;
+    }
+
+    memcpy(dst, &chunk, sizeof chunk);
+    return bits.p - dst;
+
+raw:
+    chunk.mode = MONITOR_CHUNK_RAW;
+    chunk.varint_size = 0;
+    memcpy(dst, &chunk, sizeof chunk);
+    memcpy(data, src, (size_t)ndata * record_size);
+    return end - dst;
+}
+
+/*
+* Monitor chunk decompress function
+*
+* This function decompresses a chunk of @ndata records.
+*
+* Return : 0 on success, -EINVAL if the chunk is not valid
+*
+*/
+static int monitor_decompress_chunk(const uint8_t *src, uint32_t size, unsigned int ndata, unsigned int record_size, uint8_t *dst) {
+    struct monitorCompressChunk_t chunk;
+    struct monitorBits_t bits;
+    const uint8_t *p, *vend;
+    uint32_t ts, dt, word;
+    uint8_t *record;
+    unsigned int i;
+
+    if (size < sizeof chunk) {
+        return -EINVAL;
+    }
+    memcpy(&chunk, src, sizeof chunk);
+    src += sizeof chunk;
+    size -= sizeof chunk;
+
+    if (chunk.mode == MONITOR_CHUNK_RAW) {
+        if (size != (size_t)ndata * record_size) {
+            return -EINVAL;
+        }
+        memcpy(dst, src, size);
+        return 0;
+    }
+    if (chunk.mode != MONITOR_CHUNK_CODED || size < record_size || chunk.varint_size > size - record_size) {
+        return -EINVAL;
+    }
+
+    memcpy(dst, src, record_size);
+    ts = monitor_record_ts(dst);
+    p = src + record_size;
+    vend = p + chunk.varint_size;
+    bits = (struct monitorBits_t){ .p = (uint8_t *)vend, .end = (uint8_t *)src + size, };
+
+    for (i = 1; i < ndata; i++) {
+        if (monitor_varint_get(&p, vend, &dt) < 0) {
+            return -EINVAL;
+        }
+        ts += dt;
+        record = dst + i * record_size;
+        memcpy(record, &ts, sizeof ts);
+        if (record_size == sizeof(monitortdata_t)) {
+            word = monitor_mask_get(&bits);
+            memcpy(record + 4, &word, sizeof word);
+        }
+        else {
+            word = monitor_mask_get(&bits);
+            memcpy(record + 12, &word, sizeof word);
+            word = monitor_mask_get(&bits);
+            memcpy(record + 8, &word, sizeof word);
+            word = monitor_bits_get(&bits, 1) ? monitor_bits_get(&bits, 32) : 0;
+            memcpy(record + 4, &word, sizeof word);
+        }
+    }
+
+    return bits.overrun ? -EINVAL : 0;
+}
+
+/*
+* Monitor compress worker function
+*
+*/
+static void *monitor_compress_worker(void *arg) {
+    struct monitorCompressJob_t *job = arg;
+    unsigned int j, n;
+
+    for (j = 0; j < job->nchunks; j++) {
+        n = job->ndata - j * MONITOR_COMPRESS_CHUNK;
+        if (n > MONITOR_COMPRESS_CHUNK) {
+            n = MONITOR_COMPRESS_CHUNK;
+        }
+        job->sizes[j] = monitor_compress_chunk(job->src + (size_t)j * MONITOR_COMPRESS_CHUNK * job->record_size, n, job->record_size, job->dst + job->offsets[j]);
+    }
+
+    job->ret = 0;
+    return NULL;
+}
+
+/*
+* Monitor decompress worker function
+*
+*/
+static void *monitor_decompress_worker(void *arg) {
+    struct monitorCompressJob_t *job = arg;
+    unsigned int j, n;
+
+    job->ret = 0;
+    for (j = 0; j < job->nchunks && !job->ret; j++) {
+        n = job->ndata - j * MONITOR_COMPRESS_CHUNK;
+        if (n > MONITOR_COMPRESS_CHUNK) {
+            n = MONITOR_COMPRESS_CHUNK;
+        }
+        job->ret = monitor_decompress_chunk(job->src + job->offsets[j], job->sizes[j], n, job->record_size, job->dst + (size_t)j * MONITOR_COMPRESS_CHUNK * job->record_size);
+    }
+
+    return NULL;
+}
+
+/*
+* Monitor run jobs function
+*
+* This function splits @nchunks chunks in (up to) @threads jobs of
+* consecutive chunks, and runs them in parallel.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_compress_run(void *(*worker)(void *), const uint8_t *src, uint8_t *dst, unsigned int ndata, unsigned int record_size, unsigned int nchunks,
+                                const size_t *offsets, uint32_t *sizes, unsigned int threads, int src_chunked) {
+    struct monitorCompressJob_t *jobs;
+    pthread_t *tids;
+    unsigned int t, first, count, started;
+    int ret = 0;
+
+    if (!threads) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    }
+    if (threads > nchunks) {
+        threads = nchunks;
+    }
+
+    jobs = calloc(threads, sizeof *jobs);
+    tids = calloc(threads, sizeof *tids);
+    if (!jobs || !tids) {
+        monitor_print_error("[monitor-compress] calloc() failed\n");
+        free(jobs);
+        free(tids);
+        return -ENOMEM;
+    }
+
+    for (t = 0, first = 0; t < threads; t++, first += count) {
+        count = nchunks / threads + (t < nchunks % threads);
+        jobs[t].record_size = record_size;
+        jobs[t].nchunks = count;
+        jobs[t].offsets = offsets + first;
+        jobs[t].sizes = sizes + first;
+        jobs[t].ndata = (first + count) * MONITOR_COMPRESS_CHUNK < ndata ? count * MONITOR_COMPRESS_CHUNK : ndata - first * MONITOR_COMPRESS_CHUNK;
+        if (src_chunked) {
+            // Records -> chunks
+            jobs[t].src = src + (size_t)first * MONITOR_COMPRESS_CHUNK * record_size;
+            jobs[t].dst = dst;
+        }
+        else {
+            // Chunks -> records
+            jobs[t].src = src;
+            jobs[t].dst = dst + (size_t)first * MONITOR_COMPRESS_CHUNK * record_size;
+        }
+    }
+
+    // The calling thread runs the first job
+    for (started = 1; started < threads; started++) {
+        if (pthread_create(&tids[started], NULL, worker, &jobs[started]) != 0) {
+            break;
+        }
+    }
+    worker(&jobs[0]);
+    for (t = started; t < threads; t++) {
+        worker(&jobs[t]);
+    }
+    for (t = 1; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    for (t = 0; t < threads; t++) {
+        if (jobs[t].ret < 0) {
+            ret = jobs[t].ret;
+        }
+    }
+
+    free(jobs);
+    free(tids);
+
+    return ret;
+}
+
+/*
+* Monitor traces compress bound function
+*
+* This function gets the size of the buffer needed to compress trace records.
+*
+* @ndata : number of trace records
+* @axi   : records are monitorAxiTrace_t
+*
+* Return : maximum compressed size (in bytes)
+*
+*/
+size_t monitor_traces_compress_bound(unsigned int ndata, int axi) {
+    size_t nchunks = (ndata + MONITOR_COMPRESS_CHUNK - 1) / MONITOR_COMPRESS_CHUNK;
+    size_t record_size = axi ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t);
+
+    return sizeof(struct monitorCompressHeader_t) + nchunks * (sizeof(uint32_t) + sizeof(struct monitorCompressChunk_t)) + ndata * record_size;
+}
+
+/*
+* Monitor traces compress function
+*
+* This function compresses trace records, in chunks compressed in parallel.
+*
+* @traces  : raw trace records
+* @ndata   : number of trace records
+* @axi     : records are monitorAxiTrace_t
+* @dst     : compressed data
+* @size    : size of @dst
+* @threads : number of threads (0 to use one per online CPU)
+*
+* Return : compressed size (in bytes), -ENOSPC if @dst is too small, error
+*          code otherwise
+*
+*/
+int monitor_traces_compress(const void *traces, unsigned int ndata, int axi, void *dst, size_t size, unsigned int threads) {
+    struct monitorCompressHeader_t header;
+    unsigned int record_size = axi ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t);
+    unsigned int nchunks = (ndata + MONITOR_COMPRESS_CHUNK - 1) / MONITOR_COMPRESS_CHUNK;
+    size_t base = sizeof header + nchunks * sizeof(uint32_t);
+    size_t *offsets;
+    uint32_t *sizes;
+    size_t pos;
+    unsigned int j;
+    int ret;
+
+    if (size < monitor_traces_compress_bound(ndata, axi)) {
+        return -ENOSPC;
+    }
+    if (monitor_traces_compress_bound(ndata, axi) > INT_MAX) {
+        return -E2BIG;
+    }
+
+    header.magic = MONITOR_COMPRESS_MAGIC;
+    header.version = MONITOR_COMPRESS_VERSION;
+    header.record_size = record_size;
+    header.ndata = ndata;
+    header.chunk_records = MONITOR_COMPRESS_CHUNK;
+    header.nchunks = nchunks;
+    memcpy(dst, &header, sizeof header);
+    if (!nchunks) {
+        return sizeof header;
+    }
+
+    offsets = malloc(nchunks * sizeof *offsets);
+    sizes = malloc(nchunks * sizeof *sizes);
+    if (!offsets || !sizes) {
+        monitor_print_error("[monitor-compress] malloc() failed\n");
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    // Every chunk gets a slot big enough for it stored raw...
+    for (j = 0; j < nchunks; j++) {
+        offsets[j] = base + (size_t)j * (sizeof(struct monitorCompressChunk_t) + MONITOR_COMPRESS_CHUNK * record_size);
+    }
+    ret = monitor_compress_run(monitor_compress_worker, traces, dst, ndata, record_size, nchunks, offsets, sizes, threads, 1);
+    if (ret < 0) {
+        goto out;
+    }
+
+    // ...and then the chunks are packed one after the other
+    for (j = 0, pos = base; j < nchunks; j++) {
+        memmove((uint8_t *)dst + pos, (uint8_t *)dst + offsets[j], sizes[j]);
+        pos += sizes[j];
+    }
+    memcpy((uint8_t *)dst + sizeof header, sizes, nchunks * sizeof *sizes);
+    ret = pos;
+
+out:
+    free(offsets);
+    free(sizes);
+    return ret;
+}
+
+/*
+* Monitor traces compressed header function
+*
+* This function validates the header of compressed data.
+*
+* Return : 0 on success, -EINVAL otherwise
+*
+*/
+static int monitor_compressed_header(const void *src, size_t size, struct monitorCompressHeader_t *header) {
+
+    if (size < sizeof *header) {
+        return -EINVAL;
+    }
+    memcpy(header, src, sizeof *header);
+    if (header->magic != MONITOR_COMPRESS_MAGIC || header->version != MONITOR_COMPRESS_VERSION || header->chunk_records != MONITOR_COMPRESS_CHUNK ||
+        (header->record_size != sizeof(monitortdata_t) && header->record_size != sizeof(struct monitorAxiTrace_t)) ||
+        header->nchunks != (header->ndata + MONITOR_COMPRESS_CHUNK - 1) / MONITOR_COMPRESS_CHUNK ||
+        header->ndata > INT_MAX || header->nchunks > (size - sizeof *header) / sizeof(uint32_t)) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor traces compressed count function
+*
+* This function gets the number of trace records of compressed data.
+*
+* @src  : compressed data
+* @size : size of @src
+* @axi  : set to 1 if the records are monitorAxiTrace_t (can be NULL)
+*
+* Return : number of trace records, -EINVAL if @src is not valid
+*
+*/
+int monitor_traces_compressed_count(const void *src, size_t size, int *axi) {
+    struct monitorCompressHeader_t header;
+    int ret;
+
+    ret = monitor_compressed_header(src, size, &header);
+    if (ret < 0) {
+        return ret;
+    }
+    if (axi) {
+        *axi = header.record_size == sizeof(struct monitorAxiTrace_t);
+    }
+
+    return header.ndata;
+}
+
+/*
+* Monitor traces decompress function
+*
+* This function decompresses trace records, in chunks decompressed in
+* parallel.
+*
+* @src     : compressed data
+* @size    : size of @src
+* @traces  : trace records
+* @ndata   : capacity of @traces (in records)
+* @threads : number of threads (0 to use one per online CPU)
+*
+* Return : number of trace records, -ENOSPC if @traces is too small,
+*          -EINVAL if @src is not valid, error code otherwise
+*
+*/
+int monitor_traces_decompress(const void *src, size_t size, void *traces, unsigned int ndata, unsigned int threads) {
+    struct monitorCompressHeader_t header;
+    size_t *offsets;
+    uint32_t *sizes;
+    size_t pos;
+    unsigned int j;
+    int ret;
+
+    ret = monitor_compressed_header(src, size, &header);
+    if (ret < 0) {
+        return ret;
+    }
+    if (header.ndata > ndata) {
+        return -ENOSPC;
+    }
+    if (!header.nchunks) {
+        return 0;
+    }
+
+    offsets = malloc(header.nchunks * sizeof *offsets);
+    sizes = malloc(header.nchunks * sizeof *sizes);
+    if (!offsets || !sizes) {
+        monitor_print_error("[monitor-compress] malloc() failed\n");
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    memcpy(sizes, (const uint8_t *)src + sizeof header, header.nchunks * sizeof *sizes);
+    for (j = 0, pos = sizeof header + header.nchunks * sizeof *sizes; j < header.nchunks; j++) {
+        if (sizes[j] > size - pos) {
+            ret = -EINVAL;
+            goto out;
+        }
+        offsets[j] = pos;
+        pos += sizes[j];
+    }
+
+    ret = monitor_compress_run(monitor_decompress_worker, src, traces, header.ndata, header.record_size, header.nchunks, offsets, sizes, threads, 0);
+    if (ret == 0) {
+        ret = header.ndata;
+    }
+
+out:
+    free(offsets);
+    free(sizes);
+    return ret;
+}
@@ -0,0 +1,107 @@
+/*
+ * Monitor traces compression API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor traces compression API, a
+ *               lossless codec for trace records (timestamp deltas as
+ *               varints, bit-packed probe toggles) that compresses
+ *               independent chunks in parallel.
+ *
+ */
+
+
+ #ifndef _MONITOR_COMPRESS_H_
+ #define _MONITOR_COMPRESS_H_
+
+ #include <stddef.h> // size_t
+
+ #include "monitor.h"
+
+
+ /*
+  * Compressed traces identification ("MONZ") and format version
+  *
+  */
+ #define MONITOR_COMPRESS_MAGIC   (0x5a4e4f4d)
+ #define MONITOR_COMPRESS_VERSION (1)
+
+
+ /*
+  * Number of trace records per independently compressed chunk
+  *
+  */
+ #define MONITOR_COMPRESS_CHUNK (4096)
+
+
+ /*
+  * Monitor traces compress bound function
+  *
+  * This function gets the size of the buffer needed to compress trace
+  * records (compression never expands them by more than a few bytes per
+  * chunk, as chunks that do not compress are stored raw).
+  *
+  * @ndata : number of trace records
+  * @axi   : records are monitorAxiTrace_t (AXI sniffer enabled)
+  *
+  * Return : maximum compressed size (in bytes)
+  *
+  */
+ size_t monitor_traces_compress_bound(unsigned int ndata, int axi);
+
+
+ /*
+  * Monitor traces compress function
+  *
+  * This function compresses trace records. Within a chunk, the first record
+  * is stored as is, and then for every record the timestamp delta is stored
+  * as a varint, and the probe toggles (and the AXI sniffer ones) as
+  * bit-packed probe indices, or raw when more than two probes toggle.
+  *
+  * @traces  : raw trace records (monitortdata_t, or monitorAxiTrace_t)
+  * @ndata   : number of trace records
+  * @axi     : records are monitorAxiTrace_t (AXI sniffer enabled)
+  * @dst     : compressed data
+  * @size    : size of @dst (see monitor_traces_compress_bound())
+  * @threads : number of threads (0 to use one per online CPU)
+  *
+  * Return : compressed size (in bytes), -ENOSPC if @dst is too small, error
+  *          code otherwise
+  *
+  */
+ int monitor_traces_compress(const void *traces, unsigned int ndata, int axi, void *dst, size_t size, unsigned int threads);
+
+
+ /*
+  * Monitor traces compressed count function
+  *
+  * This function gets the number of trace records of compressed data.
+  *
+  * @src  : compressed data
+  * @size : size of @src
+  * @axi  : set to 1 if the records are monitorAxiTrace_t (can be NULL)
+  *
+  * Return : number of trace records, -EINVAL if @src is not valid
+  *
+  */
+ int monitor_traces_compressed_count(const void *src, size_t size, int *axi);
+
+
+ /*
+  * Monitor traces decompress function
+  *
+  * This function decompresses trace records.
+  *
+  * @src     : compressed data
+  * @size    : size of @src
+  * @traces  : trace records
+  * @ndata   : capacity of @traces (in records)
+  * @threads : number of threads (0 to use one per online CPU)
+  *
+  * Return : number of trace records, -ENOSPC if @traces is too small,
+  *          -EINVAL if @src is not valid, error code otherwise
+  *
+  */
+ int monitor_traces_decompress(const void *src, size_t size, void *traces, unsigned int ndata, unsigned int threads);
+
+
+ #endif /* _MONITOR_COMPRESS_H_ */
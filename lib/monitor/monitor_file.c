@@ -0,0 +1,815 @@
+/*
+ * Monitor capture file API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor capture file API, which
+*               stores a capture (power and traces data plus everything
+*               needed to interpret them) in a self-describing file.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>  // mmap()
+
+#include "monitor.h"
+#include "monitor_traces.h"
+#include "monitor_file.h"
+#include "monitor_power.h"
+#include "monitor_dbg.h"
+
+#define MONITOR_FILE_ALIGN_UP(x) (((x) + MONITOR_FILE_ALIGN - 1) & ~(uint64_t)(MONITOR_FILE_ALIGN - 1))
+
+// Power samples packed per write (MONITOR_FILE_PACKED_POWER)
+#define MONITOR_FILE_PACK_CHUNK (65536)
+
+/*
+* Monitor file power size function
+*
+* This function gets the size of the power section described by a header.
+*
+* Return : size of the power section (in bytes)
+*
+*/
+static uint64_t monitor_file_power_size(const struct monitorFileHeader_t *header) {
+
+    if (header->flags & MONITOR_FILE_PACKED_POWER) {
+        return (header->power_count + MONITOR_PACK_SAMPLES - 1) / MONITOR_PACK_SAMPLES * MONITOR_PACK_BYTES;
+    }
+
+    return header->power_count * sizeof(monitorpdata_t);
+}
+
+/*
+* Monitor capture check function
+*
+* This function checks that a capture to be written has its data buffers
+* (packed power samples have to be 12-bit ADC codes).
+*
+* Return : 0 on success, -EINVAL otherwise
+*
+*/
+static int monitor_capture_check(const struct monitorCapture_t *capture) {
+
+    if ((capture->flags & MONITOR_FILE_PACKED_POWER) && (capture->flags & MONITOR_FILE_CMS_POWER)) {
+        return -EINVAL;
+    }
+    if (capture->power_count && !capture->power && !((capture->flags & MONITOR_FILE_PACKED_POWER) && capture->power_packed)) {
+        return -EINVAL;
+    }
+    if (capture->traces_count && !capture->traces) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor file header function
+*
+* This function fills in a capture file header and computes the layout of
+* the file (header, power section, traces section).
+*
+* @capture : capture
+* @header  : capture file header
+*
+* Return : size of the file
+*
+*/
+uint64_t monitor_file_header(const struct monitorCapture_t *capture, struct monitorFileHeader_t *header) {
+
+    memset(header, 0, sizeof *header);
+    header->magic = MONITOR_FILE_MAGIC;
+    header->version = MONITOR_FILE_VERSION;
+    header->header_size = sizeof *header;
+    header->flags = capture->flags;
+    header->counter_bits = MONITOR_COUNTER_BITS;
+    header->probes = capture->probes;
+    header->axi_bits = capture->axi_bits;
+    header->trace_size = capture->axi_bits ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t);
+    header->clock_hz = capture->clock_hz;
+    header->vref_mv = capture->vref_mv;
+    header->power_errors = capture->power_errors;
+    header->elapsed = capture->elapsed;
+    header->host_start_ns = capture->host_start.tv_sec * 1000000000LL + capture->host_start.tv_nsec;
+    header->host_done_ns = capture->host_done.tv_sec * 1000000000LL + capture->host_done.tv_nsec;
+
+    // Sections start at aligned offsets
+    header->power_offset = MONITOR_FILE_ALIGN_UP(sizeof *header);
+    header->power_count = capture->power_count;
+    header->traces_offset = MONITOR_FILE_ALIGN_UP(header->power_offset + monitor_file_power_size(header));
+    header->traces_count = capture->traces_count;
+
+    return header->traces_offset + header->traces_count * header->trace_size;
+}
+
+/*
+* Monitor file pwrite function
+*
+* This function writes a whole buffer at a given file offset.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_file_pwrite(int fd, const void *buf, size_t size, uint64_t offset) {
+    const char *p = buf;
+    ssize_t ret;
+
+    while (size) {
+        ret = pwrite(fd, p, size, offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        p += ret;
+        size -= ret;
+        offset += ret;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor file sections write function
+*
+* This function writes the power and traces sections of a capture laid out
+* as in @header, relative to the file offset @base.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_file_write_sections(int fd, uint64_t base, const struct monitorCapture_t *capture, const struct monitorFileHeader_t *header) {
+    uint64_t offset = base + header->power_offset;
+    unsigned int i, n;
+    void *packed;
+    int ret = 0;
+
+    if (!(header->flags & MONITOR_FILE_PACKED_POWER) || capture->power_packed) {
+        ret = monitor_file_pwrite(fd, capture->power_packed ? capture->power_packed : (const void *)capture->power, monitor_file_power_size(header), offset);
+    }
+    else if (capture->power_count) {
+        // Pack through a bounded buffer (chunks are whole packed groups)
+        packed = malloc(monitor_power_packed_size(MONITOR_FILE_PACK_CHUNK));
+        if (!packed) {
+            monitor_print_error("[monitor-file] malloc() failed\n");
+            return -ENOMEM;
+        }
+        for (i = 0; i < capture->power_count && ret == 0; i += n) {
+            n = capture->power_count - i < MONITOR_FILE_PACK_CHUNK ? capture->power_count - i : MONITOR_FILE_PACK_CHUNK;
+            monitor_power_pack(&capture->power[i], n, packed);
+            ret = monitor_file_pwrite(fd, packed, monitor_power_packed_size(n), offset);
+            offset += monitor_power_packed_size(n);
+        }
+        free(packed);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    return monitor_file_pwrite(fd, capture->traces, header->traces_count * header->trace_size, base + header->traces_offset);
+}
+
+/*
+* Monitor file write function
+*
+* This function writes a capture to a file, replacing any previous content.
+*
+* @path    : file path
+* @capture : capture
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_file_write(const char *path, const struct monitorCapture_t *capture) {
+    struct monitorFileHeader_t header;
+    uint64_t size;
+    int fd, ret;
+
+    if (monitor_capture_check(capture) < 0) {
+        return -EINVAL;
+    }
+
+    size = monitor_file_header(capture, &header);
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        monitor_print_error("[monitor-file] open() %s failed\n", path);
+        return -errno;
+    }
+
+    // Set the final size first (padding between sections reads as zeros)
+    if (ftruncate(fd, size) < 0) {
+        ret = -errno;
+        goto err_write;
+    }
+    ret = monitor_file_pwrite(fd, &header, sizeof header, 0);
+    if (ret < 0) {
+        goto err_write;
+    }
+    ret = monitor_file_write_sections(fd, 0, capture, &header);
+    if (ret < 0) {
+        goto err_write;
+    }
+
+    if (close(fd) < 0) {
+        return -errno;
+    }
+
+    return 0;
+
+err_write:
+    monitor_print_error("[monitor-file] write %s failed\n", path);
+    close(fd);
+    return ret;
+}
+
+/*
+* Monitor file header check function
+*
+* This function checks that a header describes a valid layout within a file
+* of @size bytes.
+*
+* Return : 0 on success, -EINVAL otherwise
+*
+*/
+static int monitor_file_check(const struct monitorFileHeader_t *header, uint64_t size) {
+
+    if (size < sizeof *header || header->magic != MONITOR_FILE_MAGIC || header->version < 1 || header->header_size < sizeof *header) {
+        return -EINVAL;
+    }
+    if (header->trace_size != sizeof(monitortdata_t) && header->trace_size != sizeof(struct monitorAxiTrace_t)) {
+        return -EINVAL;
+    }
+    if ((header->power_offset % MONITOR_FILE_ALIGN) || (header->traces_offset % MONITOR_FILE_ALIGN)) {
+        return -EINVAL;
+    }
+    if (header->power_offset > size || header->power_count > size || monitor_file_power_size(header) > size - header->power_offset) {
+        return -EINVAL;
+    }
+    if (header->traces_offset > size || header->traces_count > (size - header->traces_offset) / header->trace_size) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor file open function
+*
+* This function maps a capture file (read-only) and validates its layout.
+*
+* @path : file path
+* @file : capture file
+*
+* Return : 0 on success, -EINVAL if it is not a valid capture file, error
+*          code otherwise
+*
+*/
+int monitor_file_open(const char *path, struct monitorFile_t *file) {
+    struct stat st;
+    int fd, ret;
+
+    memset(file, 0, sizeof *file);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        monitor_print_error("[monitor-file] open() %s failed\n", path);
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0) {
+        ret = -errno;
+        close(fd);
+        return ret;
+    }
+    if ((uint64_t)st.st_size < sizeof(struct monitorFileHeader_t)) {
+        close(fd);
+        return -EINVAL;
+    }
+
+    file->map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file->map == MAP_FAILED) {
+        file->map = NULL;
+        monitor_print_error("[monitor-file] mmap() %s failed\n", path);
+        return -ENOMEM;
+    }
+    file->size = st.st_size;
+    file->header = file->map;
+
+    ret = monitor_file_check(file->header, file->size);
+    if (ret < 0) {
+        monitor_print_error("[monitor-file] %s is not a valid capture file\n", path);
+        monitor_file_close(file);
+        return ret;
+    }
+
+    if (file->header->flags & MONITOR_FILE_PACKED_POWER) {
+        file->power_packed = (const char *)file->map + file->header->power_offset;
+    }
+    else {
+        file->power = (const monitorpdata_t *)((const char *)file->map + file->header->power_offset);
+    }
+    file->traces = (const char *)file->map + file->header->traces_offset;
+
+    return 0;
+}
+
+/*
+* Monitor file close function
+*
+* This function unmaps a capture file.
+*
+* @file : capture file
+*
+*/
+void monitor_file_close(struct monitorFile_t *file) {
+
+    if (file->map) {
+        munmap(file->map, file->size);
+    }
+    memset(file, 0, sizeof *file);
+
+}
+
+/*
+* Monitor archive checksum function
+*
+* This function computes the FNV-1a hash of a buffer.
+*
+*/
+static uint64_t monitor_archive_checksum(const void *buf, size_t size) {
+    const unsigned char *p = buf;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (size--) {
+        hash ^= *p++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/*
+* Monitor archive pread function
+*
+* This function reads a whole buffer at a given file offset.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_archive_pread(int fd, void *buf, size_t size, uint64_t offset) {
+    char *p = buf;
+    ssize_t ret;
+
+    while (size) {
+        ret = pread(fd, p, size, offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (ret == 0) {
+            return -EINVAL;
+        }
+        p += ret;
+        size -= ret;
+        offset += ret;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor archive reserve function
+*
+* This function makes room in the in-memory index for @count entries.
+*
+* Return : 0 on success, -ENOMEM otherwise
+*
+*/
+static int monitor_archive_reserve(struct monitorArchive_t *archive, unsigned int count) {
+    struct monitorArchiveEntry_t *index;
+    unsigned int capacity;
+
+    if (count <= archive->capacity) {
+        return 0;
+    }
+
+    capacity = archive->capacity ? archive->capacity : 64;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    index = realloc(archive->capacity ? archive->index : NULL, capacity * sizeof *index);
+    if (!index) {
+        monitor_print_error("[monitor-file] realloc() failed\n");
+        return -ENOMEM;
+    }
+    archive->index = index;
+    archive->capacity = capacity;
+
+    return 0;
+}
+
+/*
+* Monitor archive load function
+*
+* This function loads the index the archive header points to.
+*
+* Return : 0 on success, -EINVAL if the index is not valid, error code otherwise
+*
+*/
+static int monitor_archive_load(struct monitorArchive_t *archive, const struct monitorArchiveHeader_t *header, uint64_t size) {
+    struct monitorArchiveFooter_t footer;
+    uint64_t bytes;
+    int ret;
+
+    if (header->footer_offset < MONITOR_FILE_ALIGN || header->footer_offset > size - sizeof footer) {
+        return -EINVAL;
+    }
+    ret = monitor_archive_pread(archive->fd, &footer, sizeof footer, header->footer_offset);
+    if (ret < 0) {
+        return ret;
+    }
+    if (footer.magic != MONITOR_ARCHIVE_FOOTER || footer.version != MONITOR_ARCHIVE_VERSION || footer.index_offset > header->footer_offset ||
+        footer.count > (header->footer_offset - footer.index_offset) / sizeof(struct monitorArchiveEntry_t)) {
+        return -EINVAL;
+    }
+    bytes = footer.count * sizeof(struct monitorArchiveEntry_t);
+    if (footer.index_offset + bytes != header->footer_offset) {
+        return -EINVAL;
+    }
+
+    if (archive->map) {
+        // Readers use the index straight from the mapping
+        archive->index = (struct monitorArchiveEntry_t *)((char *)archive->map + footer.index_offset);
+    }
+    else {
+        ret = monitor_archive_reserve(archive, footer.count);
+        if (ret < 0) {
+            return ret;
+        }
+        ret = monitor_archive_pread(archive->fd, archive->index, bytes, footer.index_offset);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    if (monitor_archive_checksum(archive->index, bytes) != footer.checksum) {
+        if (archive->map) {
+            archive->index = NULL;
+        }
+        return -EINVAL;
+    }
+
+    archive->count = footer.count;
+    archive->end = footer.index_offset;
+
+    return 0;
+}
+
+/*
+* Monitor archive recover function
+*
+* This function rebuilds the index by walking the capture chunks from the
+* beginning of the archive, stopping at the first one that is not complete.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_archive_recover(struct monitorArchive_t *archive, uint64_t size) {
+    struct monitorFileHeader_t header;
+    struct monitorArchiveEntry_t *entry;
+    uint64_t offset = MONITOR_FILE_ALIGN;
+    uint64_t chunk;
+    int ret;
+
+    monitor_print_info("[monitor-file] archive index not valid, rebuilding it\n");
+
+    // Readers cannot use the mapping for a rebuilt index
+    if (archive->capacity) {
+        free(archive->index);
+    }
+    archive->index = NULL;
+    archive->capacity = 0;
+    archive->count = 0;
+
+    while (offset + sizeof header <= size) {
+        if (monitor_archive_pread(archive->fd, &header, sizeof header, offset) < 0) {
+            break;
+        }
+        if (monitor_file_check(&header, size - offset) < 0) {
+            break;
+        }
+        ret = monitor_archive_reserve(archive, archive->count + 1);
+        if (ret < 0) {
+            return ret;
+        }
+        chunk = header.traces_offset + header.traces_count * header.trace_size;
+        entry = &archive->index[archive->count++];
+        entry->offset = offset;
+        entry->size = chunk;
+        entry->host_start_ns = header.host_start_ns;
+        entry->host_done_ns = header.host_done_ns;
+        offset = MONITOR_FILE_ALIGN_UP(offset + chunk);
+    }
+
+    archive->end = offset;
+
+    return 0;
+}
+
+/*
+* Monitor archive commit function
+*
+* This function writes the index after the last capture chunk, and then
+* points the archive header to it (each step synced before the next one).
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_archive_commit(struct monitorArchive_t *archive) {
+    struct monitorArchiveHeader_t header;
+    struct monitorArchiveFooter_t footer;
+    uint64_t bytes = (uint64_t)archive->count * sizeof *archive->index;
+    int ret;
+
+    footer.magic = MONITOR_ARCHIVE_FOOTER;
+    footer.version = MONITOR_ARCHIVE_VERSION;
+    footer.count = archive->count;
+    footer.index_offset = archive->end;
+    footer.checksum = monitor_archive_checksum(archive->index, bytes);
+
+    ret = monitor_file_pwrite(archive->fd, archive->index, bytes, archive->end);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = monitor_file_pwrite(archive->fd, &footer, sizeof footer, archive->end + bytes);
+    if (ret < 0) {
+        return ret;
+    }
+    if (ftruncate(archive->fd, archive->end + bytes + sizeof footer) < 0 || fdatasync(archive->fd) < 0) {
+        return -errno;
+    }
+
+    memset(&header, 0, sizeof header);
+    header.magic = MONITOR_ARCHIVE_MAGIC;
+    header.version = MONITOR_ARCHIVE_VERSION;
+    header.header_size = sizeof header;
+    header.footer_offset = archive->end + bytes;
+    ret = monitor_file_pwrite(archive->fd, &header, sizeof header, 0);
+    if (ret < 0) {
+        return ret;
+    }
+    if (fdatasync(archive->fd) < 0) {
+        return -errno;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor archive open function
+*
+* This function opens a multi-capture archive, rebuilding its index if the
+* last append did not complete.
+*
+* @path    : archive path
+* @flags   : MONITOR_ARCHIVE_READ or MONITOR_ARCHIVE_WRITE
+* @archive : archive
+*
+* Return : 0 on success, -EINVAL if it is not a valid archive, error code
+*          otherwise
+*
+*/
+int monitor_archive_open(const char *path, int flags, struct monitorArchive_t *archive) {
+    struct monitorArchiveHeader_t header;
+    struct stat st;
+    int ret;
+
+    memset(archive, 0, sizeof *archive);
+    archive->flags = flags;
+
+    archive->fd = open(path, flags == MONITOR_ARCHIVE_WRITE ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (archive->fd < 0) {
+        monitor_print_error("[monitor-file] open() %s failed\n", path);
+        return -errno;
+    }
+    if (fstat(archive->fd, &st) < 0) {
+        ret = -errno;
+        goto err_open;
+    }
+
+    // New archive: empty index right after the header block
+    if (st.st_size == 0 && flags == MONITOR_ARCHIVE_WRITE) {
+        archive->end = MONITOR_FILE_ALIGN;
+        ret = monitor_archive_commit(archive);
+        if (ret < 0) {
+            goto err_open;
+        }
+        return 0;
+    }
+
+    ret = monitor_archive_pread(archive->fd, &header, sizeof header, 0);
+    if (ret < 0 || header.magic != MONITOR_ARCHIVE_MAGIC || header.version < 1 || header.header_size < sizeof header) {
+        monitor_print_error("[monitor-file] %s is not a valid archive\n", path);
+        ret = -EINVAL;
+        goto err_open;
+    }
+
+    if (flags != MONITOR_ARCHIVE_WRITE) {
+        archive->map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, archive->fd, 0);
+        if (archive->map == MAP_FAILED) {
+            archive->map = NULL;
+            monitor_print_error("[monitor-file] mmap() %s failed\n", path);
+            ret = -ENOMEM;
+            goto err_open;
+        }
+        archive->size = st.st_size;
+    }
+
+    ret = monitor_archive_load(archive, &header, st.st_size);
+    if (ret == -EINVAL) {
+        ret = monitor_archive_recover(archive, st.st_size);
+        if (ret == 0 && flags == MONITOR_ARCHIVE_WRITE) {
+            // Drop the incomplete capture and commit the rebuilt index
+            ret = monitor_archive_commit(archive);
+        }
+    }
+    if (ret < 0) {
+        goto err_open;
+    }
+
+    return 0;
+
+err_open:
+    monitor_archive_close(archive);
+    return ret;
+}
+
+/*
+* Monitor archive append function
+*
+* This function appends a capture to an archive opened for writing: the
+* chunk data, the chunk header, the index and the archive header are written
+* in this order, each step synced before the next one. The chunk overwrites
+* the committed index and footer, so until the archive header is updated
+* the archive has no valid index, and a crash in between makes the next
+* monitor_archive_open() rebuild it by reading the header of every chunk
+* (O(n) in the number of captures). Writing the chunk after the footer
+* instead would leave a stale index behind on every append.
+*
+* @archive : archive
+* @capture : capture
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_archive_append(struct monitorArchive_t *archive, const struct monitorCapture_t *capture) {
+    struct monitorFileHeader_t header;
+    struct monitorArchiveEntry_t *entry;
+    uint64_t size;
+    int ret;
+
+    if (archive->flags != MONITOR_ARCHIVE_WRITE) {
+        return -EBADF;
+    }
+    if (monitor_capture_check(capture) < 0) {
+        return -EINVAL;
+    }
+    ret = monitor_archive_reserve(archive, archive->count + 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // The chunk goes where the current index is (invalidating it until the header moves)
+    size = monitor_file_header(capture, &header);
+    ret = monitor_file_write_sections(archive->fd, archive->end, capture, &header);
+    if (ret < 0) {
+        return ret;
+    }
+    if (fdatasync(archive->fd) < 0) {
+        return -errno;
+    }
+    ret = monitor_file_pwrite(archive->fd, &header, sizeof header, archive->end);
+    if (ret < 0) {
+        return ret;
+    }
+
+    entry = &archive->index[archive->count];
+    entry->offset = archive->end;
+    entry->size = size;
+    entry->host_start_ns = header.host_start_ns;
+    entry->host_done_ns = header.host_done_ns;
+    archive->count++;
+    archive->end = MONITOR_FILE_ALIGN_UP(archive->end + size);
+
+    return monitor_archive_commit(archive);
+}
+
+/*
+* Monitor archive capture function
+*
+* This function gets a capture of an archive opened for reading.
+*
+* @archive : archive
+* @n       : capture number
+* @file    : capture
+*
+* Return : 0 on success, -ENOENT if there is no such capture, -EINVAL if
+*          the capture is not valid
+*
+*/
+int monitor_archive_capture(const struct monitorArchive_t *archive, unsigned int n, struct monitorFile_t *file) {
+    const struct monitorArchiveEntry_t *entry;
+    const char *chunk;
+
+    memset(file, 0, sizeof *file);
+
+    if (!archive->map || n >= archive->count) {
+        return -ENOENT;
+    }
+    entry = &archive->index[n];
+    if (entry->offset % MONITOR_FILE_ALIGN || entry->offset > archive->size || entry->size > archive->size - entry->offset) {
+        return -EINVAL;
+    }
+
+    chunk = (const char *)archive->map + entry->offset;
+    if (monitor_file_check((const struct monitorFileHeader_t *)chunk, entry->size) < 0) {
+        return -EINVAL;
+    }
+
+    // Not owned by @file (monitor_file_close() does not unmap it)
+    file->header = (const struct monitorFileHeader_t *)chunk;
+    if (file->header->flags & MONITOR_FILE_PACKED_POWER) {
+        file->power_packed = chunk + file->header->power_offset;
+    }
+    else {
+        file->power = (const monitorpdata_t *)(chunk + file->header->power_offset);
+    }
+    file->traces = chunk + file->header->traces_offset;
+
+    return 0;
+}
+
+/*
+* Monitor archive find function
+*
+* This function finds the capture in progress at a given host time (or the
+* last one started before it) with a binary search.
+*
+* @archive : archive
+* @host_ns : host time (CLOCK_REALTIME, ns)
+*
+* Return : capture number, -ENOENT if no capture started before @host_ns
+*
+*/
+int monitor_archive_find(const struct monitorArchive_t *archive, int64_t host_ns) {
+    unsigned int lo = 0, hi = archive->count, mid;
+
+    // First capture that starts after @host_ns
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (archive->index[mid].host_start_ns <= host_ns) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo ? (int)(lo - 1) : -ENOENT;
+}
+
+/*
+* Monitor archive close function
+*
+* This function closes an archive.
+*
+* @archive : archive
+*
+*/
+void monitor_archive_close(struct monitorArchive_t *archive) {
+
+    if (archive->capacity) {
+        free(archive->index);
+    }
+    if (archive->map) {
+        munmap(archive->map, archive->size);
+    }
+    if (archive->fd >= 0) {
+        close(archive->fd);
+    }
+    memset(archive, 0, sizeof *archive);
+    archive->fd = -1;
+
+}
@@ -0,0 +1,425 @@
+/*
+ * Monitor capture file API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor capture file API, which
+ *               stores a capture (power and traces data plus everything
+ *               needed to interpret them) in a self-describing file.
+ *
+ */
+
+
+ #ifndef _MONITOR_FILE_H_
+ #define _MONITOR_FILE_H_
+
+ #include <stdint.h> // uint64_t
+ #include <stddef.h> // size_t
+ #include <time.h>   // struct timespec
+
+ #include "monitor.h"
+
+
+ /*
+  * Capture file identification ("MONC") and format version
+  *
+  */
+ #define MONITOR_FILE_MAGIC   (0x434e4f4d)
+ #define MONITOR_FILE_VERSION (1)
+
+
+ /*
+  * Alignment of the data sections (so they can be used straight from mmap)
+  *
+  */
+ #define MONITOR_FILE_ALIGN (4096)
+
+
+ /*
+  * Archive file identification ("MONA"), index footer identification
+  * ("MONI") and format version
+  *
+  */
+ #define MONITOR_ARCHIVE_MAGIC   (0x414e4f4d)
+ #define MONITOR_ARCHIVE_FOOTER  (0x494e4f4d)
+ #define MONITOR_ARCHIVE_VERSION (1)
+
+
+ /*
+  * Archive open flags
+  *
+  * MONITOR_ARCHIVE_READ  - map the archive to read its captures
+  * MONITOR_ARCHIVE_WRITE - append captures (the archive is created if needed)
+  *
+  */
+ #define MONITOR_ARCHIVE_READ  (0)
+ #define MONITOR_ARCHIVE_WRITE (1)
+
+
+ /*
+  * Capture file flags
+  *
+  * MONITOR_FILE_CMS_POWER    - power samples come from the Alveo CMS (not ADC codes)
+  * MONITOR_FILE_PACKED_POWER - power samples are stored packed (see monitor_power_pack())
+  *
+  */
+ #define MONITOR_FILE_CMS_POWER    (1 << 0)
+ #define MONITOR_FILE_PACKED_POWER (1 << 1)
+
+
+ /*
+  * MONITOR capture file header type
+  *
+  * Stored at the beginning of the file, in the byte order of the board.
+  * Readers must skip @header_size bytes (newer versions may append fields).
+  *
+  * @magic         : MONITOR_FILE_MAGIC
+  * @version       : MONITOR_FILE_VERSION
+  * @header_size   : size of the header (in bytes)
+  * @flags         : MONITOR_FILE_* flags
+  * @counter_bits  : width of the timestamp counter (COUNTER_BITS)
+  * @probes        : number of probes in use (NUMBER_PROBES)
+  * @axi_bits      : width of the AXI sniffer data (0 if disabled)
+  * @trace_size    : size of a trace record (in bytes)
+  * @clock_hz      : Monitor clock frequency in Hz
+  * @vref_mv       : ADC voltage reference in mV
+  * @power_errors  : number of power errors
+  * @elapsed       : 64-bit elapsed cycles of the capture
+  * @host_start_ns : host time (CLOCK_REALTIME, ns) of the start of the capture
+  * @host_done_ns  : host time (CLOCK_REALTIME, ns) of the end of the capture
+  * @power_offset  : file offset of the power section (MONITOR_FILE_ALIGN aligned)
+  * @power_count   : number of power samples
+  * @traces_offset : file offset of the traces section (MONITOR_FILE_ALIGN aligned)
+  * @traces_count  : number of trace records
+  *
+  */
+ struct monitorFileHeader_t {
+     uint32_t magic;
+     uint16_t version;
+     uint16_t header_size;
+     uint32_t flags;
+     uint8_t counter_bits;
+     uint8_t probes;
+     uint8_t axi_bits;
+     uint8_t trace_size;
+     uint64_t clock_hz;
+     uint32_t vref_mv;
+     uint32_t power_errors;
+     uint64_t elapsed;
+     int64_t host_start_ns;
+     int64_t host_done_ns;
+     uint64_t power_offset;
+     uint64_t power_count;
+     uint64_t traces_offset;
+     uint64_t traces_count;
+ };
+
+
+ /*
+  * MONITOR archive header type
+  *
+  * Stored at the beginning of an archive file, in its own MONITOR_FILE_ALIGN
+  * block. Captures are stored after it as chunks (each one laid out as a
+  * capture file, at an aligned offset), followed by the index and its footer.
+  *
+  * @magic         : MONITOR_ARCHIVE_MAGIC
+  * @version       : MONITOR_ARCHIVE_VERSION
+  * @header_size   : size of the header (in bytes)
+  * @footer_offset : file offset of the footer of the last committed index
+  *
+  */
+ struct monitorArchiveHeader_t {
+     uint32_t magic;
+     uint16_t version;
+     uint16_t header_size;
+     uint64_t footer_offset;
+ };
+
+
+ /*
+  * MONITOR archive index entry type
+  *
+  * @offset        : file offset of the capture chunk
+  * @size          : size of the capture chunk (in bytes)
+  * @host_start_ns : host time (CLOCK_REALTIME, ns) of the start of the capture
+  * @host_done_ns  : host time (CLOCK_REALTIME, ns) of the end of the capture
+  *
+  */
+ struct monitorArchiveEntry_t {
+     uint64_t offset;
+     uint64_t size;
+     int64_t host_start_ns;
+     int64_t host_done_ns;
+ };
+
+
+ /*
+  * MONITOR archive index footer type
+  *
+  * Stored right after the index entries.
+  *
+  * @magic        : MONITOR_ARCHIVE_FOOTER
+  * @version      : MONITOR_ARCHIVE_VERSION
+  * @count        : number of captures
+  * @index_offset : file offset of the index entries
+  * @checksum     : FNV-1a hash of the index entries
+  *
+  */
+ struct monitorArchiveFooter_t {
+     uint32_t magic;
+     uint32_t version;
+     uint64_t count;
+     uint64_t index_offset;
+     uint64_t checksum;
+ };
+
+
+ /*
+  * MONITOR archive type
+  *
+  * @fd       : archive file descriptor
+  * @flags    : MONITOR_ARCHIVE_* open flags
+  * @map      : archive mapping (MONITOR_ARCHIVE_READ)
+  * @size     : size of the archive mapping
+  * @index    : index entries
+  * @count    : number of captures
+  * @capacity : capacity of @index (MONITOR_ARCHIVE_WRITE, or after recovery)
+  * @end      : file offset right after the last capture chunk
+  *
+  */
+ struct monitorArchive_t {
+     int fd;
+     int flags;
+     void *map;
+     size_t size;
+     struct monitorArchiveEntry_t *index;
+     unsigned int count;
+     unsigned int capacity;
+     uint64_t end;
+ };
+
+
+ /*
+  * MONITOR capture type
+  *
+  * Description of a capture to be written (see monitor_get_capture(), which
+  * fills in everything but the data buffers).
+  *
+  * @clock_hz     : Monitor clock frequency in Hz
+  * @vref_mv      : ADC voltage reference in mV
+  * @probes       : number of probes in use
+  * @axi_bits     : width of the AXI sniffer data (0 if disabled)
+  * @power_errors : number of power errors
+  * @elapsed      : 64-bit elapsed cycles of the capture
+  * @host_start   : host time (CLOCK_REALTIME) of the start of the capture
+  * @host_done    : host time (CLOCK_REALTIME) of the end of the capture
+  * @flags        : MONITOR_FILE_* flags
+  * @power        : power samples
+  * @power_packed : packed power samples, written as is with
+  *                 MONITOR_FILE_PACKED_POWER (if NULL, @power is packed
+  *                 while it is written)
+  * @power_count  : number of power samples
+  * @traces       : trace records (monitortdata_t, or monitorAxiTrace_t
+  *                 when @axi_bits is not 0)
+  * @traces_count : number of trace records
+  *
+  */
+ struct monitorCapture_t {
+     unsigned long clock_hz;
+     unsigned int vref_mv;
+     unsigned int probes;
+     unsigned int axi_bits;
+     unsigned int power_errors;
+     uint64_t elapsed;
+     struct timespec host_start;
+     struct timespec host_done;
+     unsigned int flags;
+     const monitorpdata_t *power;
+     const void *power_packed;
+     unsigned int power_count;
+     const void *traces;
+     unsigned int traces_count;
+ };
+
+
+ /*
+  * MONITOR capture file type
+  *
+  * Capture file mapped in memory (see monitor_file_open()).
+  *
+  * @map          : file mapping
+  * @size         : size of the file mapping
+  * @header       : capture file header
+  * @power        : power samples (@header->power_count elements), NULL
+  *                 with MONITOR_FILE_PACKED_POWER
+  * @power_packed : packed power samples with MONITOR_FILE_PACKED_POWER (see
+  *                 monitor_power_unpack()), NULL otherwise
+  * @traces       : trace records (@header->traces_count elements)
+  *
+  */
+ struct monitorFile_t {
+     void *map;
+     size_t size;
+     const struct monitorFileHeader_t *header;
+     const monitorpdata_t *power;
+     const void *power_packed;
+     const void *traces;
+ };
+
+
+ /*
+  * Monitor get capture function
+  *
+  * This function describes the last capture of the Monitor (status, elapsed
+  * cycles, clock frequency, voltage reference and host time), leaving the
+  * data buffers empty.
+  *
+  * @capture : capture description
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_get_capture(struct monitorCapture_t *capture);
+
+
+ /*
+  * Monitor file header function
+  *
+  * This function fills in a capture file header and computes the layout of
+  * the file.
+  *
+  * @capture : capture
+  * @header  : capture file header
+  *
+  * Return : size of the file
+  *
+  */
+ uint64_t monitor_file_header(const struct monitorCapture_t *capture, struct monitorFileHeader_t *header);
+
+
+ /*
+  * Monitor file write function
+  *
+  * This function writes a capture to a file, replacing any previous content.
+  *
+  * @path    : file path
+  * @capture : capture
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_file_write(const char *path, const struct monitorCapture_t *capture);
+
+
+ /*
+  * Monitor file open function
+  *
+  * This function maps a capture file (read-only) and validates its layout.
+  *
+  * @path : file path
+  * @file : capture file
+  *
+  * Return : 0 on success, -EINVAL if it is not a valid capture file, error
+  *          code otherwise
+  *
+  */
+ int monitor_file_open(const char *path, struct monitorFile_t *file);
+
+
+ /*
+  * Monitor file close function
+  *
+  * This function unmaps a capture file.
+  *
+  * @file : capture file
+  *
+  */
+ void monitor_file_close(struct monitorFile_t *file);
+
+
+ /*
+  * Monitor archive open function
+  *
+  * This function opens a multi-capture archive. Its index is found through
+  * the archive header in O(1); if the last append did not complete (e.g.,
+  * power loss), the index is rebuilt from the capture chunks and the
+  * incomplete capture is discarded.
+  *
+  * @path    : archive path
+  * @flags   : MONITOR_ARCHIVE_READ or MONITOR_ARCHIVE_WRITE
+  * @archive : archive
+  *
+  * Return : 0 on success, -EINVAL if it is not a valid archive, error code
+  *          otherwise
+  *
+  */
+ int monitor_archive_open(const char *path, int flags, struct monitorArchive_t *archive);
+
+
+ /*
+  * Monitor archive append function
+  *
+  * This function appends a capture to an archive opened for writing. The
+  * capture chunk and the new index are written and synced before the
+  * archive header is updated to point to the new index, so a crash at any
+  * point leaves the archive with every previously appended capture. The
+  * chunk is written over the previous index, though: after a crash in the
+  * middle of an append, monitor_archive_open() finds no valid index and
+  * rebuilds it from the chunk headers, which takes one read per capture.
+  *
+  * @archive : archive
+  * @capture : capture
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_archive_append(struct monitorArchive_t *archive, const struct monitorCapture_t *capture);
+
+
+ /*
+  * Monitor archive capture function
+  *
+  * This function gets a capture of an archive opened for reading, straight
+  * from its mapping (monitor_file_close() is not needed for @file).
+  *
+  * @archive : archive
+  * @n       : capture number (0 is the first capture)
+  * @file    : capture
+  *
+  * Return : 0 on success, -ENOENT if there is no such capture, -EINVAL if
+  *          the capture is not valid
+  *
+  */
+ int monitor_archive_capture(const struct monitorArchive_t *archive, unsigned int n, struct monitorFile_t *file);
+
+
+ /*
+  * Monitor archive find function
+  *
+  * This function finds the capture in progress at a given host time (or the
+  * last one started before it) with a binary search, assuming captures were
+  * appended in time order.
+  *
+  * @archive : archive
+  * @host_ns : host time (CLOCK_REALTIME, ns)
+  *
+  * Return : capture number, -ENOENT if no capture started before @host_ns
+  *
+  */
+ int monitor_archive_find(const struct monitorArchive_t *archive, int64_t host_ns);
+
+
+ /*
+  * Monitor archive close function
+  *
+  * This function closes an archive.
+  *
+  * @archive : archive
+  *
+  */
+ void monitor_archive_close(struct monitorArchive_t *archive);
+
+
+ int monitor_dev_get_capture(monitor_t *monitor, struct monitorCapture_t *capture);
+
+
+ #endif /* _MONITOR_FILE_H_ */
@@ -12,19 +12,62 @@
 #include <stdint.h>
 #include <sys/types.h>
 #include <errno.h>
+#include <time.h>      // clock_gettime(), nanosleep()
 
+#include "monitor.h"
 #include "monitor_hw.h"
 #include "monitor_dbg.h"
 
+/*
+* Monitor register read function
+*
+* This function reads a Monitor register, from the register map or from the
+* simulated device (see monitor_sim.c). Register map accesses are volatile,
+* so that polling loops read the register every time.
+*
+* @reg : register offset (in 32-bit words)
+*
+* Return : register value
+*
+*/
+static inline uint32_t monitor_hw_read(struct monitor *monitor, unsigned int reg) {
+
+    if (monitor->sim) {
+        return monitor_sim_read(monitor->sim, reg);
+    }
+    return ((volatile uint32_t *)monitor->hw)[reg];
+
+}
+
+/*
+* Monitor register write function
+*
+* This function writes a Monitor register, in the register map or in the
+* simulated device (see monitor_sim.c).
+*
+* @reg   : register offset (in 32-bit words)
+* @value : value to be written
+*
+*/
+static inline void monitor_hw_write(struct monitor *monitor, unsigned int reg, uint32_t value) {
+
+    if (monitor->sim) {
+        monitor_sim_write(monitor->sim, reg, value);
+        return;
+    }
+    ((volatile uint32_t *)monitor->hw)[reg] = value;
+
+}
+
 /*
 * Monitor normal voltage reference configuration function
 *
 * This function sets the monitor ADC voltage reference to 2.5V.
 *
 */
-void monitor_hw_config_vref() {
+void monitor_hw_config_vref(struct monitor *monitor) {
 
-    monitor_hw[MONITOR_REG0] = MONITOR_CONFIG_VREF;
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_CONFIG_VREF);
     monitor_print_debug("[monitor-hw] set ADC reference voltage to 2.5V\n");
 
 }
@@ -35,25 +78,88 @@ void monitor_hw_config_vref() {
 * This function sets the monitor ADC voltage reference to 5V.
 *
 */
-void monitor_hw_config_2vref() {
+void monitor_hw_config_2vref(struct monitor *monitor) {
 
-    monitor_hw[MONITOR_REG0] = MONITOR_CONFIG_2VREF;
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_CONFIG_2VREF);
     monitor_print_debug("[monitor-hw] set ADC reference voltage to 5V\n");
 
 }
 
+/*
+* Monitor wait idle function
+*
+* This function waits for the monitor to become idle (e.g., while the
+* memory banks are being cleared or the ADC is being configured). The busy
+* flag is polled for up to MONITOR_IDLE_SPIN_TIME ns first, which covers
+* the clear and ADC ready times without the latency of a sleep, and then
+* with an exponential backoff (sleeping between MONITOR_IDLE_DELAY_MIN and
+* MONITOR_IDLE_DELAY_MAX ns), so that long waits do not keep a core
+* spinning on uncached reads.
+*
+* @timeout : maximum time to wait in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor is still busy
+*
+*/
+int monitor_hw_wait_idle(struct monitor *monitor, int timeout) {
+    struct timespec now, deadline, spin;
+    struct timespec delay = { .tv_sec = 0, .tv_nsec = MONITOR_IDLE_DELAY_MIN };
+
+    // Fast path: the monitor is (or is about to be) idle
+    if ((monitor_hw_read(monitor, MONITOR_REG0) & MONITOR_BUSY) == 0) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &spin);
+    do {
+        if ((monitor_hw_read(monitor, MONITOR_REG0) & MONITOR_BUSY) == 0) {
+            return 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while ((now.tv_sec - spin.tv_sec) * 1000000000L + (now.tv_nsec - spin.tv_nsec) < MONITOR_IDLE_SPIN_TIME);
+
+    deadline = spin;
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (timeout % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    // Slow path: bounded exponential backoff
+    while ((monitor_hw_read(monitor, MONITOR_REG0) & MONITOR_BUSY) > 0) {
+        if (timeout >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if ((now.tv_sec > deadline.tv_sec) || ((now.tv_sec == deadline.tv_sec) && (now.tv_nsec >= deadline.tv_nsec))) {
+                return -ETIMEDOUT;
+            }
+        }
+        nanosleep(&delay, NULL);
+        delay.tv_nsec = (delay.tv_nsec * 2 > MONITOR_IDLE_DELAY_MAX) ? MONITOR_IDLE_DELAY_MAX : delay.tv_nsec * 2;
+    }
+
+    return 0;
+}
+
 /*
 * Monitor start function
 *
-* This function starts the monitor acquisition.
+* This function waits for the monitor to be idle and starts the monitor acquisition.
+*
+* @timeout : maximum time to wait for the monitor to be idle in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
 *
 */
-void monitor_hw_start() {
+int monitor_hw_start(struct monitor *monitor, int timeout) {
 
-    while((monitor_hw[MONITOR_REG0] & MONITOR_BUSY) > 0);
-    monitor_hw[MONITOR_REG0] = MONITOR_START;
+    if (monitor_hw_wait_idle(monitor, timeout)) {
+        monitor_print_error("[monitor-hw] monitor still busy after %d ms, acquisition not started\n", timeout);
+        return -ETIMEDOUT;
+    }
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_START);
     monitor_print_debug("[monitor-hw] start to monitor power consumption and traces\n");
 
+    return 0;
 }
 
 /*
@@ -62,9 +168,9 @@ void monitor_hw_start() {
 * This function cleans the monitor memory banks.
 *
 */
-void monitor_hw_clean() {
+void monitor_hw_clean(struct monitor *monitor) {
 
-    monitor_hw[MONITOR_REG0] = MONITOR_STOP;
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_STOP);
     monitor_print_debug("[monitor-hw] clean brams\n");
 
 }
@@ -75,9 +181,9 @@ void monitor_hw_clean() {
 * This function stop the monitor acquisition. (only makes sense when power monitoring disabled)
 *
 */
-void monitor_hw_stop() {
+void monitor_hw_stop(struct monitor *monitor) {
 
-    monitor_hw[MONITOR_REG0] = MONITOR_STOP;
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_STOP);
     monitor_print_debug("[monitor-hw] stop acquisition\n");
 
 }
@@ -90,9 +196,9 @@ void monitor_hw_stop() {
 * This function sets a mask used to decide which signals trigger the monitor execution.
 *
 */
-void monitor_hw_set_mask(int mask) {
+void monitor_hw_set_mask(struct monitor *monitor, int mask) {
 
-    monitor_hw[MONITOR_REG3] = mask;
+    monitor_hw_write(monitor, MONITOR_REG3, mask);
     monitor_print_debug("[monitor-hw] set trigger mask to %d\n", mask);
 
 }
@@ -105,10 +211,10 @@ void monitor_hw_set_mask(int mask) {
 * This function sets a mask used to decide which AXI communication triggers the monitor execution.
 *
 */
-void monitor_hw_set_axi_mask(int mask) {
+void monitor_hw_set_axi_mask(struct monitor *monitor, int mask) {
 
-    monitor_hw[MONITOR_REG2] = mask;
-    monitor_hw[MONITOR_REG0] = MONITOR_AXI_SNIFFER_ENABLE_IN;
+    monitor_hw_write(monitor, MONITOR_REG2, mask);
+    monitor_hw_write(monitor, MONITOR_REG0, MONITOR_AXI_SNIFFER_ENABLE_IN);
     monitor_print_debug("[monitor-hw] set AXI trigger mask to %d\n", mask);
 
 }
@@ -121,9 +227,9 @@ void monitor_hw_set_axi_mask(int mask) {
 * Return : Elapsed cycles
 *
 */
-int monitor_hw_get_time() {
+int monitor_hw_get_time(struct monitor *monitor) {
 
-    return monitor_hw[MONITOR_REG1];
+    return monitor_hw_read(monitor, MONITOR_REG1);
 
 }
 
@@ -135,14 +241,10 @@ int monitor_hw_get_time() {
 * Return : Number of power consupmtion measurements
 *
 */
-int monitor_hw_get_number_power_measurements() {
+int monitor_hw_get_number_power_measurements(struct monitor *monitor) {
 
-    #ifdef AU250
-    return num_power_measurements;
-    #else
     // +1 because the register hold the last written address (which is 0-indexed)
-    return monitor_hw[MONITOR_REG2] + 1;
-    #endif
+    return monitor_hw_read(monitor, MONITOR_REG2) + 1;
 
 }
 
@@ -154,10 +256,10 @@ int monitor_hw_get_number_power_measurements() {
 * Return : Number of probes events
 *
 */
-int monitor_hw_get_number_traces_measurements() {
+int monitor_hw_get_number_traces_measurements(struct monitor *monitor) {
 
     // +1 because the register hold the last written address (which is 0-indexed)
-    return monitor_hw[MONITOR_REG3] + 1;
+    return monitor_hw_read(monitor, MONITOR_REG3) + 1;
 
 }
 
@@ -169,9 +271,9 @@ int monitor_hw_get_number_traces_measurements() {
 * Return : True -> Sampling finished, False -> Sampling in process
 *
 */
-int monitor_hw_isdone() {
+int monitor_hw_isdone(struct monitor *monitor) {
 
-    return ((monitor_hw[MONITOR_REG0] & MONITOR_DONE) > 0);
+    return ((monitor_hw_read(monitor, MONITOR_REG0) & MONITOR_DONE) > 0);
 
 }
 
@@ -183,9 +285,9 @@ int monitor_hw_isdone() {
 * Return : True -> Busy, False -> Idle
 *
 */
-int monitor_hw_isbusy() {
+int monitor_hw_isbusy(struct monitor *monitor) {
 
-    return ((monitor_hw[MONITOR_REG0] & MONITOR_BUSY) > 0);
+    return ((monitor_hw_read(monitor, MONITOR_REG0) & MONITOR_BUSY) > 0);
 
 }
 
@@ -197,8 +299,30 @@ int monitor_hw_isbusy() {
 * Return : Number of errors
 *
 */
-int monitor_hw_get_number_power_erros(){
+int monitor_hw_get_number_power_erros(struct monitor *monitor){
+
+    return (monitor_hw_read(monitor, MONITOR_REG0) >> MONITOR_POWER_ERRORS_OFFSET);
 
-    return (monitor_hw[MONITOR_REG0] >> MONITOR_POWER_ERRORS_OFFSET);
+}
+
+/*
+* Monitor get status function
+*
+* This function reads REG0-REG3 once each and decodes them.
+*
+* @status : status to be filled
+*
+*/
+void monitor_hw_get_status(struct monitor *monitor, struct monitorStatus_t *status) {
+    uint32_t reg0 = monitor_hw_read(monitor, MONITOR_REG0);
+
+    status->busy = (reg0 & MONITOR_BUSY) > 0;
+    status->done = (reg0 & MONITOR_DONE) > 0;
+    status->axi_sniffer = (reg0 & MONITOR_AXI_SNIFFER_ENABLE_OUT) > 0;
+    status->power_errors = reg0 >> MONITOR_POWER_ERRORS_OFFSET;
+    status->elapsed = monitor_hw_read(monitor, MONITOR_REG1);
+    // +1 because the registers hold the last written address (which is 0-indexed)
+    status->power_samples = monitor_hw_read(monitor, MONITOR_REG2) + 1;
+    status->traces_samples = monitor_hw_read(monitor, MONITOR_REG3) + 1;
 
 }
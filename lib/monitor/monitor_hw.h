@@ -12,16 +12,21 @@
 #ifndef _MONITOR_HW_H_
 #define _MONITOR_HW_H_
 
-extern uint32_t *monitor_hw;
-#ifdef AU250
-extern int num_power_measurements;
-#endif
+#include <stdint.h>    // uint32_t
+#include <stddef.h>    // size_t
+#include <pthread.h>   // pthread_t, pthread_mutex_t
+#include <time.h>      // struct timespec
+
+#include "monitor.h"           // enum monitorregtype_t
+#include "monitor_latency.h"   // enum monitorStage_t
 
 #ifdef AU250
 // Alveo U250 devices
+#define MONITOR_DEFAULT_DEVICE "/dev/xdma0_user"
 #define MONITOR_TRACES_ADDR (0x80100000)
 #else
 // Zynq Ultrascale+ devices & Zynq-7000 devices
+#define MONITOR_DEFAULT_DEVICE "/dev/monitor"
 #define MONITOR_POWER_ADDR  (0xb0100000)
 #define MONITOR_TRACES_ADDR (0xb0180000)
 
@@ -50,6 +55,14 @@ extern int num_power_measurements;
 #define MONITOR_AXI_SNIFFER_ENABLE_OUT  0x04    // Out
 #define MONITOR_POWER_ERRORS_OFFSET     0x03    // Offset
 
+/*
+* Monitor idle wait parameters (see monitor_hw_wait_idle())
+*
+*/
+#define MONITOR_IDLE_SPIN_TIME  (20000)     // Polling time before backing off (ns)
+#define MONITOR_IDLE_DELAY_MIN  (1000)      // First backoff sleep (ns)
+#define MONITOR_IDLE_DELAY_MAX  (100000)    // Maximum backoff sleep (ns)
+
 
 struct monitorRegion_t {
     char *name;
@@ -57,18 +70,98 @@ struct monitorRegion_t {
     void *data;
 };
 
+struct monitorSim_t;
+struct monitorLatency_t;
+
 struct monitorData_t {
     struct monitorRegion_t *power;
     struct monitorRegion_t *traces;
 };
 
+struct monitorStaging_t {
+    void *mem;
+    size_t size;
+    int viewed;
+};
+
+struct monitorTransfer_t {
+    int fd;
+    int pending;
+    unsigned int power_ndata;
+    unsigned int traces_ndata;
+    uint64_t t_submit;
+};
+
+/*
+* Monitor instance (opaque monitor_t in the public API)
+*
+* @fd             : Monitor device file descriptor (used to access kernels)
+* @hw             : user-space map of Monitor hardware registers
+* @data           : structure containing memory banks information
+* @staging_power  : persistent DMA buffer used to drain the power memory bank
+* @staging_traces : persistent DMA buffer used to drain the traces memory bank
+* @transfer       : DMA transfer in flight (asynchronous reads)
+* @sim            : simulated device (NULL for the hardware, see monitor_sim.c)
+* @latency        : readout stage timing (NULL while disabled, see monitor_latency.c)
+*
+* @ctrl_lock : serializes register command sequences (capture control)
+* @dma_lock  : protects @transfer and the staging buffers (readout)
+* @data_lock : protects @data and the regions it points to (buffer management)
+*
+* @clock_hz : Monitor clock frequency (used to extend the elapsed cycles)
+* @vref_mv  : ADC voltage reference last configured (ctrl_lock)
+* @t_start  : host time of the last monitor start (ctrl_lock)
+* @t_done   : host time at which the last acquisition was seen done (ctrl_lock)
+* @done     : @t_done is valid for the last acquisition (ctrl_lock)
+*
+* Locks are always taken in ctrl_lock -> dma_lock -> data_lock order.
+*
+* Alveo U250 devices only:
+* @c2h              : XDMA card-to-host device file name
+* @c2h_fd           : XDMA card-to-host device file descriptor
+* @cms              : user-space map of CMS registers
+* @cms_thread       : CMS power sampling thread
+* @cms_flag         : CMS power sampling enabled
+* @num_power_measurements : number of power samples gathered from CMS (data_lock)
+*
+*/
+struct monitor {
+    int fd;
+    uint32_t *hw;
+    struct monitorData_t *data;
+    struct monitorStaging_t staging_power;
+    struct monitorStaging_t staging_traces;
+    struct monitorTransfer_t transfer;
+    struct monitorSim_t *sim;
+    struct monitorLatency_t *latency;
+    pthread_mutex_t ctrl_lock;
+    pthread_mutex_t dma_lock;
+    pthread_mutex_t data_lock;
+    unsigned long clock_hz;
+    unsigned int vref_mv;
+    struct timespec t_start;
+    struct timespec t_done;
+    int done;
+    #ifdef AU250
+    char *c2h;
+    int c2h_fd;
+    uint32_t *cms;
+    pthread_t cms_thread;
+    volatile int cms_flag;
+    int num_power_measurements;
+    #endif
+};
+
+struct monitorStatus_t;
+struct monitorSimConfig_t;
+
 /*
 * Monitor normal voltage reference configuration function
 *
 * This function sets the monitor ADC voltage reference to 2.5V.
 *
 */
-void monitor_hw_config_vref();
+void monitor_hw_config_vref(struct monitor *monitor);
 
 /*
 * Monitor double voltage reference configuration function
@@ -76,15 +169,33 @@ void monitor_hw_config_vref();
 * This function sets the monitor ADC voltage reference to 5V.
 *
 */
-void monitor_hw_config_2vref();
+void monitor_hw_config_2vref(struct monitor *monitor);
+
+/*
+* Monitor wait idle function
+*
+* This function waits for the monitor to become idle, polling the busy flag
+* for up to MONITOR_IDLE_SPIN_TIME ns and then sleeping with an exponential
+* backoff.
+*
+* @timeout : maximum time to wait in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor is still busy
+*
+*/
+int monitor_hw_wait_idle(struct monitor *monitor, int timeout);
 
 /*
 * Monitor start function
 *
-* This function starts the monitor acquisition.
+* This function waits for the monitor to be idle and starts the monitor acquisition.
+*
+* @timeout : maximum time to wait for the monitor to be idle in milliseconds (-1 to wait forever)
+*
+* Return : 0 on success, -ETIMEDOUT if the monitor never became idle
 *
 */
-void monitor_hw_start();
+int monitor_hw_start(struct monitor *monitor, int timeout);
 
 /*
 * Monitor clean function
@@ -92,7 +203,7 @@ void monitor_hw_start();
 * This function cleans the monitor memory banks.
 *
 */
-void monitor_hw_clean();
+void monitor_hw_clean(struct monitor *monitor);
 
 /*
 * Monitor stop function
@@ -100,7 +211,7 @@ void monitor_hw_clean();
 * This function stop the monitor acquisition. (only makes sense when power monitoring disabled)
 *
 */
-void monitor_hw_stop();
+void monitor_hw_stop(struct monitor *monitor);
 
 /*
 * Monitor set mask function
@@ -110,7 +221,7 @@ void monitor_hw_stop();
 * This function sets a mask used to decide which signals trigger the monitor execution.
 *
 */
-void monitor_hw_set_mask(int mask);
+void monitor_hw_set_mask(struct monitor *monitor, int mask);
 
 /*
 * Monitor set AXI mask function
@@ -120,7 +231,7 @@ void monitor_hw_set_mask(int mask);
 * This function sets a mask used to decide which AXI communication triggers the monitor execution.
 *
 */
-void monitor_hw_set_axi_mask(int mask);
+void monitor_hw_set_axi_mask(struct monitor *monitor, int mask);
 
 /*
 * Monitor get acquisition time function
@@ -130,7 +241,7 @@ void monitor_hw_set_axi_mask(int mask);
 * Return : Elapsed cycles
 *
 */
-int monitor_hw_get_time();
+int monitor_hw_get_time(struct monitor *monitor);
 
 /*
 * Monitor get power measurements function
@@ -140,7 +251,7 @@ int monitor_hw_get_time();
 * Return : Number of power consupmtion measurements
 *
 */
-int monitor_hw_get_number_power_measurements();
+int monitor_hw_get_number_power_measurements(struct monitor *monitor);
 
 /*
 * Monitor get traces measurements function
@@ -150,7 +261,7 @@ int monitor_hw_get_number_power_measurements();
 * Return : Number of probes events
 *
 */
-int monitor_hw_get_number_traces_measurements();
+int monitor_hw_get_number_traces_measurements(struct monitor *monitor);
 
 /*
 * Monitor get acquisition time function
@@ -160,7 +271,7 @@ int monitor_hw_get_number_traces_measurements();
 * Return : Elapsed cycles
 *
 */
-int monitor_hw_isdone();
+int monitor_hw_isdone(struct monitor *monitor);
 
 /*
 * Monitor check busy function
@@ -170,7 +281,7 @@ int monitor_hw_isdone();
 * Return : True -> Busy, False -> Idle
 *
 */
-int monitor_hw_isbusy();
+int monitor_hw_isbusy(struct monitor *monitor);
 
 /*
 * Monitor get number of power measurement failed
@@ -180,6 +291,44 @@ int monitor_hw_isbusy();
 * Return : Number of errors
 *
 */
-int monitor_hw_get_number_power_erros();
+int monitor_hw_get_number_power_erros(struct monitor *monitor);
+
+/*
+* Monitor get status function
+*
+* This function reads REG0-REG3 once each and decodes them.
+*
+* @status : status to be filled
+*
+*/
+void monitor_hw_get_status(struct monitor *monitor, struct monitorStatus_t *status);
+
+/*
+* Monitor simulated device functions (see monitor_sim.c)
+*
+* The simulated device stands for the register map, the done interrupt and
+* the DMA engine of a Monitor instance whose @sim is set.
+*
+*/
+struct monitorSim_t *monitor_sim_create(const struct monitorSimConfig_t *config);
+void monitor_sim_destroy(struct monitorSim_t *sim);
+uint32_t *monitor_sim_regs(struct monitorSim_t *sim);
+uint32_t monitor_sim_read(struct monitorSim_t *sim, unsigned int reg);
+void monitor_sim_write(struct monitorSim_t *sim, unsigned int reg, uint32_t value);
+void monitor_sim_wait(struct monitorSim_t *sim);
+int monitor_sim_dma(struct monitorSim_t *sim, enum monitorregtype_t regtype, void *dst, size_t size);
+
+/*
+* Monitor latency instrumentation functions (see monitor_latency.c)
+*
+* Every timestamp of a timed stage is guarded by a check of @latency, so a
+* disabled instrumentation costs one predictable (never taken) branch per
+* timestamp and no clock reads.
+*
+*/
+struct monitorLatency_t *monitor_latency_create(unsigned int records);
+void monitor_latency_destroy(struct monitorLatency_t *latency);
+void monitor_latency_capture(struct monitorLatency_t *latency);
+void monitor_latency_stage(struct monitorLatency_t *latency, enum monitorStage_t stage, uint64_t t_begin);
 
 #endif /* _MONITOR_HW_H_ */
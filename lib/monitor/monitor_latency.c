@@ -0,0 +1,463 @@
+/*
+ * Monitor latency instrumentation API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor latency instrumentation API,
+*               which timestamps every stage of a capture readout (IRQ wait,
+*               DMA setup, DMA completion, staging buffer copy and file
+*               writes) and keeps per-capture records and per-stage
+*               counters and histograms.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <pthread.h>   // pthread_mutex_lock()
+
+#include "monitor.h"
+#include "monitor_hw.h"
+#include "monitor_latency.h"
+#include "monitor_dbg.h"
+
+/*
+* Monitor latency instrumentation
+*
+* The per-capture records are a ring: the record of capture n is
+* records[n % size], and it is the current one until the next monitor start.
+*
+* @lock     : protects everything below
+* @records  : per-capture records
+* @size     : number of records
+* @captures : number of captures started
+* @stats    : statistics of every stage
+*
+*/
+struct monitorLatency_t {
+    pthread_mutex_t lock;
+    struct monitorLatencyRecord_t *records;
+    unsigned int size;
+    unsigned int captures;
+    struct monitorStageStats_t stats[MONITOR_STAGES];
+};
+
+/*
+* Monitor latency time function
+*
+* Return : CLOCK_MONOTONIC_RAW time in ns
+*
+*/
+uint64_t monitor_latency_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+* Monitor latency record function
+*
+* This function starts the record of a new capture (latency->lock must be held).
+*
+*/
+static void monitor_latency_record(struct monitorLatency_t *latency, uint64_t now) {
+    struct monitorLatencyRecord_t *record = &latency->records[latency->captures % latency->size];
+
+    memset(record, 0, sizeof *record);
+    record->capture = latency->captures++;
+    record->t_start = now;
+
+}
+
+/*
+* Monitor latency create function
+*
+* This function creates the latency instrumentation of a Monitor instance.
+*
+* @records : number of per-capture records kept
+*
+* Return : latency instrumentation on success, NULL otherwise
+*
+*/
+struct monitorLatency_t *monitor_latency_create(unsigned int records) {
+    struct monitorLatency_t *latency;
+    unsigned int i;
+
+    latency = calloc(1, sizeof *latency);
+    if (!latency) {
+        return NULL;
+    }
+    latency->records = calloc(records, sizeof *latency->records);
+    if (!latency->records) {
+        free(latency);
+        return NULL;
+    }
+    latency->size = records;
+    for (i = 0; i < MONITOR_STAGES; i++) {
+        latency->stats[i].min = UINT64_MAX;
+    }
+    pthread_mutex_init(&latency->lock, NULL);
+
+    return latency;
+}
+
+/*
+* Monitor latency destroy function
+*
+* This function releases the latency instrumentation of a Monitor instance.
+*
+* @latency : latency instrumentation
+*
+*/
+void monitor_latency_destroy(struct monitorLatency_t *latency) {
+
+    if (!latency) {
+        return;
+    }
+    pthread_mutex_destroy(&latency->lock);
+    free(latency->records);
+    free(latency);
+
+}
+
+/*
+* Monitor latency capture function
+*
+* This function starts the record of a new capture (called on every
+* monitor start).
+*
+* @latency : latency instrumentation
+*
+*/
+void monitor_latency_capture(struct monitorLatency_t *latency) {
+    uint64_t now = monitor_latency_now();
+
+    pthread_mutex_lock(&latency->lock);
+    monitor_latency_record(latency, now);
+    pthread_mutex_unlock(&latency->lock);
+
+}
+
+/*
+* Monitor latency stage function
+*
+* This function adds the time elapsed since @t_begin to a stage of the
+* current capture, and to the statistics of the stage.
+*
+* @latency : latency instrumentation
+* @stage   : stage
+* @t_begin : beginning of the stage (see monitor_latency_now())
+*
+*/
+void monitor_latency_stage(struct monitorLatency_t *latency, enum monitorStage_t stage, uint64_t t_begin) {
+    uint64_t now = monitor_latency_now(), ns = now - t_begin;
+    struct monitorStageStats_t *stats = &latency->stats[stage];
+    unsigned int bucket;
+
+    bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+
+    pthread_mutex_lock(&latency->lock);
+    // Stages timed before the first monitor start belong to capture 0
+    if (latency->captures == 0) {
+        monitor_latency_record(latency, t_begin);
+    }
+    latency->records[(latency->captures - 1) % latency->size].stage[stage] += ns;
+
+    stats->count++;
+    stats->sum += ns;
+    if (ns < stats->min) {
+        stats->min = ns;
+    }
+    if (ns > stats->max) {
+        stats->max = ns;
+    }
+    stats->histogram[bucket < MONITOR_LATENCY_BUCKETS ? bucket : MONITOR_LATENCY_BUCKETS - 1]++;
+    pthread_mutex_unlock(&latency->lock);
+
+}
+
+/*
+* Monitor latency enable function
+*
+* This function starts timing the readout stages of a Monitor instance (it
+* does nothing if they are already timed). The instrumentation is swapped
+* in with both monitor->ctrl_lock and monitor->dma_lock held, so that no
+* stage is being timed meanwhile.
+*
+* @monitor : Monitor instance
+* @records : number of per-capture records kept (0 for MONITOR_LATENCY_RECORDS)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_dev_latency_enable(monitor_t *monitor, unsigned int records) {
+    struct monitorLatency_t *latency;
+
+    latency = monitor_latency_create(records ? records : MONITOR_LATENCY_RECORDS);
+    if (!latency) {
+        monitor_print_error("[monitor-latency] malloc() failed\n");
+        return -ENOMEM;
+    }
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    pthread_mutex_lock(&monitor->dma_lock);
+    if (!monitor->latency) {
+        monitor->latency = latency;
+        latency = NULL;
+    }
+    pthread_mutex_unlock(&monitor->dma_lock);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    // Already enabled
+    if (latency) {
+        monitor_latency_destroy(latency);
+        return 0;
+    }
+    monitor_print_debug("[monitor-latency] enabled | records=%u\n", records ? records : MONITOR_LATENCY_RECORDS);
+
+    return 0;
+}
+
+/*
+* Monitor latency disable function
+*
+* This function stops timing the readout stages of a Monitor instance, and
+* drops its records and statistics. The instrumentation is swapped out with
+* both monitor->ctrl_lock and monitor->dma_lock held, so it is released once
+* no stage is being timed.
+*
+* @monitor : Monitor instance
+*
+*/
+void monitor_dev_latency_disable(monitor_t *monitor) {
+    struct monitorLatency_t *latency;
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    pthread_mutex_lock(&monitor->dma_lock);
+    latency = monitor->latency;
+    monitor->latency = NULL;
+    pthread_mutex_unlock(&monitor->dma_lock);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    monitor_latency_destroy(latency);
+
+}
+
+/*
+* Monitor latency begin function
+*
+* This function gets the beginning of a stage timed by the application
+* (see monitor_dev_latency_add()), without reading the clock while the
+* instrumentation is disabled.
+*
+* @monitor : Monitor instance
+*
+* Return : CLOCK_MONOTONIC_RAW time in ns, 0 if the instrumentation is disabled
+*
+*/
+uint64_t monitor_dev_latency_begin(monitor_t *monitor) {
+
+    return monitor->latency ? monitor_latency_now() : 0;
+
+}
+
+/*
+* Monitor latency add function
+*
+* This function adds the time elapsed since @t_begin to a stage of the
+* current capture of a Monitor instance (it does nothing if @t_begin is 0,
+* i.e., the instrumentation was disabled when the stage began).
+*
+* @monitor : Monitor instance
+* @stage   : stage
+* @t_begin : beginning of the stage (see monitor_dev_latency_begin())
+*
+*/
+void monitor_dev_latency_add(monitor_t *monitor, enum monitorStage_t stage, uint64_t t_begin) {
+
+    if (!t_begin || stage >= MONITOR_STAGES) {
+        return;
+    }
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    if (monitor->latency) {
+        monitor_latency_stage(monitor->latency, stage, t_begin);
+    }
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+}
+
+/*
+* Monitor latency statistics function
+*
+* This function gets the stage statistics of a Monitor instance.
+*
+* @monitor : Monitor instance
+* @stats   : statistics
+*
+* Return : 0 on success, -EINVAL if the instrumentation is disabled
+*
+*/
+int monitor_dev_latency_stats(monitor_t *monitor, struct monitorLatencyStats_t *stats) {
+    struct monitorLatency_t *latency;
+    unsigned int i;
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    latency = monitor->latency;
+    if (!latency) {
+        pthread_mutex_unlock(&monitor->ctrl_lock);
+        return -EINVAL;
+    }
+    pthread_mutex_lock(&latency->lock);
+    stats->captures = latency->captures;
+    stats->records = latency->captures < latency->size ? latency->captures : latency->size;
+    memcpy(stats->stage, latency->stats, sizeof stats->stage);
+    pthread_mutex_unlock(&latency->lock);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    // Stages that were never timed
+    for (i = 0; i < MONITOR_STAGES; i++) {
+        if (!stats->stage[i].count) {
+            stats->stage[i].min = 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+* Monitor latency records function
+*
+* This function gets the most recent per-capture records of a Monitor
+* instance, oldest first.
+*
+* @monitor : Monitor instance
+* @records : records to be filled
+* @count   : maximum number of records
+*
+* Return : number of records on success, -EINVAL if the instrumentation is disabled
+*
+*/
+int monitor_dev_latency_records(monitor_t *monitor, struct monitorLatencyRecord_t *records, unsigned int count) {
+    struct monitorLatency_t *latency;
+    unsigned int kept, first, i;
+
+    pthread_mutex_lock(&monitor->ctrl_lock);
+    latency = monitor->latency;
+    if (!latency) {
+        pthread_mutex_unlock(&monitor->ctrl_lock);
+        return -EINVAL;
+    }
+    pthread_mutex_lock(&latency->lock);
+    kept = latency->captures < latency->size ? latency->captures : latency->size;
+    if (count > kept) {
+        count = kept;
+    }
+    first = latency->captures - count;
+    for (i = 0; i < count; i++) {
+        records[i] = latency->records[(first + i) % latency->size];
+    }
+    pthread_mutex_unlock(&latency->lock);
+    pthread_mutex_unlock(&monitor->ctrl_lock);
+
+    return count;
+}
+
+/*
+* Monitor latency enable function
+*
+* This function starts timing the readout stages of the default Monitor
+* instance.
+*
+* @records : number of per-capture records kept (0 for MONITOR_LATENCY_RECORDS)
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_latency_enable(unsigned int records) {
+
+    return monitor_dev_latency_enable(monitor_get_default(), records);
+
+}
+
+/*
+* Monitor latency disable function
+*
+* This function stops timing the readout stages of the default Monitor
+* instance.
+*
+*/
+void monitor_latency_disable() {
+
+    monitor_dev_latency_disable(monitor_get_default());
+
+}
+
+/*
+* Monitor latency begin function
+*
+* This function gets the beginning of a stage timed by the application for
+* the default Monitor instance.
+*
+* Return : CLOCK_MONOTONIC_RAW time in ns, 0 if the instrumentation is disabled
+*
+*/
+uint64_t monitor_latency_begin() {
+
+    return monitor_dev_latency_begin(monitor_get_default());
+
+}
+
+/*
+* Monitor latency add function
+*
+* This function adds the time elapsed since @t_begin to a stage of the
+* current capture of the default Monitor instance.
+*
+* @stage   : stage
+* @t_begin : beginning of the stage (see monitor_latency_begin())
+*
+*/
+void monitor_latency_add(enum monitorStage_t stage, uint64_t t_begin) {
+
+    monitor_dev_latency_add(monitor_get_default(), stage, t_begin);
+
+}
+
+/*
+* Monitor latency statistics function
+*
+* This function gets the stage statistics of the default Monitor instance.
+*
+* @stats : statistics
+*
+* Return : 0 on success, -EINVAL if the instrumentation is disabled
+*
+*/
+int monitor_latency_stats(struct monitorLatencyStats_t *stats) {
+
+    return monitor_dev_latency_stats(monitor_get_default(), stats);
+
+}
+
+/*
+* Monitor latency records function
+*
+* This function gets the most recent per-capture records of the default
+* Monitor instance, oldest first.
+*
+* @records : records to be filled
+* @count   : maximum number of records
+*
+* Return : number of records on success, -EINVAL if the instrumentation is disabled
+*
+*/
+int monitor_latency_records(struct monitorLatencyRecord_t *records, unsigned int count) {
+
+    return monitor_dev_latency_records(monitor_get_default(), records, count);
+
+}
@@ -0,0 +1,218 @@
+/*
+ * Monitor latency instrumentation API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor latency instrumentation API,
+ *               which timestamps every stage of a capture readout (IRQ wait,
+ *               DMA setup, DMA completion, staging buffer copy and file
+ *               writes) and keeps per-capture records and per-stage
+ *               counters and histograms.
+ *
+ */
+
+
+ #ifndef _MONITOR_LATENCY_H_
+ #define _MONITOR_LATENCY_H_
+
+ #include <stdint.h> // uint64_t
+
+ #include "monitor.h"
+
+
+ /*
+  * Default number of per-capture records kept (the oldest ones are
+  * overwritten)
+  *
+  */
+ #define MONITOR_LATENCY_RECORDS (256)
+
+
+ /*
+  * Number of buckets of the stage latency histograms (bucket b counts
+  * latencies in [2^b, 2^(b+1)) ns, the last one also counts the longer ones)
+  *
+  */
+ #define MONITOR_LATENCY_BUCKETS (32)
+
+
+ /*
+  * MONITOR readout stage type
+  *
+  * MONITOR_STAGE_IRQ       - waiting for the done interrupt (monitor_wait())
+  * MONITOR_STAGE_DMA_SETUP - preparing the staging buffers and starting the DMA transfer
+  * MONITOR_STAGE_DMA_WAIT  - waiting for the DMA transfer to complete
+  * MONITOR_STAGE_COPY      - copying staging buffers into monitor_alloc() regions
+  * MONITOR_STAGE_WRITE     - writing captures to files (see monitor_latency_add())
+  *
+  */
+ enum monitorStage_t {MONITOR_STAGE_IRQ, MONITOR_STAGE_DMA_SETUP, MONITOR_STAGE_DMA_WAIT, MONITOR_STAGE_COPY, MONITOR_STAGE_WRITE, MONITOR_STAGES};
+
+
+ /*
+  * MONITOR latency record type
+  *
+  * Time spent in every stage during one capture (from a monitor start to
+  * the next one). All times are in ns (CLOCK_MONOTONIC_RAW).
+  *
+  * @capture : capture number (0 is the first capture since enabled)
+  * @t_start : time of the monitor start
+  * @stage   : time spent in every stage
+  *
+  */
+ struct monitorLatencyRecord_t {
+     unsigned int capture;
+     uint64_t t_start;
+     uint64_t stage[MONITOR_STAGES];
+ };
+
+
+ /*
+  * MONITOR stage statistics type
+  *
+  * All times are in ns (CLOCK_MONOTONIC_RAW).
+  *
+  * @count     : number of times the stage was timed
+  * @sum       : total time
+  * @min       : minimum time
+  * @max       : maximum time
+  * @histogram : latency histogram (log2 buckets)
+  *
+  */
+ struct monitorStageStats_t {
+     uint64_t count;
+     uint64_t sum;
+     uint64_t min;
+     uint64_t max;
+     uint64_t histogram[MONITOR_LATENCY_BUCKETS];
+ };
+
+
+ /*
+  * MONITOR latency statistics type
+  *
+  * @captures : number of captures since enabled
+  * @records  : number of per-capture records kept
+  * @stage    : statistics of every stage
+  *
+  */
+ struct monitorLatencyStats_t {
+     unsigned int captures;
+     unsigned int records;
+     struct monitorStageStats_t stage[MONITOR_STAGES];
+ };
+
+
+ /*
+  * Monitor latency time function
+  *
+  * Return : CLOCK_MONOTONIC_RAW time in ns (the time base of every stage)
+  *
+  */
+ uint64_t monitor_latency_now();
+
+
+ /*
+  * Monitor latency enable function
+  *
+  * This function starts timing the readout stages of the default Monitor
+  * instance (see monitor_dev_latency_enable()).
+  *
+  * @records : number of per-capture records kept (0 for MONITOR_LATENCY_RECORDS)
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_latency_enable(unsigned int records);
+
+
+ /*
+  * Monitor latency disable function
+  *
+  * This function stops timing the readout stages of the default Monitor
+  * instance, and drops its records and statistics.
+  *
+  */
+ void monitor_latency_disable();
+
+
+ /*
+  * Monitor latency begin function
+  *
+  * This function gets the beginning of a stage timed by the application
+  * (see monitor_latency_add()). It does not read the clock while the
+  * instrumentation is disabled.
+  *
+  * Return : CLOCK_MONOTONIC_RAW time in ns, 0 if the instrumentation is disabled
+  *
+  */
+ uint64_t monitor_latency_begin();
+
+
+ /*
+  * Monitor latency add function
+  *
+  * This function adds the time elapsed since @t_begin to a stage of the
+  * current capture of the default Monitor instance, for the stages that
+  * run in the application (e.g., writing CON.BIN and SIG.BIN):
+  *
+  *     uint64_t t_begin = monitor_latency_begin();
+  *     write(fd_power, power, sizeof(monitorpdata_t) * number_power_samples);
+  *     monitor_latency_add(MONITOR_STAGE_WRITE, t_begin);
+  *
+  * It does nothing if @t_begin is 0 or the instrumentation is disabled.
+  *
+  * @stage   : stage
+  * @t_begin : beginning of the stage (see monitor_latency_begin())
+  *
+  */
+ void monitor_latency_add(enum monitorStage_t stage, uint64_t t_begin);
+
+
+ /*
+  * Monitor latency statistics function
+  *
+  * This function gets the stage statistics of the default Monitor instance.
+  *
+  * @stats : statistics
+  *
+  * Return : 0 on success, -EINVAL if the instrumentation is disabled
+  *
+  */
+ int monitor_latency_stats(struct monitorLatencyStats_t *stats);
+
+
+ /*
+  * Monitor latency records function
+  *
+  * This function gets the most recent per-capture records of the default
+  * Monitor instance, oldest first (the last one is the current capture).
+  *
+  * @records : records to be filled
+  * @count   : maximum number of records
+  *
+  * Return : number of records on success, -EINVAL if the instrumentation is disabled
+  *
+  */
+ int monitor_latency_records(struct monitorLatencyRecord_t *records, unsigned int count);
+
+
+ /*
+  * MULTI-INSTANCE API (see monitor.h)
+  *
+  * The instrumentation of a Monitor instance is disabled when it is opened.
+  * While it is disabled, every timed stage costs a single (predictable)
+  * branch. Everything can be called from any thread: the stages that are
+  * in progress when the instrumentation is enabled are not timed, and it
+  * is only released once no stage is being timed.
+  *
+  */
+
+ int monitor_dev_latency_enable(monitor_t *monitor, unsigned int records);
+ void monitor_dev_latency_disable(monitor_t *monitor);
+ uint64_t monitor_dev_latency_begin(monitor_t *monitor);
+ void monitor_dev_latency_add(monitor_t *monitor, enum monitorStage_t stage, uint64_t t_begin);
+ int monitor_dev_latency_stats(monitor_t *monitor, struct monitorLatencyStats_t *stats);
+ int monitor_dev_latency_records(monitor_t *monitor, struct monitorLatencyRecord_t *records, unsigned int count);
+
+
+ #endif /* _MONITOR_LATENCY_H_ */
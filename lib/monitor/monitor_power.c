@@ -0,0 +1,965 @@
+/*
+ * Monitor power API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor power API, which converts
+*               the raw ADC codes drained from the power memory bank into
+*               calibrated power values.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MONITOR_POWER_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MONITOR_POWER_X86
+#endif
+
+#include "monitor.h"
+#include "monitor_power.h"
+#include "monitor_dbg.h"
+
+#define MONITOR_POWER_MAX_SHIFT (24)
+
+/*
+* Monitor calibration update function
+*
+* This function computes the fixed-point conversion factors of a calibration,
+* using as many fractional bits as possible while code * factor (plus the
+* rounding term) still fits in 32 bits.
+*
+* @cal : calibration
+*
+* Return : 0 on success, -EINVAL on invalid parameters, -ERANGE if the
+*          conversion does not fit in 32 bits
+*
+*/
+int monitor_calibration_update(struct monitorCalibration_t *cal) {
+    double mw[2], max;
+    unsigned int channels = cal->dual ? 2 : 1;
+    unsigned int c;
+    int shift;
+
+    if (!cal->vref_mv || cal->gain <= 0.0 || cal->vdd <= 0.0) {
+        return -EINVAL;
+    }
+
+    // mW per ADC code of each channel
+    for (c = 0; c < channels; c++) {
+        if (cal->shunt[c] <= 0.0) {
+            return -EINVAL;
+        }
+        mw[c] = cal->vdd * cal->vref_mv / ((double)(1U << MONITOR_ADC_BITS) * cal->gain * cal->shunt[c]);
+    }
+    if (!cal->dual) {
+        mw[1] = mw[0];
+    }
+    max = mw[0] > mw[1] ? mw[0] : mw[1];
+
+    for (shift = MONITOR_POWER_MAX_SHIFT; shift >= 0; shift--) {
+        if ((max * (1U << shift) + 0.5) * MONITOR_ADC_MASK + (1U << shift) / 2 < 4294967296.0) {
+            break;
+        }
+    }
+    if (shift < 0) {
+        return -ERANGE;
+    }
+
+    cal->shift = shift;
+    for (c = 0; c < 2; c++) {
+        cal->factor[c] = (uint32_t)(mw[c] * (1U << shift) + 0.5);
+    }
+
+    return 0;
+}
+
+/*
+* Monitor power convert function (scalar)
+*
+* This function converts raw power samples [@first, @ndata) to mW.
+*
+*/
+static void monitor_power_convert_scalar(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int first, unsigned int ndata, uint32_t *mw) {
+    const uint32_t round = (1U << cal->shift) >> 1;
+    unsigned int i;
+
+    for (i = first; i < ndata; i++) {
+        mw[i] = ((power[i] & MONITOR_ADC_MASK) * cal->factor[i & 1] + round) >> cal->shift;
+    }
+
+}
+
+#ifdef MONITOR_POWER_X86
+/*
+* Monitor power convert function (AVX2)
+*
+* This function converts 8 samples per iteration.
+*
+* Return : number of samples processed
+*
+*/
+__attribute__((target("avx2")))
+static unsigned int monitor_power_convert_avx2(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int ndata, uint32_t *mw) {
+    const __m256i mask = _mm256_set1_epi32(MONITOR_ADC_MASK);
+    const __m256i factor = _mm256_setr_epi32(cal->factor[0], cal->factor[1], cal->factor[0], cal->factor[1],
+                                             cal->factor[0], cal->factor[1], cal->factor[0], cal->factor[1]);
+    const __m256i round = _mm256_set1_epi32((1U << cal->shift) >> 1);
+    const __m128i shift = _mm_cvtsi32_si128(cal->shift);
+    __m256i v;
+    unsigned int i;
+
+    for (i = 0; i + 8 <= ndata; i += 8) {
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&power[i]), mask);
+        v = _mm256_add_epi32(_mm256_mullo_epi32(v, factor), round);
+        _mm256_storeu_si256((__m256i *)&mw[i], _mm256_srl_epi32(v, shift));
+    }
+
+    return i;
+}
+
+/*
+* Monitor power convert function (SSE2)
+*
+* This function converts 4 samples per iteration. SSE2 has no 32-bit
+* multiply, so even and odd lanes go through 32x32->64 multiplies (the
+* products fit in 32 bits, see monitor_calibration_update()).
+*
+* Return : number of samples processed
+*
+*/
+static unsigned int monitor_power_convert_sse2(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int ndata, uint32_t *mw) {
+    const __m128i mask = _mm_set1_epi32(MONITOR_ADC_MASK);
+    const __m128i factor_even = _mm_set1_epi32(cal->factor[0]);
+    const __m128i factor_odd = _mm_set1_epi32(cal->factor[1]);
+    const __m128i round = _mm_set1_epi32((1U << cal->shift) >> 1);
+    const __m128i shift = _mm_cvtsi32_si128(cal->shift);
+    __m128i v, even, odd;
+    unsigned int i;
+
+    for (i = 0; i + 4 <= ndata; i += 4) {
+        v = _mm_and_si128(_mm_loadu_si128((const __m128i *)&power[i]), mask);
+        even = _mm_mul_epu32(v, factor_even);
+        odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), factor_odd);
+        v = _mm_add_epi32(_mm_or_si128(even, _mm_slli_epi64(odd, 32)), round);
+        _mm_storeu_si128((__m128i *)&mw[i], _mm_srl_epi32(v, shift));
+    }
+
+    return i;
+}
+#endif
+
+#ifdef MONITOR_POWER_NEON
+/*
+* Monitor power convert function (NEON)
+*
+* This function converts 4 samples per iteration.
+*
+* Return : number of samples processed
+*
+*/
+static unsigned int monitor_power_convert_neon(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int ndata, uint32_t *mw) {
+    const uint32x4_t mask = vdupq_n_u32(MONITOR_ADC_MASK);
+    const uint32x2_t pair = vcreate_u32(((uint64_t)cal->factor[1] << 32) | cal->factor[0]);
+    const uint32x4_t factor = vcombine_u32(pair, pair);
+    const uint32x4_t round = vdupq_n_u32((1U << cal->shift) >> 1);
+    const int32x4_t shift = vdupq_n_s32(-(int32_t)cal->shift);
+    uint32x4_t v;
+    unsigned int i;
+
+    for (i = 0; i + 4 <= ndata; i += 4) {
+        v = vandq_u32(vld1q_u32(&power[i]), mask);
+        v = vmlaq_u32(round, v, factor);
+        vst1q_u32(&mw[i], vshlq_u32(v, shift));
+    }
+
+    return i;
+}
+#endif
+
+/*
+* Monitor power convert function
+*
+* This function converts raw power samples to mW with fixed-point arithmetic.
+*
+* @cal   : calibration
+* @power : raw power samples
+* @ndata : number of power samples
+* @mw    : power in mW (@ndata elements)
+*
+*/
+void monitor_power_convert(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int ndata, uint32_t *mw) {
+    unsigned int done = 0;
+
+    // Vector loops start at an even sample, so lane parity is sample parity
+    #if defined(MONITOR_POWER_NEON)
+    done = monitor_power_convert_neon(cal, power, ndata, mw);
+    #elif defined(MONITOR_POWER_X86)
+    if (__builtin_cpu_supports("avx2")) {
+        done = monitor_power_convert_avx2(cal, power, ndata, mw);
+    }
+    else {
+        done = monitor_power_convert_sse2(cal, power, ndata, mw);
+    }
+    #endif
+
+    // Remaining samples (and whole buffer without SIMD support)
+    monitor_power_convert_scalar(cal, power, done, ndata, mw);
+
+}
+
+/*
+* Monitor power pack group function (scalar)
+*
+* This function packs 8 samples into 12 bytes, as one 64-bit and one 32-bit
+* little-endian word.
+*
+*/
+static inline void monitor_power_pack_group(const monitorpdata_t *power, uint8_t *packed) {
+    uint64_t lo;
+    uint32_t hi;
+
+    lo = (uint64_t)(power[0] & MONITOR_ADC_MASK)         | (uint64_t)(power[1] & MONITOR_ADC_MASK) << 12 |
+         (uint64_t)(power[2] & MONITOR_ADC_MASK) << 24   | (uint64_t)(power[3] & MONITOR_ADC_MASK) << 36 |
+         (uint64_t)(power[4] & MONITOR_ADC_MASK) << 48   | (uint64_t)(power[5] & MONITOR_ADC_MASK) << 60;
+    hi = (power[5] & MONITOR_ADC_MASK) >> 4 | (power[6] & MONITOR_ADC_MASK) << 8 | (power[7] & MONITOR_ADC_MASK) << 20;
+
+    memcpy(packed, &lo, sizeof lo);
+    memcpy(packed + sizeof lo, &hi, sizeof hi);
+}
+
+/*
+* Monitor power unpack group function (scalar)
+*
+* This function unpacks 12 bytes into 8 samples.
+*
+*/
+static inline void monitor_power_unpack_group(const uint8_t *packed, monitorpdata_t *power) {
+    uint64_t lo;
+    uint32_t hi;
+
+    memcpy(&lo, packed, sizeof lo);
+    memcpy(&hi, packed + sizeof lo, sizeof hi);
+
+    power[0] = lo & MONITOR_ADC_MASK;
+    power[1] = (lo >> 12) & MONITOR_ADC_MASK;
+    power[2] = (lo >> 24) & MONITOR_ADC_MASK;
+    power[3] = (lo >> 36) & MONITOR_ADC_MASK;
+    power[4] = (lo >> 48) & MONITOR_ADC_MASK;
+    power[5] = ((lo >> 60) | (hi << 4)) & MONITOR_ADC_MASK;
+    power[6] = (hi >> 8) & MONITOR_ADC_MASK;
+    power[7] = hi >> 20;
+}
+
+#ifdef MONITOR_POWER_X86
+/*
+* Monitor power pack function (AVX2)
+*
+* This function packs 8 samples per iteration: pairs of codes are merged
+* into 24-bit values within each 64-bit lane, a byte shuffle gathers them
+* in the low 6 bytes of each half, and both halves are merged.
+*
+* Return : number of samples processed
+*
+*/
+__attribute__((target("avx2")))
+static unsigned int monitor_power_pack_avx2(const monitorpdata_t *power, unsigned int ndata, uint8_t *packed) {
+    const __m256i mask = _mm256_set1_epi32(MONITOR_ADC_MASK);
+    const __m256i gather = _mm256_setr_epi8(0, 1, 2, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            0, 1, 2, 8, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i v;
+    __m128i group;
+    uint32_t last;
+    unsigned int i;
+
+    for (i = 0; i + MONITOR_PACK_SAMPLES <= ndata; i += MONITOR_PACK_SAMPLES, packed += MONITOR_PACK_BYTES) {
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&power[i]), mask);
+        v = _mm256_shuffle_epi8(_mm256_or_si256(v, _mm256_srli_epi64(v, 20)), gather);
+        group = _mm_or_si128(_mm256_castsi256_si128(v), _mm_slli_si128(_mm256_extracti128_si256(v, 1), 6));
+        _mm_storel_epi64((__m128i *)packed, group);
+        last = _mm_cvtsi128_si32(_mm_srli_si128(group, 8));
+        memcpy(packed + 8, &last, sizeof last);
+    }
+
+    return i;
+}
+
+/*
+* Monitor power unpack function (AVX2)
+*
+* This function unpacks 8 samples per iteration: bytes 0-7 and 4-11 of the
+* group are loaded into each half, a byte shuffle moves every code into its
+* own lane, and odd codes are shifted down by 4 bits.
+*
+* Return : number of samples processed
+*
+*/
+__attribute__((target("avx2")))
+static unsigned int monitor_power_unpack_avx2(const uint8_t *packed, unsigned int ndata, monitorpdata_t *power) {
+    const __m256i mask = _mm256_set1_epi32(MONITOR_ADC_MASK);
+    const __m256i scatter = _mm256_setr_epi8(0, 1, -1, -1, 1, 2, -1, -1, 3, 4, -1, -1, 4, 5, -1, -1,
+                                             2, 3, -1, -1, 3, 4, -1, -1, 5, 6, -1, -1, 6, 7, -1, -1);
+    const __m256i shift = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+    __m256i v;
+    unsigned int i;
+
+    for (i = 0; i + MONITOR_PACK_SAMPLES <= ndata; i += MONITOR_PACK_SAMPLES, packed += MONITOR_PACK_BYTES) {
+        v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i *)packed)),
+                                    _mm_loadl_epi64((const __m128i *)(packed + 4)), 1);
+        v = _mm256_srlv_epi32(_mm256_shuffle_epi8(v, scatter), shift);
+        _mm256_storeu_si256((__m256i *)&power[i], _mm256_and_si256(v, mask));
+    }
+
+    return i;
+}
+#endif
+
+#ifdef MONITOR_POWER_NEON
+/*
+* Monitor power pack function (NEON)
+*
+* This function packs 16 samples per iteration: codes are narrowed to 16
+* bits and split into even and odd codes, which make up the three bytes of
+* every pair, stored interleaved.
+*
+* Return : number of samples processed
+*
+*/
+static unsigned int monitor_power_pack_neon(const monitorpdata_t *power, unsigned int ndata, uint8_t *packed) {
+    const uint16x8_t mask = vdupq_n_u16(MONITOR_ADC_MASK);
+    uint16x8_t lo, hi;
+    uint16x8x2_t pairs;
+    uint8x8x3_t bytes;
+    unsigned int i;
+
+    for (i = 0; i + 2 * MONITOR_PACK_SAMPLES <= ndata; i += 2 * MONITOR_PACK_SAMPLES, packed += 2 * MONITOR_PACK_BYTES) {
+        lo = vandq_u16(vcombine_u16(vmovn_u32(vld1q_u32(&power[i])), vmovn_u32(vld1q_u32(&power[i + 4]))), mask);
+        hi = vandq_u16(vcombine_u16(vmovn_u32(vld1q_u32(&power[i + 8])), vmovn_u32(vld1q_u32(&power[i + 12]))), mask);
+        pairs = vuzpq_u16(lo, hi);
+        bytes.val[0] = vmovn_u16(pairs.val[0]);
+        bytes.val[1] = vmovn_u16(vorrq_u16(vshrq_n_u16(pairs.val[0], 8), vshlq_n_u16(pairs.val[1], 4)));
+        bytes.val[2] = vmovn_u16(vshrq_n_u16(pairs.val[1], 4));
+        vst3_u8(packed, bytes);
+    }
+
+    return i;
+}
+
+/*
+* Monitor power unpack function (NEON)
+*
+* This function unpacks 16 samples per iteration (the reverse of
+* monitor_power_pack_neon()).
+*
+* Return : number of samples processed
+*
+*/
+static unsigned int monitor_power_unpack_neon(const uint8_t *packed, unsigned int ndata, monitorpdata_t *power) {
+    const uint16x8_t nibble = vdupq_n_u16(0xf);
+    uint16x8_t b0, b1, b2;
+    uint16x8x2_t codes;
+    uint8x8x3_t bytes;
+    unsigned int i;
+
+    for (i = 0; i + 2 * MONITOR_PACK_SAMPLES <= ndata; i += 2 * MONITOR_PACK_SAMPLES, packed += 2 * MONITOR_PACK_BYTES) {
+        bytes = vld3_u8(packed);
+        b0 = vmovl_u8(bytes.val[0]);
+        b1 = vmovl_u8(bytes.val[1]);
+        b2 = vmovl_u8(bytes.val[2]);
+        codes = vzipq_u16(vorrq_u16(b0, vshlq_n_u16(vandq_u16(b1, nibble), 8)), vorrq_u16(vshrq_n_u16(b1, 4), vshlq_n_u16(b2, 4)));
+        vst1q_u32(&power[i], vmovl_u16(vget_low_u16(codes.val[0])));
+        vst1q_u32(&power[i + 4], vmovl_u16(vget_high_u16(codes.val[0])));
+        vst1q_u32(&power[i + 8], vmovl_u16(vget_low_u16(codes.val[1])));
+        vst1q_u32(&power[i + 12], vmovl_u16(vget_high_u16(codes.val[1])));
+    }
+
+    return i;
+}
+#endif
+
+/*
+* Monitor power packed size function
+*
+* This function gets the size of a packed power buffer.
+*
+* @ndata : number of power samples
+*
+* Return : size of the packed samples (in bytes)
+*
+*/
+size_t monitor_power_packed_size(unsigned int ndata) {
+
+    return ((size_t)ndata + MONITOR_PACK_SAMPLES - 1) / MONITOR_PACK_SAMPLES * MONITOR_PACK_BYTES;
+
+}
+
+/*
+* Monitor power pack function
+*
+* This function packs raw power samples (12-bit ADC codes), 8 samples in 12
+* bytes, using NEON or AVX2 when available. SSE2 lacks a byte shuffle, so
+* other x86 machines use the scalar 64-bit word packing.
+*
+* @power  : raw power samples
+* @ndata  : number of power samples
+* @packed : packed samples (see monitor_power_packed_size())
+*
+*/
+void monitor_power_pack(const monitorpdata_t *power, unsigned int ndata, void *packed) {
+    monitorpdata_t tail[MONITOR_PACK_SAMPLES] = {0};
+    uint8_t *dst = packed;
+    unsigned int done = 0;
+
+    #if defined(MONITOR_POWER_NEON)
+    done = monitor_power_pack_neon(power, ndata, dst);
+    #elif defined(MONITOR_POWER_X86)
+    if (__builtin_cpu_supports("avx2")) {
+        done = monitor_power_pack_avx2(power, ndata, dst);
+    }
+    #endif
+    dst += done / MONITOR_PACK_SAMPLES * MONITOR_PACK_BYTES;
+
+    // Remaining groups (and whole buffer without SIMD support)
+    for (; done + MONITOR_PACK_SAMPLES <= ndata; done += MONITOR_PACK_SAMPLES, dst += MONITOR_PACK_BYTES) {
+        monitor_power_pack_group(&power[done], dst);
+    }
+
+    // Last group, padded with zeros
+    if (done < ndata) {
+        memcpy(tail, &power[done], (ndata - done) * sizeof *tail);
+        monitor_power_pack_group(tail, dst);
+    }
+
+}
+
+/*
+* Monitor power unpack function
+*
+* This function unpacks power samples packed by monitor_power_pack().
+*
+* @packed : packed samples
+* @ndata  : number of power samples
+* @power  : raw power samples (@ndata elements)
+*
+*/
+void monitor_power_unpack(const void *packed, unsigned int ndata, monitorpdata_t *power) {
+    monitorpdata_t tail[MONITOR_PACK_SAMPLES];
+    const uint8_t *src = packed;
+    unsigned int done = 0;
+
+    #if defined(MONITOR_POWER_NEON)
+    done = monitor_power_unpack_neon(src, ndata, power);
+    #elif defined(MONITOR_POWER_X86)
+    if (__builtin_cpu_supports("avx2")) {
+        done = monitor_power_unpack_avx2(src, ndata, power);
+    }
+    #endif
+    src += done / MONITOR_PACK_SAMPLES * MONITOR_PACK_BYTES;
+
+    // Remaining groups (and whole buffer without SIMD support)
+    for (; done + MONITOR_PACK_SAMPLES <= ndata; done += MONITOR_PACK_SAMPLES, src += MONITOR_PACK_BYTES) {
+        monitor_power_unpack_group(src, &power[done]);
+    }
+
+    // Last group
+    if (done < ndata) {
+        monitor_power_unpack_group(src, tail);
+        memcpy(&power[done], tail, (ndata - done) * sizeof *tail);
+    }
+
+}
+
+/*
+* Monitor power interval function
+*
+* This function computes the energy, the average power and the peak power
+* of one channel over the interval [@start, @end) (clipped to the capture).
+*
+*/
+static void monitor_power_interval(const uint32_t *mw, unsigned int stride, unsigned int channel, unsigned int nsamples, uint64_t elapsed, unsigned long clock_hz,
+                                   uint64_t start, uint64_t end, struct monitorEnergy_t *energy) {
+    double period = (double)elapsed / nsamples;
+    double lo, hi, sum = 0.0, cycles = 0.0;
+    uint32_t sample, peak = 0;
+    unsigned int k, last;
+
+    if (end > start && start < elapsed) {
+        k = start / period;
+        last = end < elapsed ? (unsigned int)(end / period) : nsamples - 1;
+        if (last >= nsamples) {
+            last = nsamples - 1;
+        }
+
+        for (; k <= last; k++) {
+            // Overlap (in cycles) between the sample and the interval
+            lo = k * period;
+            hi = lo + period;
+            if (lo < start) {
+                lo = start;
+            }
+            if (hi > end) {
+                hi = end;
+            }
+            if (hi <= lo) {
+                continue;
+            }
+            sample = mw[k * stride + channel];
+            sum += sample * (hi - lo);
+            cycles += hi - lo;
+            if (sample > peak) {
+                peak = sample;
+            }
+        }
+    }
+
+    // mW * cycles -> mJ
+    energy->energy = sum / clock_hz;
+    energy->power_avg = cycles > 0.0 ? sum / cycles : 0.0;
+    energy->power_peak = peak;
+}
+
+/*
+* Monitor power energy function
+*
+* This function computes the energy, the average power and the peak power
+* of a capture over a set of intervals.
+*
+* @cal        : calibration (only @dual is used)
+* @channel    : ADC channel
+* @mw         : power in mW
+* @ndata      : number of power samples (of all channels)
+* @elapsed    : elapsed cycles of the capture
+* @clock_hz   : Monitor clock frequency in Hz
+* @intervals  : intervals
+* @nintervals : number of intervals
+* @energy     : energy of every interval (@nintervals elements)
+*
+* Return : 0 on success, -EINVAL on invalid parameters
+*
+*/
+int monitor_power_energy(const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz,
+                         const struct monitorInterval_t *intervals, unsigned int nintervals, struct monitorEnergy_t *energy) {
+    unsigned int stride = cal->dual ? 2 : 1;
+    unsigned int nsamples = ndata / stride;
+    unsigned int j;
+
+    if (channel >= stride || !nsamples || !elapsed || !clock_hz) {
+        return -EINVAL;
+    }
+
+    for (j = 0; j < nintervals; j++) {
+        monitor_power_interval(mw, stride, channel, nsamples, elapsed, clock_hz, intervals[j].start, intervals[j].end, &energy[j]);
+    }
+
+    return 0;
+}
+
+/*
+* Monitor invocations energy function
+*
+* This function fills in the energy, the average power and the peak power
+* of every invocation of a table.
+*
+* @cal          : calibration (only @dual is used)
+* @channel      : ADC channel
+* @mw           : power in mW
+* @ndata        : number of power samples (of all channels)
+* @elapsed      : elapsed cycles of the capture
+* @clock_hz     : Monitor clock frequency in Hz
+* @invocations  : invocations
+* @ninvocations : number of invocations
+*
+* Return : 0 on success, -EINVAL on invalid parameters
+*
+*/
+int monitor_invocations_energy(const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz,
+                               struct monitorInvocation_t *invocations, unsigned int ninvocations) {
+    unsigned int stride = cal->dual ? 2 : 1;
+    unsigned int nsamples = ndata / stride;
+    struct monitorEnergy_t energy;
+    unsigned int j;
+
+    if (channel >= stride || !nsamples || !elapsed || !clock_hz) {
+        return -EINVAL;
+    }
+
+    for (j = 0; j < ninvocations; j++) {
+        monitor_power_interval(mw, stride, channel, nsamples, elapsed, clock_hz, invocations[j].start, invocations[j].end, &energy);
+        invocations[j].energy = energy.energy;
+        invocations[j].power_avg = energy.power_avg;
+        invocations[j].power_peak = energy.power_peak;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor power index build function
+*
+* This function builds the block index of one channel of a converted power
+* buffer in a single pass (plus O(blocks log blocks) for the range tables).
+*
+* @index    : index to be built
+* @cal      : calibration (only @dual is used)
+* @channel  : ADC channel
+* @mw       : power in mW
+* @ndata    : number of power samples (of all channels)
+* @elapsed  : elapsed cycles of the capture
+* @clock_hz : Monitor clock frequency in Hz
+*
+* Return : 0 on success, -EINVAL on invalid parameters, -ENOMEM on
+*          allocation errors
+*
+*/
+int monitor_power_index_build(struct monitorPowerIndex_t *index, const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz) {
+    unsigned int stride = cal->dual ? 2 : 1;
+    unsigned int nsamples = ndata / stride;
+    struct monitorPowerBlock_t *block;
+    unsigned int nblocks, levels, b, k, l, half;
+    double period;
+    uint32_t sample;
+
+    memset(index, 0, sizeof *index);
+
+    if (channel >= stride || !nsamples || !elapsed || !clock_hz) {
+        return -EINVAL;
+    }
+
+    nblocks = (nsamples + MONITOR_INDEX_BLOCK - 1) / MONITOR_INDEX_BLOCK;
+    for (levels = 1; (1U << levels) <= nblocks; levels++);
+
+    index->blocks = malloc(nblocks * sizeof *index->blocks);
+    index->prefix = malloc((nblocks + 1) * sizeof *index->prefix);
+    index->min = malloc(levels * nblocks * sizeof *index->min);
+    index->max = malloc(levels * nblocks * sizeof *index->max);
+    if (!index->blocks || !index->prefix || !index->min || !index->max) {
+        monitor_print_error("[monitor-power] malloc() failed\n");
+        monitor_power_index_free(index);
+        return -ENOMEM;
+    }
+
+    index->mw = mw + channel;
+    index->stride = stride;
+    index->nsamples = nsamples;
+    index->elapsed = elapsed;
+    index->clock_hz = clock_hz;
+    index->nblocks = nblocks;
+    index->levels = levels;
+
+    // Block summaries
+    period = (double)elapsed / nsamples;
+    index->prefix[0] = 0;
+    for (b = 0; b < nblocks; b++) {
+        block = &index->blocks[b];
+        block->start = (uint64_t)(b * MONITOR_INDEX_BLOCK * period);
+        block->end = b + 1 < nblocks ? (uint64_t)((b + 1) * MONITOR_INDEX_BLOCK * period) : elapsed;
+        block->min = UINT32_MAX;
+        block->max = 0;
+        block->sum = 0;
+        for (k = b * MONITOR_INDEX_BLOCK; k < nsamples && k < (b + 1) * MONITOR_INDEX_BLOCK; k++) {
+            sample = index->mw[k * stride];
+            block->sum += sample;
+            if (sample < block->min) {
+                block->min = sample;
+            }
+            if (sample > block->max) {
+                block->max = sample;
+            }
+        }
+        index->prefix[b + 1] = index->prefix[b] + block->sum;
+        index->min[b] = block->min;
+        index->max[b] = block->max;
+    }
+
+    // Range tables: level l covers 2^l blocks from every block
+    for (l = 1; l < levels; l++) {
+        half = 1U << (l - 1);
+        for (b = 0; b + (1U << l) <= nblocks; b++) {
+            index->min[l * nblocks + b] = index->min[(l - 1) * nblocks + b] < index->min[(l - 1) * nblocks + b + half] ?
+                                          index->min[(l - 1) * nblocks + b] : index->min[(l - 1) * nblocks + b + half];
+            index->max[l * nblocks + b] = index->max[(l - 1) * nblocks + b] > index->max[(l - 1) * nblocks + b + half] ?
+                                          index->max[(l - 1) * nblocks + b] : index->max[(l - 1) * nblocks + b + half];
+        }
+    }
+
+    return 0;
+}
+
+/*
+* Monitor power index free function
+*
+* This function releases the memory of a power index.
+*
+* @index : index
+*
+*/
+void monitor_power_index_free(struct monitorPowerIndex_t *index) {
+
+    free(index->blocks);
+    free(index->prefix);
+    free(index->min);
+    free(index->max);
+    memset(index, 0, sizeof *index);
+
+}
+
+/*
+* Monitor power index scan function
+*
+* This function computes the sum, minimum and maximum of the samples
+* [@first, @last) of an index, scanning only the partial blocks.
+*
+*/
+static void monitor_power_index_scan(const struct monitorPowerIndex_t *index, unsigned int first, unsigned int last, uint64_t *sum, uint32_t *min, uint32_t *max) {
+    unsigned int b0 = first / MONITOR_INDEX_BLOCK;
+    unsigned int b1 = (last - 1) / MONITOR_INDEX_BLOCK;
+    unsigned int k, l, n, lo, hi;
+    uint32_t sample;
+
+    *sum = 0;
+    *min = UINT32_MAX;
+    *max = 0;
+
+    // Whole blocks in between (prefix sums and range tables)
+    if (b1 > b0 + 1) {
+        lo = b0 + 1;
+        hi = b1;
+        n = hi - lo;
+        l = 31 - __builtin_clz(n);
+        *sum = index->prefix[hi] - index->prefix[lo];
+        *min = index->min[l * index->nblocks + lo] < index->min[l * index->nblocks + hi - (1U << l)] ?
+               index->min[l * index->nblocks + lo] : index->min[l * index->nblocks + hi - (1U << l)];
+        *max = index->max[l * index->nblocks + lo] > index->max[l * index->nblocks + hi - (1U << l)] ?
+               index->max[l * index->nblocks + lo] : index->max[l * index->nblocks + hi - (1U << l)];
+    }
+
+    // Partial blocks at both ends
+    for (k = first; k < last; k++) {
+        if (b1 > b0 && k == (b0 + 1) * MONITOR_INDEX_BLOCK) {
+            k = b1 * MONITOR_INDEX_BLOCK;
+        }
+        sample = index->mw[k * index->stride];
+        *sum += sample;
+        if (sample < *min) {
+            *min = sample;
+        }
+        if (sample > *max) {
+            *max = sample;
+        }
+    }
+}
+
+/*
+* Monitor power index query function
+*
+* This function computes the power samples, energy, average, minimum and
+* maximum power of the time window [@start, @end) (clipped to the capture).
+*
+* @index  : index
+* @start  : first cycle of the window
+* @end    : first cycle after the window
+* @window : window statistics
+*
+* Return : 0 on success, -EINVAL if the window is empty
+*
+*/
+int monitor_power_index_query(const struct monitorPowerIndex_t *index, uint64_t start, uint64_t end, struct monitorPowerWindow_t *window) {
+    double period, sum;
+    unsigned int first, last;
+    uint64_t total;
+
+    if (end > index->elapsed) {
+        end = index->elapsed;
+    }
+    if (!index->nsamples || end <= start) {
+        return -EINVAL;
+    }
+
+    // Samples that overlap the window
+    period = (double)index->elapsed / index->nsamples;
+    first = start / period;
+    last = (unsigned int)(end / period);
+    if (last < index->nsamples && last * period < end) {
+        last++;
+    }
+    if (last > index->nsamples) {
+        last = index->nsamples;
+    }
+    if (first >= last) {
+        return -EINVAL;
+    }
+
+    monitor_power_index_scan(index, first, last, &total, &window->power_min, &window->power_max);
+
+    // Weight the boundary samples by their overlap (mW * cycles)
+    sum = total * period;
+    sum -= index->mw[first * index->stride] * (start - first * period);
+    if (last * period > end) {
+        sum -= index->mw[(last - 1) * index->stride] * (last * period - end);
+    }
+
+    window->first = first;
+    window->count = last - first;
+    window->energy = sum / index->clock_hz;
+    window->power_avg = sum / (end - start);
+
+    return 0;
+}
+
+/*
+* Monitor ensemble init function
+*
+* This function allocates an empty ensemble.
+*
+* @ensemble : ensemble
+* @pre      : number of bins before the trigger
+* @post     : number of bins from the trigger on
+*
+* Return : 0 on success, -EINVAL on invalid parameters, -ENOMEM on
+*          allocation errors
+*
+*/
+int monitor_ensemble_init(struct monitorEnsemble_t *ensemble, unsigned int pre, unsigned int post) {
+
+    memset(ensemble, 0, sizeof *ensemble);
+    if (!post || pre > UINT_MAX - post) {
+        return -EINVAL;
+    }
+
+    ensemble->pre = pre;
+    ensemble->length = pre + post;
+    ensemble->count = calloc(ensemble->length, sizeof *ensemble->count);
+    ensemble->mean = calloc(ensemble->length, sizeof *ensemble->mean);
+    ensemble->m2 = calloc(ensemble->length, sizeof *ensemble->m2);
+    if (!ensemble->count || !ensemble->mean || !ensemble->m2) {
+        monitor_print_error("[monitor-power] calloc() failed\n");
+        monitor_ensemble_free(ensemble);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor ensemble reset function
+*
+* This function empties an ensemble.
+*
+* @ensemble : ensemble
+*
+*/
+void monitor_ensemble_reset(struct monitorEnsemble_t *ensemble) {
+
+    ensemble->runs = 0;
+    ensemble->period = 0.0;
+    memset(ensemble->count, 0, ensemble->length * sizeof *ensemble->count);
+    memset(ensemble->mean, 0, ensemble->length * sizeof *ensemble->mean);
+    memset(ensemble->m2, 0, ensemble->length * sizeof *ensemble->m2);
+
+}
+
+/*
+* Monitor ensemble free function
+*
+* This function releases the memory of an ensemble.
+*
+* @ensemble : ensemble
+*
+*/
+void monitor_ensemble_free(struct monitorEnsemble_t *ensemble) {
+
+    free(ensemble->count);
+    free(ensemble->mean);
+    free(ensemble->m2);
+    memset(ensemble, 0, sizeof *ensemble);
+
+}
+
+/*
+* Monitor ensemble add function
+*
+* This function adds a capture to an ensemble, interpolating every bin at
+* its offset from the trigger and updating its running mean and variance.
+*
+* @ensemble : ensemble
+* @cal      : calibration (only @dual is used)
+* @channel  : ADC channel
+* @mw       : power in mW
+* @ndata    : number of power samples (of all channels)
+* @elapsed  : elapsed cycles of the capture
+* @trigger  : trigger cycle from the beginning of the capture
+*
+* Return : number of bins updated, -EINVAL on invalid parameters, -ERANGE
+*          if @trigger is outside the capture
+*
+*/
+int monitor_ensemble_add(struct monitorEnsemble_t *ensemble, const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata,
+                         uint64_t elapsed, uint64_t trigger) {
+    unsigned int stride = cal->dual ? 2 : 1;
+    unsigned int nsamples = ndata / stride;
+    unsigned int j, k, updated = 0;
+    double period, position, fraction, value, delta;
+
+    if (channel >= stride || !nsamples || !elapsed || !ensemble->length) {
+        return -EINVAL;
+    }
+    if (trigger >= elapsed) {
+        return -ERANGE;
+    }
+
+    // Position of the trigger in samples (sample k is centered at (k + 0.5) * period)
+    period = (double)elapsed / nsamples;
+    position = trigger / period - 0.5 - ensemble->pre;
+
+    for (j = 0; j < ensemble->length; j++, position += 1.0) {
+        if (position < 0.0 || position > nsamples - 1) {
+            continue;
+        }
+        k = position;
+        fraction = position - k;
+        value = mw[k * stride + channel];
+        if (fraction > 0.0) {
+            value += (mw[(k + 1) * stride + channel] - value) * fraction;
+        }
+
+        // Welford update
+        ensemble->count[j]++;
+        delta = value - ensemble->mean[j];
+        ensemble->mean[j] += delta / ensemble->count[j];
+        ensemble->m2[j] += delta * (value - ensemble->mean[j]);
+        updated++;
+    }
+
+    ensemble->runs++;
+    ensemble->period += (period - ensemble->period) / ensemble->runs;
+
+    return updated;
+}
+
+/*
+* Monitor ensemble variance function
+*
+* This function gets the sample variance of a bin.
+*
+* @ensemble : ensemble
+* @bin      : bin
+*
+* Return : variance (0 with fewer than 2 captures)
+*
+*/
+double monitor_ensemble_variance(const struct monitorEnsemble_t *ensemble, unsigned int bin) {
+
+    if (bin >= ensemble->length || ensemble->count[bin] < 2) {
+        return 0.0;
+    }
+
+    return ensemble->m2[bin] / (ensemble->count[bin] - 1);
+}
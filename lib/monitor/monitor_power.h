@@ -0,0 +1,483 @@
+/*
+ * Monitor power API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor power API, which converts
+ *               the raw ADC codes drained from the power memory bank into
+ *               calibrated power values.
+ *
+ */
+
+
+ #ifndef _MONITOR_POWER_H_
+ #define _MONITOR_POWER_H_
+
+ #include <stdint.h> // uint32_t
+ #include <stddef.h> // size_t
+
+ #include "monitor.h"
+ #include "monitor_traces.h"
+
+
+ /*
+  * ADC resolution (power_data(11 downto 0) in monitor.vhd)
+  *
+  */
+ #define MONITOR_ADC_BITS (12)
+ #define MONITOR_ADC_MASK ((1U << MONITOR_ADC_BITS) - 1)
+
+
+ /*
+  * Packed power samples: groups of 8 ADC codes in 12 bytes (every 2 codes
+  * take 3 bytes, lowest code first, little-endian)
+  *
+  */
+ #define MONITOR_PACK_SAMPLES (8)
+ #define MONITOR_PACK_BYTES   (12)
+
+
+ /*
+  * MONITOR calibration type
+  *
+  * Measurement board parameters (ADC_* , SHUNT_RESISTOR* and VDD in the
+  * visualization config.yaml). The power of a sample is
+  *
+  *     P = VDD * Vref * code / (2^MONITOR_ADC_BITS * gain * shunt)
+  *
+  * When the Monitor is built with ADC_DUAL, the power memory bank interleaves
+  * both ADC channels (even samples: channel 0, odd samples: channel 1).
+  *
+  *     struct monitorCalibration_t cal = {
+  *         .vref_mv = monitor_get_vref(), .gain = 50.4,
+  *         .shunt = {0.1, 0.002}, .vdd = 5.0, .dual = 1,
+  *     };
+  *     monitor_calibration_update(&cal);
+  *
+  * @vref_mv : ADC voltage reference in mV (see monitor_get_vref())
+  * @gain    : current sense amplifier gain
+  * @shunt   : shunt resistor of each channel (in Ohm)
+  * @vdd     : supply voltage of the measured rail (in V)
+  * @dual    : samples interleave two channels (ADC_DUAL)
+  * @factor  : fixed-point mW per ADC code of each channel (set by
+  *            monitor_calibration_update())
+  * @shift   : fractional bits of @factor (set by monitor_calibration_update())
+  *
+  */
+ struct monitorCalibration_t {
+     unsigned int vref_mv;
+     double gain;
+     double shunt[2];
+     double vdd;
+     int dual;
+     uint32_t factor[2];
+     unsigned int shift;
+ };
+
+
+ /*
+  * Number of power samples summarized by each block of a power index
+  *
+  */
+ #define MONITOR_INDEX_BLOCK (256)
+
+
+ /*
+  * MONITOR power block type
+  *
+  * @start : first cycle of the block
+  * @end   : first cycle after the block
+  * @min   : minimum power (in mW)
+  * @max   : maximum power (in mW)
+  * @sum   : sum of the power samples (in mW)
+  *
+  */
+ struct monitorPowerBlock_t {
+     uint64_t start;
+     uint64_t end;
+     uint32_t min;
+     uint32_t max;
+     uint64_t sum;
+ };
+
+
+ /*
+  * MONITOR power index type
+  *
+  * Block summaries of one channel of a converted power buffer, so that time
+  * windows can be queried without scanning the whole buffer. The power
+  * buffer is not copied, and it has to outlive the index.
+  *
+  *     struct monitorPowerIndex_t index;
+  *     monitor_power_index_build(&index, &cal, 0, mw, ndata, monitor_get_elapsed(), MONITOR_CLOCK_FREQ);
+  *     monitor_power_index_query(&index, t0, t1, &window);
+  *     ...
+  *     monitor_power_index_free(&index);
+  *
+  * @mw       : power in mW
+  * @stride   : distance between samples of the channel
+  * @nsamples : number of samples of the channel
+  * @elapsed  : elapsed cycles of the capture
+  * @clock_hz : Monitor clock frequency in Hz
+  * @blocks   : block summaries
+  * @nblocks  : number of blocks
+  * @prefix   : prefix sums of the block sums (@nblocks + 1 elements)
+  * @min      : range-minimum table over the blocks (@levels x @nblocks)
+  * @max      : range-maximum table over the blocks (@levels x @nblocks)
+  * @levels   : levels of the range tables
+  *
+  */
+ struct monitorPowerIndex_t {
+     const uint32_t *mw;
+     unsigned int stride;
+     unsigned int nsamples;
+     uint64_t elapsed;
+     unsigned long clock_hz;
+     struct monitorPowerBlock_t *blocks;
+     unsigned int nblocks;
+     uint64_t *prefix;
+     uint32_t *min;
+     uint32_t *max;
+     unsigned int levels;
+ };
+
+
+ /*
+  * MONITOR power window type
+  *
+  * @first     : first power sample (of the channel) in the window
+  * @count     : number of power samples (of the channel) in the window
+  * @energy    : energy (in mJ)
+  * @power_avg : average power (in mW)
+  * @power_min : minimum power (in mW)
+  * @power_max : maximum power (in mW)
+  *
+  */
+ struct monitorPowerWindow_t {
+     unsigned int first;
+     unsigned int count;
+     double energy;
+     double power_avg;
+     uint32_t power_min;
+     uint32_t power_max;
+ };
+
+
+ /*
+  * MONITOR ensemble type
+  *
+  * Per-sample running mean and variance (Welford) of repeated captures of
+  * one channel, aligned at a trigger point, in fixed memory. Bin @pre is
+  * the power at the trigger, and every bin is one sample period apart.
+  *
+  *     struct monitorEnsemble_t ensemble;
+  *     monitor_ensemble_init(&ensemble, 16, 64);
+  *     for every capture:
+  *         monitor_ensemble_add(&ensemble, &cal, 0, mw, ndata, elapsed, trigger);
+  *     ensemble.mean[k], monitor_ensemble_variance(&ensemble, k)
+  *     ...
+  *     monitor_ensemble_free(&ensemble);
+  *
+  * @pre    : number of bins before the trigger
+  * @length : number of bins
+  * @runs   : number of captures added
+  * @period : mean sample period of the captures (in cycles)
+  * @count  : number of captures that cover each bin
+  * @mean   : running mean of each bin
+  * @m2     : running sum of squared deviations of each bin
+  *
+  */
+ struct monitorEnsemble_t {
+     unsigned int pre;
+     unsigned int length;
+     unsigned int runs;
+     double period;
+     uint32_t *count;
+     double *mean;
+     double *m2;
+ };
+
+
+ /*
+  * Monitor calibration update function
+  *
+  * This function computes the fixed-point conversion factors of a
+  * calibration. It has to be called after changing any of its parameters.
+  *
+  * @cal : calibration
+  *
+  * Return : 0 on success, -EINVAL on invalid parameters, -ERANGE if the
+  *          conversion does not fit in 32 bits
+  *
+  */
+ int monitor_calibration_update(struct monitorCalibration_t *cal);
+
+
+ /*
+  * Monitor power convert function
+  *
+  * This function converts raw power samples to mW (rounded to the nearest
+  * integer) with fixed-point arithmetic, using the widest SIMD extension
+  * available (NEON, AVX2 or SSE2, with a scalar fallback). @power and @mw
+  * can be the same buffer.
+  *
+  * Note: on Alveo U250 devices the power samples come from the CMS, and
+  * they do not need this conversion.
+  *
+  * @cal   : calibration (see monitor_calibration_update())
+  * @power : raw power samples
+  * @ndata : number of power samples
+  * @mw    : power in mW (@ndata elements)
+  *
+  */
+ void monitor_power_convert(const struct monitorCalibration_t *cal, const monitorpdata_t *power, unsigned int ndata, uint32_t *mw);
+
+
+ /*
+  * Monitor power packed size function
+  *
+  * This function gets the size of a packed power buffer (whole groups of
+  * MONITOR_PACK_SAMPLES codes).
+  *
+  * @ndata : number of power samples
+  *
+  * Return : size of the packed samples (in bytes)
+  *
+  */
+ size_t monitor_power_packed_size(unsigned int ndata);
+
+
+ /*
+  * Monitor power pack function
+  *
+  * This function packs raw power samples (12-bit ADC codes) into
+  * MONITOR_PACK_BYTES bytes per MONITOR_PACK_SAMPLES samples, 2.67x smaller
+  * than monitorpdata_t buffers. The last group is padded with zeros.
+  *
+  * Note: on Alveo U250 devices the power samples come from the CMS, they
+  * are not 12-bit codes and they cannot be packed.
+  *
+  * @power  : raw power samples
+  * @ndata  : number of power samples
+  * @packed : packed samples (see monitor_power_packed_size())
+  *
+  */
+ void monitor_power_pack(const monitorpdata_t *power, unsigned int ndata, void *packed);
+
+
+ /*
+  * Monitor power unpack function
+  *
+  * This function unpacks power samples packed by monitor_power_pack().
+  *
+  * @packed : packed samples
+  * @ndata  : number of power samples
+  * @power  : raw power samples (@ndata elements)
+  *
+  */
+ void monitor_power_unpack(const void *packed, unsigned int ndata, monitorpdata_t *power);
+
+
+ /*
+  * MONITOR energy type
+  *
+  * @energy     : energy (in mJ)
+  * @power_avg  : average power (in mW)
+  * @power_peak : peak power (in mW)
+  *
+  */
+ struct monitorEnergy_t {
+     double energy;
+     double power_avg;
+     uint32_t power_peak;
+ };
+
+
+ /*
+  * Monitor power energy function
+  *
+  * This function computes the energy, the average power and the peak power
+  * of a capture over a set of intervals (see monitor_intervals_level() and
+  * monitor_intervals_edges()). The power samples are assumed to be evenly
+  * spread over the elapsed cycles of the capture, and the samples that are
+  * only partially inside an interval are weighted accordingly.
+  *
+  * The intervals are in cycles from the beginning of the capture (i.e., the
+  * 32-bit timestamps of the records, or the 64-bit ones with origin 0), and
+  * they are clipped to the capture. The cost is O(intervals + samples) when
+  * the intervals do not overlap.
+  *
+  * @cal        : calibration (only @dual is used)
+  * @channel    : ADC channel (0, or 0..1 with ADC_DUAL)
+  * @mw         : power in mW (see monitor_power_convert())
+  * @ndata      : number of power samples (of all channels)
+  * @elapsed    : elapsed cycles of the capture (see monitor_get_elapsed())
+  * @clock_hz   : Monitor clock frequency in Hz
+  * @intervals  : intervals
+  * @nintervals : number of intervals
+  * @energy     : energy of every interval (@nintervals elements)
+  *
+  * Return : 0 on success, -EINVAL on invalid parameters
+  *
+  */
+ int monitor_power_energy(const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz,
+                          const struct monitorInterval_t *intervals, unsigned int nintervals, struct monitorEnergy_t *energy);
+
+
+ /*
+  * Monitor invocations energy function
+  *
+  * This function fills in the energy, the average power and the peak power
+  * of every invocation of a table (see monitor_invocations() and
+  * monitor_power_energy()). The power is measured for the whole board, so
+  * concurrent invocations share the same samples.
+  *
+  * @cal          : calibration (only @dual is used)
+  * @channel      : ADC channel (0, or 0..1 with ADC_DUAL)
+  * @mw           : power in mW (see monitor_power_convert())
+  * @ndata        : number of power samples (of all channels)
+  * @elapsed      : elapsed cycles of the capture (see monitor_get_elapsed())
+  * @clock_hz     : Monitor clock frequency in Hz
+  * @invocations  : invocations
+  * @ninvocations : number of invocations
+  *
+  * Return : 0 on success, -EINVAL on invalid parameters
+  *
+  */
+ int monitor_invocations_energy(const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz,
+                                struct monitorInvocation_t *invocations, unsigned int ninvocations);
+
+
+ /*
+  * Monitor power index build function
+  *
+  * This function builds the block index of one channel of a converted power
+  * buffer in a single pass (plus O(blocks log blocks) for the range tables).
+  *
+  * @index    : index to be built
+  * @cal      : calibration (only @dual is used)
+  * @channel  : ADC channel (0, or 0..1 with ADC_DUAL)
+  * @mw       : power in mW (see monitor_power_convert())
+  * @ndata    : number of power samples (of all channels)
+  * @elapsed  : elapsed cycles of the capture (see monitor_get_elapsed())
+  * @clock_hz : Monitor clock frequency in Hz
+  *
+  * Return : 0 on success, -EINVAL on invalid parameters, -ENOMEM on
+  *          allocation errors
+  *
+  */
+ int monitor_power_index_build(struct monitorPowerIndex_t *index, const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata, uint64_t elapsed, unsigned long clock_hz);
+
+
+ /*
+  * Monitor power index free function
+  *
+  * This function releases the memory of a power index.
+  *
+  * @index : index
+  *
+  */
+ void monitor_power_index_free(struct monitorPowerIndex_t *index);
+
+
+ /*
+  * Monitor power index query function
+  *
+  * This function computes the power samples, energy, average, minimum and
+  * maximum power of the time window [@start, @end) (clipped to the capture).
+  * Samples only partially inside the window are weighted accordingly for
+  * the energy and the average power. Whole blocks are answered from their
+  * summaries, so only up to two partial blocks are scanned.
+  *
+  * @index  : index
+  * @start  : first cycle of the window
+  * @end    : first cycle after the window
+  * @window : window statistics
+  *
+  * Return : 0 on success, -EINVAL if the window is empty
+  *
+  */
+ int monitor_power_index_query(const struct monitorPowerIndex_t *index, uint64_t start, uint64_t end, struct monitorPowerWindow_t *window);
+
+
+ /*
+  * Monitor ensemble init function
+  *
+  * This function allocates an empty ensemble.
+  *
+  * @ensemble : ensemble
+  * @pre      : number of bins before the trigger
+  * @post     : number of bins from the trigger on
+  *
+  * Return : 0 on success, -EINVAL on invalid parameters, -ENOMEM on
+  *          allocation errors
+  *
+  */
+ int monitor_ensemble_init(struct monitorEnsemble_t *ensemble, unsigned int pre, unsigned int post);
+
+
+ /*
+  * Monitor ensemble reset function
+  *
+  * This function empties an ensemble (keeping its memory).
+  *
+  * @ensemble : ensemble
+  *
+  */
+ void monitor_ensemble_reset(struct monitorEnsemble_t *ensemble);
+
+
+ /*
+  * Monitor ensemble free function
+  *
+  * This function releases the memory of an ensemble.
+  *
+  * @ensemble : ensemble
+  *
+  */
+ void monitor_ensemble_free(struct monitorEnsemble_t *ensemble);
+
+
+ /*
+  * Monitor ensemble add function
+  *
+  * This function adds a capture to an ensemble. The power samples are
+  * assumed to be evenly spread over the elapsed cycles of the capture (as
+  * in monitor_power_energy()), and each one is placed at the center of its
+  * sample period. The bins are linearly interpolated at their exact offset
+  * from the trigger, so captures are aligned with sub-sample resolution
+  * (the trigger phase with respect to the ADC varies from run to run).
+  * Bins outside the capture are not updated.
+  *
+  * @ensemble : ensemble
+  * @cal      : calibration (only @dual is used)
+  * @channel  : ADC channel (0, or 0..1 with ADC_DUAL)
+  * @mw       : power in mW (see monitor_power_convert())
+  * @ndata    : number of power samples (of all channels)
+  * @elapsed  : elapsed cycles of the capture (see monitor_get_elapsed())
+  * @trigger  : trigger cycle from the beginning of the capture (e.g., the
+  *             start of an invocation, see monitor_invocations())
+  *
+  * Return : number of bins updated, -EINVAL on invalid parameters, -ERANGE
+  *          if @trigger is outside the capture
+  *
+  */
+ int monitor_ensemble_add(struct monitorEnsemble_t *ensemble, const struct monitorCalibration_t *cal, unsigned int channel, const uint32_t *mw, unsigned int ndata,
+                          uint64_t elapsed, uint64_t trigger);
+
+
+ /*
+  * Monitor ensemble variance function
+  *
+  * This function gets the (unbiased) sample variance of a bin. The standard
+  * error of its mean is sqrt(variance / count).
+  *
+  * @ensemble : ensemble
+  * @bin      : bin (0..@length - 1)
+  *
+  * Return : variance (0 with fewer than 2 captures)
+  *
+  */
+ double monitor_ensemble_variance(const struct monitorEnsemble_t *ensemble, unsigned int bin);
+
+
+ #endif /* _MONITOR_POWER_H_ */
@@ -0,0 +1,287 @@
+/*
+ * Monitor capture session API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor capture session API, which
+*               runs repeated captures (start, wait, drain, clean) keeping
+*               the device mappings, DMA staging buffers, masks and output
+*               files alive between them.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "monitor.h"
+#include "monitor_file.h"
+#include "monitor_session.h"
+#include "monitor_latency.h"
+#include "monitor_dbg.h"
+
+#define MONITOR_SESSION_POWER "session_power"
+
+/*
+* Monitor session time function
+*
+* Return : CLOCK_MONOTONIC time in ns
+*
+*/
+static inline uint64_t monitor_session_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+* Monitor session open function
+*
+* This function sets up a capture session.
+*
+* @session : session
+* @monitor : Monitor instance (NULL to open one)
+* @config  : session configuration
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_session_open(struct monitorSession_t *session, monitor_t *monitor, const struct monitorSessionConfig_t *config) {
+    int ret;
+
+    memset(session, 0, sizeof *session);
+    if (!config || (config->vref_mv && config->vref_mv != MONITOR_VREF_MV && config->vref_mv != MONITOR_2VREF_MV)) {
+        return -EINVAL;
+    }
+
+    // Device mappings and DMA staging buffers are set up only once
+    session->monitor = monitor;
+    if (!session->monitor) {
+        session->monitor = monitor_dev_open_capacity(config->devname, config->power_capacity, config->traces_capacity);
+        if (!session->monitor) {
+            monitor_print_error("[monitor-session] could not open the Monitor\n");
+            return -ENODEV;
+        }
+        session->owned = 1;
+    }
+    session->timeout = config->timeout ? config->timeout : MONITOR_START_TIMEOUT;
+
+    #ifdef AU250
+    // The CMS thread fills a power region (there is no power memory bank)
+    session->power = monitor_dev_alloc(session->monitor, config->power_capacity, MONITOR_SESSION_POWER, MONITOR_REG_POWER);
+    if (!session->power) {
+        ret = -ENOMEM;
+        goto err_session;
+    }
+    #endif
+
+    if (config->archive) {
+        ret = monitor_archive_open(config->archive, MONITOR_ARCHIVE_WRITE, &session->archive);
+        if (ret < 0) {
+            goto err_session;
+        }
+        session->archived = 1;
+    }
+
+    // Masks and voltage reference are kept across captures
+    if (config->mask) {
+        monitor_dev_set_mask(session->monitor, config->mask);
+    }
+    if (config->axi_mask) {
+        monitor_dev_set_axi_mask(session->monitor, config->axi_mask);
+    }
+    if (config->vref_mv == MONITOR_VREF_MV) {
+        monitor_dev_config_vref(session->monitor);
+    }
+    else if (config->vref_mv == MONITOR_2VREF_MV) {
+        monitor_dev_config_2vref(session->monitor);
+    }
+    monitor_dev_clean(session->monitor);
+
+    return 0;
+
+err_session:
+    monitor_session_close(session);
+    return ret;
+}
+
+/*
+* Monitor session archive function
+*
+* This function appends a drained capture to the archive of a session.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_session_archive(struct monitorSession_t *session, const struct monitorSessionCapture_t *capture) {
+    struct monitorCapture_t description;
+    int ret;
+
+    ret = monitor_dev_get_capture(session->monitor, &description);
+    if (ret < 0) {
+        return ret;
+    }
+    description.power = capture->power.data;
+    description.power_count = capture->power.data ? capture->power.ndata : 0;
+    description.traces = capture->traces.data;
+    description.traces_count = capture->traces.data ? capture->traces.ndata : 0;
+
+    return monitor_archive_append(&session->archive, &description);
+}
+
+/*
+* Monitor session run function
+*
+* This function runs up to @count captures: re-arm, workload, wait, drain,
+* callback, archive and clean.
+*
+* @session  : session
+* @count    : number of captures
+* @workload : workload callback (can be NULL)
+* @callback : capture callback (can be NULL)
+* @arg      : callbacks argument
+*
+* Return : number of captures on success, error code otherwise
+*
+*/
+int monitor_session_run(struct monitorSession_t *session, unsigned int count, monitor_session_workload_t workload, monitor_session_callback_t callback, void *arg) {
+    struct monitorSessionStats_t *stats = &session->stats;
+    struct monitorSessionCapture_t capture;
+    uint64_t t_start, t_armed, t_done, t_drained, t_callback, t_archived, t_clean;
+    uint64_t t_prev = 0, t_user = 0, t_latency, overhead;
+    unsigned int i;
+    int stop = 0, ret = 0;
+
+    for (i = 0; i < count && !stop && ret == 0; i++) {
+        // Re-arm
+        t_start = monitor_session_now();
+        ret = monitor_dev_start_timeout(session->monitor, session->timeout);
+        if (ret < 0) {
+            monitor_print_error("[monitor-session] monitor_start() failed (%d)\n", ret);
+            break;
+        }
+        t_armed = monitor_session_now();
+
+        // Time from the end of the previous capture to this re-arm, but the user's callback and archive time
+        if (i > 0) {
+            overhead = t_armed - t_prev - t_user;
+            if (!stats->overhead_max || overhead < stats->overhead_min) {
+                stats->overhead_min = overhead;
+            }
+            if (overhead > stats->overhead_max) {
+                stats->overhead_max = overhead;
+            }
+            stats->overhead_sum += overhead;
+        }
+
+        if (workload && workload(arg) != 0) {
+            stop = 1;
+        }
+        #ifdef AU250
+        // Without ADC, the capture runs until it is stopped
+        monitor_dev_stop(session->monitor);
+        #endif
+        monitor_dev_wait(session->monitor);
+        t_done = monitor_session_now();
+
+        // Drain in place
+        memset(&capture, 0, sizeof capture);
+        capture.iteration = i;
+        ret = monitor_dev_read_capture(session->monitor, &capture.status, &capture.power, &capture.traces);
+        if (ret < 0) {
+            monitor_print_error("[monitor-session] monitor_read_capture() failed (%d)\n", ret);
+        }
+        #ifdef AU250
+        capture.power.data = session->power;
+        capture.power.ndata = capture.status.power_samples;
+        capture.power.regtype = MONITOR_REG_POWER;
+        #endif
+        capture.elapsed = monitor_dev_get_elapsed(session->monitor);
+        t_drained = monitor_session_now();
+
+        if (ret == 0 && callback && callback(&capture, arg) != 0) {
+            stop = 1;
+        }
+        t_callback = monitor_session_now();
+
+        if (ret == 0 && session->archived) {
+            t_latency = monitor_dev_latency_begin(session->monitor);
+            ret = monitor_session_archive(session, &capture);
+            if (ret < 0) {
+                monitor_print_error("[monitor-session] monitor_archive_append() failed (%d)\n", ret);
+            }
+            monitor_dev_latency_add(session->monitor, MONITOR_STAGE_WRITE, t_latency);
+        }
+        t_archived = monitor_session_now();
+
+        // Release the staging buffers and clean the memory banks for the next capture
+        #ifndef AU250
+        if (capture.power.data) {
+            monitor_dev_view_release(session->monitor, &capture.power);
+        }
+        #endif
+        if (capture.traces.data) {
+            monitor_dev_view_release(session->monitor, &capture.traces);
+        }
+        monitor_dev_clean(session->monitor);
+        t_clean = monitor_session_now();
+
+        stats->captures++;
+        stats->start_sum += t_armed - t_start;
+        stats->wait_sum += t_done - t_armed;
+        stats->drain_sum += t_drained - t_done;
+        stats->callback_sum += t_callback - t_drained;
+        stats->archive_sum += t_archived - t_callback;
+        stats->clean_sum += t_clean - t_archived;
+        t_prev = t_done;
+        t_user = t_archived - t_drained;
+    }
+
+    return ret < 0 ? ret : (int)i;
+}
+
+/*
+* Monitor session statistics function
+*
+* This function gets the statistics of every run of a session.
+*
+* @session : session
+* @stats   : statistics
+*
+*/
+void monitor_session_stats(const struct monitorSession_t *session, struct monitorSessionStats_t *stats) {
+
+    *stats = session->stats;
+
+}
+
+/*
+* Monitor session close function
+*
+* This function closes the archive of a session, and its Monitor instance
+* if the session opened it.
+*
+* @session : session
+*
+*/
+void monitor_session_close(struct monitorSession_t *session) {
+
+    if (session->archived) {
+        monitor_archive_close(&session->archive);
+        session->archived = 0;
+    }
+    if (session->power) {
+        monitor_dev_free(session->monitor, MONITOR_SESSION_POWER);
+        session->power = NULL;
+    }
+    if (session->owned) {
+        monitor_dev_close(session->monitor);
+        session->owned = 0;
+    }
+    session->monitor = NULL;
+
+}
@@ -0,0 +1,215 @@
+/*
+ * Monitor capture session API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor capture session API, which
+ *               runs repeated captures (start, wait, drain, clean) keeping
+ *               the device mappings, DMA staging buffers, masks and output
+ *               files alive between them.
+ *
+ */
+
+
+ #ifndef _MONITOR_SESSION_H_
+ #define _MONITOR_SESSION_H_
+
+ #include <stdint.h> // uint64_t
+
+ #include "monitor.h"
+ #include "monitor_file.h"
+
+
+ /*
+  * MONITOR session configuration type
+  *
+  * @devname         : Monitor device file name (NULL for the default device),
+  *                    used when the session opens its own Monitor instance
+  * @power_capacity  : maximum number of power samples of a capture
+  * @traces_capacity : maximum number of traces samples of a capture
+  * @mask            : triggering mask (0 to keep the current one)
+  * @axi_mask        : AXI triggering mask (0 to keep the current one)
+  * @vref_mv         : ADC voltage reference, MONITOR_VREF_MV or
+  *                    MONITOR_2VREF_MV (0 to keep the current one)
+  * @timeout         : maximum time to wait for the monitor to be idle
+  *                    before each capture in milliseconds (0 for
+  *                    MONITOR_START_TIMEOUT, -1 to wait forever)
+  * @archive         : archive every capture is appended to (NULL for none,
+  *                    see monitor_archive_open())
+  *
+  */
+ struct monitorSessionConfig_t {
+     const char *devname;
+     unsigned int power_capacity;
+     unsigned int traces_capacity;
+     int mask;
+     int axi_mask;
+     unsigned int vref_mv;
+     int timeout;
+     const char *archive;
+ };
+
+
+ /*
+  * MONITOR session capture type
+  *
+  * Capture handed to the session callback. The samples are read in place
+  * from the DMA staging buffers, so they are only valid during the callback.
+  *
+  * @iteration : capture number (0 is the first capture of the run)
+  * @status    : status snapshot taken at the end of the capture
+  * @elapsed   : 64-bit elapsed cycles of the capture
+  * @power     : power samples (on AU250, the CMS samples)
+  * @traces    : trace records
+  *
+  */
+ struct monitorSessionCapture_t {
+     unsigned int iteration;
+     struct monitorStatus_t status;
+     uint64_t elapsed;
+     struct monitorView_t power;
+     struct monitorView_t traces;
+ };
+
+
+ /*
+  * MONITOR session statistics type
+  *
+  * All times are in ns (CLOCK_MONOTONIC). The overhead of a capture is the
+  * time from the end of the previous capture to the re-arm of this one,
+  * minus the time spent in the callback and in the archive: that is the
+  * time the session itself needs to drain, clean and restart the monitor.
+  *
+  * @captures     : number of captures
+  * @overhead_min : minimum overhead
+  * @overhead_max : maximum overhead
+  * @overhead_sum : total overhead (every re-arm but the first one of a run)
+  * @wait_sum     : total time from the re-arm to the end of the captures
+  * @drain_sum    : total time draining the memory banks
+  * @callback_sum : total time in the callback
+  * @archive_sum  : total time appending captures to the archive
+  * @clean_sum    : total time cleaning the memory banks
+  * @start_sum    : total time re-arming the monitor
+  *
+  */
+ struct monitorSessionStats_t {
+     unsigned int captures;
+     uint64_t overhead_min;
+     uint64_t overhead_max;
+     uint64_t overhead_sum;
+     uint64_t wait_sum;
+     uint64_t drain_sum;
+     uint64_t callback_sum;
+     uint64_t archive_sum;
+     uint64_t clean_sum;
+     uint64_t start_sum;
+ };
+
+
+ /*
+  * MONITOR session type
+  *
+  * @monitor  : Monitor instance
+  * @owned    : @monitor was opened by the session (and is closed with it)
+  * @timeout  : start timeout (see monitorSessionConfig_t)
+  * @archive  : archive (when @archived is set)
+  * @archived : captures are appended to @archive
+  * @power    : power region filled by the CMS (AU250)
+  * @stats    : statistics of every run of the session
+  *
+  */
+ struct monitorSession_t {
+     monitor_t *monitor;
+     int owned;
+     int timeout;
+     struct monitorArchive_t archive;
+     int archived;
+     monitorpdata_t *power;
+     struct monitorSessionStats_t stats;
+ };
+
+
+ /*
+  * MONITOR session callbacks
+  *
+  * The workload callback is called right after the monitor is armed, to
+  * run whatever triggers the capture (e.g., launching an accelerator); it
+  * can be NULL if captures are triggered from elsewhere. The capture
+  * callback is called with every drained capture. Both return 0 to go on,
+  * or any other value to end the run (once the current capture is done).
+  * On AU250 (no ADC), a capture only ends when the traces memory bank is
+  * full or it is stopped, so it is stopped when the workload callback
+  * returns.
+  *
+  */
+ typedef int (*monitor_session_workload_t)(void *arg);
+ typedef int (*monitor_session_callback_t)(const struct monitorSessionCapture_t *capture, void *arg);
+
+
+ /*
+  * Monitor session open function
+  *
+  * This function sets up a capture session: the Monitor instance (opened
+  * with the staging buffers mapped for the configured capacities, unless
+  * one is given), its masks and voltage reference, and the archive.
+  *
+  *     struct monitorSession_t session;
+  *     struct monitorSessionConfig_t config = {
+  *         .power_capacity = 131072, .traces_capacity = 16384, .mask = 0x1,
+  *     };
+  *     monitor_session_open(&session, NULL, &config);
+  *     monitor_session_run(&session, 1000, run_kernel, process, &ctx);
+  *     monitor_session_close(&session);
+  *
+  * @session : session
+  * @monitor : Monitor instance (NULL to open one, see @config->devname)
+  * @config  : session configuration
+  *
+  * Return : 0 on success, error code otherwise
+  *
+  */
+ int monitor_session_open(struct monitorSession_t *session, monitor_t *monitor, const struct monitorSessionConfig_t *config);
+
+
+ /*
+  * Monitor session run function
+  *
+  * This function runs up to @count captures: re-arm, workload, wait, drain
+  * (zero-copy, see monitor_read_capture()), callback, archive and clean.
+  *
+  * @session  : session
+  * @count    : number of captures
+  * @workload : workload callback (can be NULL)
+  * @callback : capture callback (can be NULL)
+  * @arg      : callbacks argument
+  *
+  * Return : number of captures on success, error code otherwise
+  *
+  */
+ int monitor_session_run(struct monitorSession_t *session, unsigned int count, monitor_session_workload_t workload, monitor_session_callback_t callback, void *arg);
+
+
+ /*
+  * Monitor session statistics function
+  *
+  * This function gets the statistics of every run of a session.
+  *
+  * @session : session
+  * @stats   : statistics
+  *
+  */
+ void monitor_session_stats(const struct monitorSession_t *session, struct monitorSessionStats_t *stats);
+
+
+ /*
+  * Monitor session close function
+  *
+  * This function closes the archive of a session, and its Monitor instance
+  * if the session opened it.
+  *
+  * @session : session
+  *
+  */
+ void monitor_session_close(struct monitorSession_t *session);
+
+
+ #endif /* _MONITOR_SESSION_H_ */
@@ -0,0 +1,1169 @@
+/*
+ * Monitor simulated device API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor simulated device, a
+*               user-space model of the Monitor infrastructure: the
+*               register interface of monitor_control.vhd, the state machine
+*               of monitor.vhd (the acquisition ends when one of the memory
+*               banks is full), the done interrupt and the DMA engine, fed with synthetic power
+*               samples and probe activity, or with recorded captures.
+*
+*/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <fcntl.h>     // open()
+#include <unistd.h>    // read(), close()
+#include <pthread.h>   // pthread_mutex_lock(), pthread_cond_timedwait()
+#include <sys/mman.h>  // mmap(), munmap()
+#include <sys/stat.h>  // fstat()
+
+#include "monitor.h"
+#include "monitor_hw.h"
+#include "monitor_traces.h"
+#include "monitor_power.h"
+#include "monitor_file.h"
+#include "monitor_sim.h"
+#include "monitor_dbg.h"
+
+/*
+* Monitor simulated ADC configuration time (S_CONFIGURATION and S_ADC_BUSY,
+* in cycles)
+*
+*/
+#define MONITOR_SIM_CONFIG_CYCLES (1000)
+
+/*
+* Monitor simulated clear time (S_CLEAR and S_ADC_BUSY, in cycles)
+*
+*/
+#define MONITOR_SIM_CLEAR_CYCLES (4)
+
+/*
+* Monitor simulated acquisition end of an acquisition that only ends when
+* it is stopped (no memory bank gets full)
+*
+*/
+#define MONITOR_SIM_NEVER (UINT64_MAX)
+
+/*
+* Monitor simulated device states (monitor.vhd states)
+*
+* MONITOR_SIM_IDLE    - waiting for a start command (S_IDLE)
+* MONITOR_SIM_BUSY    - resetting the memory banks or configuring the ADC (S_CLEAR, S_CONFIGURATION, S_ADC_BUSY)
+* MONITOR_SIM_RUNNING - acquiring (S_CAPTURE)
+* MONITOR_SIM_DONE    - acquisition finished, until it is cleared with a stop command (S_READ)
+*
+* The busy flag is only low in MONITOR_SIM_IDLE, and the done flag is only
+* high in MONITOR_SIM_DONE.
+*
+*/
+enum monitorSimState_t {MONITOR_SIM_IDLE, MONITOR_SIM_BUSY, MONITOR_SIM_RUNNING, MONITOR_SIM_DONE};
+
+/*
+* Monitor simulated device data sources
+*
+* MONITOR_SIM_SYNTHETIC - synthetic data (see monitorSimConfig_t)
+* MONITOR_SIM_ARCHIVE   - captures of a capture archive
+* MONITOR_SIM_FILE      - capture of a capture file
+* MONITOR_SIM_RAW       - capture of a raw CON.BIN (and SIG.BIN)
+*
+*/
+enum monitorSimSource_t {MONITOR_SIM_SYNTHETIC, MONITOR_SIM_ARCHIVE, MONITOR_SIM_FILE, MONITOR_SIM_RAW};
+
+/*
+* Monitor simulated device
+*
+* @config      : device configuration
+* @regs        : last value read from (or written to) every register
+* @lock        : protects everything below
+* @irq         : done interrupt (signaled when @irq is set)
+* @state       : device state
+* @ctrl        : last value written to REG0 (only the AXI sniffer enable is not a pulse)
+* @mask        : triggering mask (REG3)
+* @axi_mask    : AXI triggering mask (REG2)
+* @vref_mv     : ADC voltage reference
+* @capture_mv  : ADC voltage reference of the acquisition
+* @t_start     : host time of the start of the acquisition (ns)
+* @t_busy      : host time of the end of the busy period (ns)
+* @end         : cycle at which the acquisition ends (MONITOR_SIM_NEVER if it
+*                only ends when stopped, counter value when not running)
+* @horizon     : cycle of the last probe activity of the acquisition
+* @cps         : cycles per power sample
+* @clock_hz    : clock frequency of the acquisition (the recorded one when replaying)
+* @power       : power memory bank
+* @traces      : traces memory bank
+* @times       : cycle of every record of the traces memory bank
+* @ntraces     : records in the traces memory bank
+* @record_size : size of the trace records of the acquisition
+* @npower      : power samples written by the end of the acquisition
+* @generated   : power samples generated for the acquisition
+* @power_src   : power samples served by the DMA engine (@generated elements)
+* @traces_src  : trace records served by the DMA engine (@ntraces elements)
+* @pending     : the done interrupt has not been waited for yet
+* @captures    : number of acquisitions started
+* @rng         : synthetic data generator state
+* @source      : data source
+* @archive     : recorded captures (MONITOR_SIM_ARCHIVE)
+* @file        : recorded capture (MONITOR_SIM_FILE), or raw CON.BIN and
+*                SIG.BIN described by @raw (MONITOR_SIM_RAW)
+* @raw         : header of the raw capture
+* @raw_traces  : raw SIG.BIN mapping
+* @raw_size    : size of @raw_traces
+* @recorded    : number of recorded captures
+* @replayed    : recorded capture of the acquisition
+*
+*/
+struct monitorSim_t {
+    struct monitorSimConfig_t config;
+    uint32_t regs[4];
+    pthread_mutex_t lock;
+    pthread_cond_t irq;
+    enum monitorSimState_t state;
+    uint32_t ctrl;
+    uint32_t mask;
+    uint32_t axi_mask;
+    unsigned int vref_mv;
+    unsigned int capture_mv;
+    uint64_t t_start;
+    uint64_t t_busy;
+    uint64_t end;
+    uint64_t horizon;
+    unsigned long cps;
+    uint64_t clock_hz;
+    monitorpdata_t *power;
+    uint8_t *traces;
+    uint64_t *times;
+    unsigned int ntraces;
+    size_t record_size;
+    unsigned int npower;
+    unsigned int generated;
+    const void *power_src;
+    const void *traces_src;
+    int pending;
+    unsigned int captures;
+    uint32_t rng;
+    enum monitorSimSource_t source;
+    struct monitorArchive_t archive;
+    struct monitorFile_t file;
+    struct monitorFileHeader_t raw;
+    void *raw_traces;
+    size_t raw_size;
+    unsigned int recorded;
+    struct monitorFile_t replayed;
+};
+
+/*
+* Monitor simulated device time function
+*
+* Return : CLOCK_MONOTONIC time in ns
+*
+*/
+static inline uint64_t monitor_sim_now() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+* Monitor simulated device random number function (xorshift32)
+*
+*/
+static inline uint32_t monitor_sim_rand(struct monitorSim_t *sim) {
+    uint32_t x = sim->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->rng = x;
+
+    return x;
+}
+
+/*
+* Monitor simulated device random bit function
+*
+* Return : one of the bits set in @mask (0 if there is none)
+*
+*/
+static uint32_t monitor_sim_rand_bit(struct monitorSim_t *sim, uint32_t mask) {
+    unsigned int n = __builtin_popcount(mask), i;
+
+    if (n == 0) {
+        return 0;
+    }
+    for (i = monitor_sim_rand(sim) % n; i > 0; i--) {
+        mask &= mask - 1;
+    }
+
+    return mask & -mask;
+}
+
+/*
+* Monitor simulated device duration function
+*
+* Return : host time (ns) taken by @cycles simulated cycles
+*
+*/
+static inline uint64_t monitor_sim_ns(const struct monitorSim_t *sim, uint64_t cycles) {
+
+    return (uint64_t)(cycles * 1e9 / ((double)sim->clock_hz * sim->config.speed));
+
+}
+
+/*
+* Monitor simulated device position function
+*
+* Return : cycles acquired by the current (or last) acquisition at host time @now
+*
+*/
+static uint64_t monitor_sim_position(const struct monitorSim_t *sim, uint64_t now) {
+    uint64_t cycles;
+
+    if (sim->state != MONITOR_SIM_RUNNING) {
+        return sim->end;
+    }
+    // As fast as possible: everything the acquisition will ever record is already there
+    if (sim->config.speed == 0) {
+        return sim->end != MONITOR_SIM_NEVER ? sim->end : sim->horizon;
+    }
+    cycles = (uint64_t)((now - sim->t_start) * sim->config.speed * sim->clock_hz / 1e9);
+
+    return cycles < sim->end ? cycles : sim->end;
+}
+
+/*
+* Monitor simulated device traces count function
+*
+* Return : number of trace records written up to cycle @cycles
+*
+*/
+static unsigned int monitor_sim_traces_count(const struct monitorSim_t *sim, uint64_t cycles) {
+    unsigned int lo = 0, hi = sim->ntraces, mid;
+
+    // First record after @cycles
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (sim->times[mid] <= cycles) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*
+* Monitor simulated device power count function
+*
+* Return : number of power samples written up to cycle @cycles
+*
+*/
+static inline unsigned int monitor_sim_power_count(const struct monitorSim_t *sim, uint64_t cycles) {
+
+    return cycles / sim->cps < sim->npower ? cycles / sim->cps : sim->npower;
+
+}
+
+/*
+* Monitor simulated device busy function
+*
+* This function keeps the device busy for @cycles cycles (sim->lock must be held).
+*
+*/
+static void monitor_sim_busy(struct monitorSim_t *sim, uint64_t now, uint64_t cycles) {
+
+    if (sim->config.speed == 0) {
+        sim->state = MONITOR_SIM_IDLE;
+        return;
+    }
+    sim->state = MONITOR_SIM_BUSY;
+    sim->t_busy = now + monitor_sim_ns(sim, cycles);
+
+}
+
+/*
+* Monitor simulated device done function
+*
+* This function ends the acquisition (S_READ), which raises the done
+* interrupt (sim->lock must be held).
+*
+*/
+static void monitor_sim_done(struct monitorSim_t *sim) {
+
+    sim->state = MONITOR_SIM_DONE;
+    sim->pending = 1;
+    pthread_cond_broadcast(&sim->irq);
+
+}
+
+/*
+* Monitor simulated device reset function
+*
+* This function resets the memory bank addresses (S_ADC_BUSY), and keeps
+* the device busy for @cycles cycles (sim->lock must be held).
+*
+*/
+static void monitor_sim_reset(struct monitorSim_t *sim, uint64_t now, uint64_t cycles) {
+
+    sim->ntraces = 0;
+    sim->npower = 0;
+    sim->generated = 0;
+    monitor_sim_busy(sim, now, cycles);
+
+}
+
+/*
+* Monitor simulated device update function
+*
+* This function advances the device to host time @now: it leaves the busy
+* state, and ends the acquisition once its last cycle has been reached
+* (sim->lock must be held).
+*
+*/
+static void monitor_sim_update(struct monitorSim_t *sim, uint64_t now) {
+
+    if (sim->state == MONITOR_SIM_BUSY && now >= sim->t_busy) {
+        sim->state = MONITOR_SIM_IDLE;
+    }
+    if (sim->state == MONITOR_SIM_RUNNING && sim->end != MONITOR_SIM_NEVER && monitor_sim_position(sim, now) >= sim->end) {
+        monitor_sim_done(sim);
+    }
+
+}
+
+/*
+* Monitor simulated device trace record function
+*
+* This function writes a trace record into the traces memory bank.
+*
+*/
+static void monitor_sim_record(struct monitorSim_t *sim, uint64_t cycles, uint32_t probes, uint32_t axi) {
+    struct monitorAxiTrace_t *axitrace;
+    monitortdata_t record;
+
+    if (sim->record_size == sizeof(struct monitorAxiTrace_t)) {
+        axitrace = (struct monitorAxiTrace_t *)sim->traces + sim->ntraces;
+        axitrace->timestamp = (uint32_t)cycles;
+        axitrace->pad = 0;
+        axitrace->axi = axi;
+        axitrace->probes = probes;
+    }
+    else {
+        record = ((monitortdata_t)probes << 32) | (uint32_t)cycles;
+        memcpy(sim->traces + sim->ntraces * sizeof record, &record, sizeof record);
+    }
+    sim->times[sim->ntraces++] = cycles;
+
+}
+
+/*
+* Monitor simulated device start function
+*
+* This function starts an acquisition: the probe activity of the whole
+* acquisition is written into the traces memory bank right away (it is
+* only exposed up to the current cycle), which also tells when the traces
+* memory bank gets full. As in monitor.vhd, the acquisition only ends when
+* a memory bank is full: the power memory bank on Zynq boards, the traces
+* memory bank on Alveo boards (no ADC), where it otherwise runs until it
+* is stopped (sim->lock must be held).
+*
+*/
+static void monitor_sim_start(struct monitorSim_t *sim, uint64_t now) {
+    const struct monitorSimConfig_t *config = &sim->config;
+    uint64_t duration = (uint64_t)config->duration_us * (MONITOR_CLOCK_FREQ / 1000000);
+    uint64_t cycles = 0;
+    uint32_t axi;
+
+    sim->captures++;
+    sim->rng = (config->seed ^ (sim->captures * 0x9e3779b9U)) | 1;
+    sim->record_size = (sim->ctrl & MONITOR_AXI_SNIFFER_ENABLE_IN) ? sizeof(struct monitorAxiTrace_t) : sizeof(monitortdata_t);
+    sim->capture_mv = sim->vref_mv;
+    sim->ntraces = 0;
+    sim->generated = 0;
+
+    #ifdef AU250
+    sim->end = MONITOR_SIM_NEVER;
+    #else
+    sim->end = (uint64_t)config->power_depth * sim->cps;
+    #endif
+
+    // Initial levels: the triggering probes are high while the accelerator runs
+    monitor_sim_record(sim, 0, sim->mask | (monitor_sim_rand(sim) & config->probes), 0);
+
+    // Probe toggles while the accelerator runs (one per record)
+    while (config->probes && config->toggle_cycles && sim->ntraces < config->traces_depth) {
+        cycles += 1 + monitor_sim_rand(sim) % (2 * config->toggle_cycles);
+        if (cycles >= duration || cycles >= sim->end) {
+            break;
+        }
+        axi = (monitor_sim_rand(sim) % 4 == 0) ? monitor_sim_rand_bit(sim, sim->axi_mask) : 0;
+        monitor_sim_record(sim, cycles, monitor_sim_rand_bit(sim, config->probes), axi);
+    }
+
+    // Falling edge of the triggering probes
+    if (sim->mask && duration < sim->end && sim->ntraces < config->traces_depth) {
+        monitor_sim_record(sim, duration, sim->mask, 0);
+    }
+    sim->horizon = sim->times[sim->ntraces - 1] > duration ? sim->times[sim->ntraces - 1] : duration;
+
+    // Done on full traces memory bank
+    if (sim->ntraces == config->traces_depth && sim->times[sim->ntraces - 1] < sim->end) {
+        sim->end = sim->times[sim->ntraces - 1];
+    }
+    sim->npower = (sim->end / sim->cps < config->power_depth) ? sim->end / sim->cps : config->power_depth;
+    sim->power_src = sim->power;
+    sim->traces_src = sim->traces;
+
+    sim->t_start = now;
+    sim->state = MONITOR_SIM_RUNNING;
+    monitor_print_debug("[monitor-sim] acquisition %u | cycles=%llu | traces=%u\n", sim->captures, (unsigned long long)sim->end, sim->ntraces);
+
+}
+
+/*
+* Monitor simulated device map function
+*
+* This function maps a whole file (read-only).
+*
+* Return : 0 on success (@map is NULL for an empty file), error code otherwise
+*
+*/
+static int monitor_sim_map(const char *path, void **map, size_t *size) {
+    struct stat st;
+    int fd, ret = 0;
+
+    *map = NULL;
+    *size = 0;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        monitor_print_error("[monitor-sim] open() %s failed\n", path);
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0) {
+        ret = -errno;
+    }
+    else if (st.st_size > 0) {
+        *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (*map == MAP_FAILED) {
+            *map = NULL;
+            monitor_print_error("[monitor-sim] mmap() %s failed\n", path);
+            ret = -ENOMEM;
+        }
+        else {
+            *size = st.st_size;
+        }
+    }
+    close(fd);
+
+    return ret;
+}
+
+/*
+* Monitor simulated device recorded capture function
+*
+* This function gets recorded capture @n.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_sim_replay_capture(const struct monitorSim_t *sim, unsigned int n, struct monitorFile_t *file) {
+
+    if (sim->source == MONITOR_SIM_ARCHIVE) {
+        return monitor_archive_capture(&sim->archive, n, file);
+    }
+    *file = sim->file;
+
+    return 0;
+}
+
+/*
+* Monitor simulated device replay open function
+*
+* This function maps the recorded captures of sim->config.replay, and grows
+* the memory bank depths to fit the largest one.
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+static int monitor_sim_replay_open(struct monitorSim_t *sim) {
+    struct monitorSimConfig_t *config = &sim->config;
+    struct monitorFile_t file;
+    uint32_t magic = 0, elapsed = 0;
+    size_t trailer = 0;
+    unsigned int i;
+    int fd, ret;
+
+    // File type
+    fd = open(config->replay, O_RDONLY);
+    if (fd < 0) {
+        monitor_print_error("[monitor-sim] open() %s failed\n", config->replay);
+        return -errno;
+    }
+    if (read(fd, &magic, sizeof magic) != sizeof magic) {
+        magic = 0;
+    }
+    close(fd);
+
+    if (magic == MONITOR_ARCHIVE_MAGIC) {
+        ret = monitor_archive_open(config->replay, MONITOR_ARCHIVE_READ, &sim->archive);
+        if (ret < 0) {
+            return ret;
+        }
+        sim->source = MONITOR_SIM_ARCHIVE;
+        sim->recorded = sim->archive.count;
+    }
+    else if (magic == MONITOR_FILE_MAGIC) {
+        ret = monitor_file_open(config->replay, &sim->file);
+        if (ret < 0) {
+            return ret;
+        }
+        sim->source = MONITOR_SIM_FILE;
+        sim->recorded = 1;
+    }
+    else {
+        // Raw CON.BIN (the Zynq demos append the 32-bit elapsed time) and SIG.BIN
+        sim->source = MONITOR_SIM_RAW;
+        ret = monitor_sim_map(config->replay, &sim->file.map, &sim->file.size);
+        if (ret < 0) {
+            return ret;
+        }
+        if (*config->replay_traces) {
+            ret = monitor_sim_map(config->replay_traces, &sim->raw_traces, &sim->raw_size);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        #ifndef AU250
+        trailer = sizeof elapsed;
+        #endif
+        if (sim->file.size < trailer) {
+            monitor_print_error("[monitor-sim] %s is not a valid CON.BIN\n", config->replay);
+            return -EINVAL;
+        }
+        if (trailer) {
+            memcpy(&elapsed, (const char *)sim->file.map + sim->file.size - trailer, trailer);
+        }
+
+        sim->raw.magic = MONITOR_FILE_MAGIC;
+        sim->raw.version = MONITOR_FILE_VERSION;
+        sim->raw.header_size = sizeof sim->raw;
+        sim->raw.counter_bits = 32;
+        sim->raw.trace_size = sizeof(monitortdata_t);
+        sim->raw.clock_hz = MONITOR_CLOCK_FREQ;
+        sim->raw.vref_mv = MONITOR_VREF_MV;
+        sim->raw.elapsed = elapsed;
+        sim->raw.power_count = (sim->file.size - trailer) / sizeof(monitorpdata_t);
+        sim->raw.traces_count = sim->raw_size / sizeof(monitortdata_t);
+        sim->file.header = &sim->raw;
+        sim->file.power = sim->file.map;
+        sim->file.traces = sim->raw_traces;
+        sim->recorded = 1;
+    }
+
+    if (sim->recorded == 0) {
+        monitor_print_error("[monitor-sim] %s has no captures\n", config->replay);
+        return -EINVAL;
+    }
+
+    // Memory banks
+    for (i = 0; i < sim->recorded; i++) {
+        ret = monitor_sim_replay_capture(sim, i, &file);
+        if (ret < 0) {
+            return ret;
+        }
+        if (file.header->power_count > UINT32_MAX || file.header->traces_count > UINT32_MAX) {
+            monitor_print_error("[monitor-sim] capture %u of %s is too large\n", i, config->replay);
+            return -EINVAL;
+        }
+        if (file.header->power_count > config->power_depth) {
+            config->power_depth = file.header->power_count;
+        }
+        if (file.header->traces_count > config->traces_depth) {
+            config->traces_depth = file.header->traces_count;
+        }
+    }
+
+    return 0;
+}
+
+/*
+* Monitor simulated device replay close function
+*
+* This function unmaps the recorded captures.
+*
+*/
+static void monitor_sim_replay_close(struct monitorSim_t *sim) {
+
+    if (sim->source == MONITOR_SIM_ARCHIVE) {
+        monitor_archive_close(&sim->archive);
+    }
+    else if (sim->source == MONITOR_SIM_FILE || sim->source == MONITOR_SIM_RAW) {
+        if (sim->raw_traces) {
+            munmap(sim->raw_traces, sim->raw_size);
+        }
+        monitor_file_close(&sim->file);
+    }
+    sim->source = MONITOR_SIM_SYNTHETIC;
+
+}
+
+/*
+* Monitor simulated device replay start function
+*
+* This function starts an acquisition that replays the next recorded
+* capture: its trace records are served in place, and their timestamps
+* (relative, COUNTER_BITS wide) are unwrapped to tell when every one of
+* them is written. The power samples are spread evenly over the elapsed
+* cycles (sim->lock must be held).
+*
+*/
+static void monitor_sim_replay_start(struct monitorSim_t *sim, uint64_t now) {
+    const struct monitorFileHeader_t *header;
+    const uint8_t *record;
+    uint64_t mask, cycles = 0;
+    uint32_t timestamp, last = 0;
+    unsigned int i;
+
+    sim->captures++;
+    sim->ntraces = 0;
+    sim->npower = 0;
+    sim->generated = 0;
+    sim->end = 0;
+    sim->clock_hz = MONITOR_CLOCK_FREQ;
+
+    if (monitor_sim_replay_capture(sim, (sim->captures - 1) % sim->recorded, &sim->replayed) == 0) {
+        header = sim->replayed.header;
+        // Recorded cycles are replayed at the clock they were acquired with
+        if (header->clock_hz) {
+            sim->clock_hz = header->clock_hz;
+        }
+        mask = header->counter_bits && header->counter_bits < 32 ? (1ULL << header->counter_bits) - 1 : UINT32_MAX;
+
+        // Both record layouts start with the 32-bit timestamp
+        sim->record_size = header->trace_size;
+        sim->ntraces = header->traces_count;
+        record = sim->replayed.traces;
+        for (i = 0; i < sim->ntraces; i++, record += sim->record_size) {
+            memcpy(&timestamp, record, sizeof timestamp);
+            cycles = i ? cycles + ((timestamp - last) & mask) : timestamp & mask;
+            last = timestamp;
+            sim->times[i] = cycles;
+        }
+
+        // CMS power (AU250) does not come from the power memory bank
+        sim->npower = (header->flags & MONITOR_FILE_CMS_POWER) ? 0 : header->power_count;
+        sim->end = header->elapsed > cycles ? header->elapsed : cycles;
+        if (sim->end < sim->npower) {
+            sim->end = sim->npower;
+        }
+    }
+    sim->horizon = sim->end;
+    sim->cps = sim->npower ? sim->end / sim->npower : 1;
+
+    // Unpacked power samples are served in place, packed ones when first read
+    sim->power_src = sim->replayed.power ? (const void *)sim->replayed.power : (const void *)sim->power;
+    sim->generated = sim->replayed.power ? sim->npower : 0;
+    sim->traces_src = sim->replayed.traces;
+
+    sim->t_start = now;
+    sim->state = MONITOR_SIM_RUNNING;
+    monitor_print_debug("[monitor-sim] replay %u/%u | cycles=%llu | power=%u | traces=%u\n", (sim->captures - 1) % sim->recorded + 1, sim->recorded,
+                        (unsigned long long)sim->end, sim->npower, sim->ntraces);
+
+}
+
+/*
+* Monitor simulated device power function
+*
+* This function writes the power samples of the acquisition into the power
+* memory bank (sim->lock must be held). Samples are only generated (or
+* unpacked, when replaying packed samples) when they are first read.
+*
+*/
+static void monitor_sim_power(struct monitorSim_t *sim) {
+    const struct monitorSimConfig_t *config = &sim->config;
+    uint64_t duration = (uint64_t)config->duration_us * (MONITOR_CLOCK_FREQ / 1000000);
+    uint64_t period = (uint64_t)config->period_us * (MONITOR_CLOCK_FREQ / 1000000);
+    unsigned int count = monitor_sim_power_count(sim, sim->end);
+    uint64_t cycles, phase, shape;
+    uint32_t rng = sim->rng;
+    int64_t level;
+    unsigned int i;
+
+    if (sim->source != MONITOR_SIM_SYNTHETIC) {
+        if (sim->generated < sim->npower && sim->replayed.power_packed) {
+            monitor_power_unpack(sim->replayed.power_packed, sim->npower, sim->power);
+            sim->generated = sim->npower;
+        }
+        return;
+    }
+
+    if (period == 0) {
+        period = 1;
+    }
+
+    for (i = sim->generated; i < count; i++) {
+        cycles = (uint64_t)(i + 1) * sim->cps;
+        level = config->baseline;
+
+        // Accelerator power (shape in 1/1024 of the amplitude)
+        if (cycles < duration) {
+            phase = cycles % period;
+            switch (config->waveform) {
+                case MONITOR_SIM_SQUARE:   shape = phase < period / 2 ? 1024 : 0; break;
+                case MONITOR_SIM_TRIANGLE: shape = (phase < period / 2 ? phase : period - phase) * 2048 / period; break;
+                case MONITOR_SIM_SAWTOOTH: shape = phase * 1024 / period; break;
+                default:                   shape = 1024; break;
+            }
+            level += (int64_t)(config->amplitude * shape / 1024);
+        }
+
+        // Uniform noise in [-noise, noise]
+        if (config->noise) {
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            level += (int64_t)(rng % (2 * config->noise + 1)) - config->noise;
+        }
+
+        // ADC codes are relative to the voltage reference
+        level = level * MONITOR_VREF_MV / sim->capture_mv;
+        sim->power[i] = level < 0 ? 0 : (level > MONITOR_ADC_MASK ? MONITOR_ADC_MASK : level);
+    }
+    sim->generated = count > sim->generated ? count : sim->generated;
+
+}
+
+/*
+* Monitor simulated device configuration default function
+*
+* This function fills @config with the default configuration.
+*
+* @config : configuration to be filled
+*
+*/
+void monitor_sim_config_default(struct monitorSimConfig_t *config) {
+
+    memset(config, 0, sizeof *config);
+    config->power_depth = MONITOR_SIM_POWER_DEPTH;
+    config->traces_depth = MONITOR_SIM_TRACES_DEPTH;
+    config->sample_hz = 1000000;
+    config->duration_us = 10000;
+    config->waveform = MONITOR_SIM_SQUARE;
+    config->baseline = 1000;
+    config->amplitude = 600;
+    config->period_us = 1000;
+    config->noise = 8;
+    config->probes = 0xe;
+    config->toggle_cycles = 1000;
+    config->speed = 1.0;
+    config->seed = 1;
+
+}
+
+/*
+* Monitor simulated device configuration parse function
+*
+* This function parses a comma-separated list of <field>=<value> options.
+*
+* @options : options (NULL or empty for none)
+* @config  : configuration to be updated
+*
+* Return : 0 on success, -EINVAL on unknown options or invalid values
+*
+*/
+int monitor_sim_config_parse(const char *options, struct monitorSimConfig_t *config) {
+    char *copy, *option, *value, *end, *saveptr = NULL;
+    unsigned long number;
+    int ret = 0;
+
+    if (!options || !*options) {
+        return 0;
+    }
+    copy = strdup(options);
+    if (!copy) {
+        return -ENOMEM;
+    }
+
+    option = strtok_r(copy, ",", &saveptr);
+    while (option) {
+        value = strchr(option, '=');
+        if (!value) {
+            monitor_print_error("[monitor-sim] option %s has no value\n", option);
+            ret = -EINVAL;
+            break;
+        }
+        *value++ = '\0';
+        number = strtoul(value, &end, 0);
+
+        if (strcmp(option, "waveform") == 0) {
+            if (strcmp(value, "constant") == 0)      config->waveform = MONITOR_SIM_CONSTANT;
+            else if (strcmp(value, "square") == 0)   config->waveform = MONITOR_SIM_SQUARE;
+            else if (strcmp(value, "triangle") == 0) config->waveform = MONITOR_SIM_TRIANGLE;
+            else if (strcmp(value, "sawtooth") == 0) config->waveform = MONITOR_SIM_SAWTOOTH;
+            else ret = -EINVAL;
+        }
+        else if (strcmp(option, "replay") == 0 || strcmp(option, "replay_traces") == 0) {
+            if (strlen(value) >= sizeof config->replay) {
+                ret = -EINVAL;
+            }
+            else {
+                strcpy(option[6] ? config->replay_traces : config->replay, value);
+            }
+        }
+        else if (strcmp(option, "speed") == 0) {
+            config->speed = strtod(value, &end);
+            if (end == value || *end || config->speed < 0) {
+                ret = -EINVAL;
+            }
+        }
+        else if (end == value || *end)                 ret = -EINVAL;
+        else if (strcmp(option, "power_depth") == 0)   config->power_depth = number;
+        else if (strcmp(option, "traces_depth") == 0)  config->traces_depth = number;
+        else if (strcmp(option, "sample_hz") == 0)     config->sample_hz = number;
+        else if (strcmp(option, "duration_us") == 0)   config->duration_us = number;
+        else if (strcmp(option, "baseline") == 0)      config->baseline = number;
+        else if (strcmp(option, "amplitude") == 0)     config->amplitude = number;
+        else if (strcmp(option, "period_us") == 0)     config->period_us = number;
+        else if (strcmp(option, "noise") == 0)         config->noise = number;
+        else if (strcmp(option, "probes") == 0)        config->probes = number;
+        else if (strcmp(option, "toggle_cycles") == 0) config->toggle_cycles = number;
+        else if (strcmp(option, "seed") == 0)          config->seed = number;
+        else {
+            monitor_print_error("[monitor-sim] unknown option %s\n", option);
+            ret = -EINVAL;
+            break;
+        }
+        if (ret) {
+            monitor_print_error("[monitor-sim] invalid value %s for option %s\n", value, option);
+            break;
+        }
+        option = strtok_r(NULL, ",", &saveptr);
+    }
+
+    free(copy);
+    return ret;
+}
+
+/*
+* Monitor simulated device create function
+*
+* This function creates a simulated device, idle and with empty memory banks
+* (and maps the recorded captures to replay, if any).
+*
+* @config : device configuration
+*
+* Return : simulated device on success, NULL otherwise
+*
+*/
+struct monitorSim_t *monitor_sim_create(const struct monitorSimConfig_t *config) {
+    struct monitorSim_t *sim;
+    pthread_condattr_t attr;
+
+    if (config->power_depth == 0 || config->traces_depth == 0 ||
+        config->sample_hz == 0 || config->sample_hz > MONITOR_CLOCK_FREQ || config->speed < 0) {
+        monitor_print_error("[monitor-sim] invalid configuration\n");
+        return NULL;
+    }
+
+    sim = calloc(1, sizeof *sim);
+    if (!sim) {
+        monitor_print_error("[monitor-sim] malloc() failed\n");
+        return NULL;
+    }
+    sim->config = *config;
+    sim->cps = MONITOR_CLOCK_FREQ / config->sample_hz;
+    sim->clock_hz = MONITOR_CLOCK_FREQ;
+    sim->vref_mv = MONITOR_VREF_MV;
+    sim->state = MONITOR_SIM_IDLE;
+    pthread_mutex_init(&sim->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sim->irq, &attr);
+    pthread_condattr_destroy(&attr);
+
+    // Recorded captures
+    if (*config->replay && monitor_sim_replay_open(sim) < 0) {
+        monitor_print_error("[monitor-sim] could not replay %s\n", config->replay);
+        monitor_sim_destroy(sim);
+        return NULL;
+    }
+
+    // Memory banks (traces records are up to 128 bits wide, replayed ones are served in place)
+    sim->power = malloc((size_t)sim->config.power_depth * sizeof(monitorpdata_t));
+    sim->times = malloc((size_t)sim->config.traces_depth * sizeof(uint64_t));
+    if (sim->source == MONITOR_SIM_SYNTHETIC) {
+        sim->traces = malloc((size_t)sim->config.traces_depth * sizeof(struct monitorAxiTrace_t));
+    }
+    if (!sim->power || !sim->times || (sim->source == MONITOR_SIM_SYNTHETIC && !sim->traces)) {
+        monitor_print_error("[monitor-sim] malloc() failed\n");
+        monitor_sim_destroy(sim);
+        return NULL;
+    }
+
+    monitor_print_debug("[monitor-sim] power_depth=%u | traces_depth=%u | speed=%.2f | recorded=%u\n", sim->config.power_depth, sim->config.traces_depth,
+                        config->speed, sim->recorded);
+
+    return sim;
+}
+
+/*
+* Monitor simulated device destroy function
+*
+* This function releases a simulated device.
+*
+* @sim : simulated device
+*
+*/
+void monitor_sim_destroy(struct monitorSim_t *sim) {
+
+    if (!sim) {
+        return;
+    }
+    pthread_mutex_destroy(&sim->lock);
+    pthread_cond_destroy(&sim->irq);
+    monitor_sim_replay_close(sim);
+    free(sim->power);
+    free(sim->traces);
+    free(sim->times);
+    free(sim);
+
+}
+
+/*
+* Monitor simulated device registers function
+*
+* Return : last value read from (or written to) every register, for code
+*          that accesses the register map directly
+*
+*/
+uint32_t *monitor_sim_regs(struct monitorSim_t *sim) {
+
+    return sim->regs;
+
+}
+
+/*
+* Monitor simulated device register read function
+*
+* This function reads a register, as decoded by monitor_control.vhd.
+*
+* @sim : simulated device
+* @reg : register offset (in 32-bit words)
+*
+* Return : register value
+*
+*/
+uint32_t monitor_sim_read(struct monitorSim_t *sim, unsigned int reg) {
+    uint64_t now = monitor_sim_now(), cycles;
+    uint32_t value = 0;
+
+    pthread_mutex_lock(&sim->lock);
+    monitor_sim_update(sim, now);
+    cycles = monitor_sim_position(sim, now);
+    switch (reg) {
+        case MONITOR_REG0:
+            // Replayed captures keep their recorded trace layout
+            if (sim->source != MONITOR_SIM_SYNTHETIC && sim->record_size) {
+                value = (sim->record_size == sizeof(struct monitorAxiTrace_t)) ? MONITOR_AXI_SNIFFER_ENABLE_OUT : 0;
+            }
+            else {
+                value = (sim->ctrl & MONITOR_AXI_SNIFFER_ENABLE_IN) ? MONITOR_AXI_SNIFFER_ENABLE_OUT : 0;
+            }
+            value |= (sim->state == MONITOR_SIM_DONE) ? MONITOR_DONE : 0;
+            value |= (sim->state != MONITOR_SIM_IDLE) ? MONITOR_BUSY : 0;
+            break;
+        case MONITOR_REG1:
+            value = (uint32_t)cycles;
+            break;
+        // Utilization registers hold the last written address
+        case MONITOR_REG2:
+            value = monitor_sim_power_count(sim, cycles) - 1;
+            break;
+        case MONITOR_REG3:
+            value = monitor_sim_traces_count(sim, cycles) - 1;
+            break;
+    }
+    if (reg < 4) {
+        sim->regs[reg] = value;
+    }
+    pthread_mutex_unlock(&sim->lock);
+
+    return value;
+}
+
+/*
+* Monitor simulated device register write function
+*
+* This function writes a register. REG0 bits 0-4 are command pulses and
+* bit 5 enables the AXI sniffer (it is kept until REG0 is written again),
+* REG2 holds the AXI triggering mask and REG3 the triggering mask.
+*
+* Configuration and start commands are only accepted while idle. A stop
+* command clears a finished acquisition (busy for MONITOR_SIM_CLEAR_CYCLES),
+* and discards an acquisition in progress (busy until the ADC is ready
+* again, the done interrupt is not raised). On Alveo boards (no ADC), it
+* ends the acquisition in progress instead, raising the done interrupt.
+*
+* @sim   : simulated device
+* @reg   : register offset (in 32-bit words)
+* @value : value to be written
+*
+*/
+void monitor_sim_write(struct monitorSim_t *sim, unsigned int reg, uint32_t value) {
+    uint64_t now = monitor_sim_now();
+
+    pthread_mutex_lock(&sim->lock);
+    monitor_sim_update(sim, now);
+    switch (reg) {
+        case MONITOR_REG0:
+            sim->ctrl = value;
+            // Configuration requests have priority over start requests
+            if (value & (MONITOR_CONFIG_VREF | MONITOR_CONFIG_2VREF) && sim->state == MONITOR_SIM_IDLE) {
+                sim->vref_mv = (value & MONITOR_CONFIG_2VREF) ? MONITOR_2VREF_MV : MONITOR_VREF_MV;
+                monitor_sim_busy(sim, now, MONITOR_SIM_CONFIG_CYCLES);
+            }
+            else if (value & MONITOR_START && sim->state == MONITOR_SIM_IDLE) {
+                if (sim->source == MONITOR_SIM_SYNTHETIC) {
+                    monitor_sim_start(sim, now);
+                }
+                else {
+                    monitor_sim_replay_start(sim, now);
+                }
+            }
+            if (value & MONITOR_STOP) {
+                if (sim->state == MONITOR_SIM_RUNNING) {
+                    sim->end = monitor_sim_position(sim, now);
+                    #ifdef AU250
+                    monitor_sim_done(sim);
+                    #else
+                    // Discarded (the timestamp counter is kept until cleared)
+                    monitor_sim_reset(sim, now, MONITOR_SIM_CONFIG_CYCLES);
+                    #endif
+                }
+                else if (sim->state == MONITOR_SIM_DONE) {
+                    sim->end = 0;
+                    monitor_sim_reset(sim, now, MONITOR_SIM_CLEAR_CYCLES);
+                }
+            }
+            break;
+        case MONITOR_REG2:
+            sim->axi_mask = value;
+            break;
+        case MONITOR_REG3:
+            sim->mask = value;
+            break;
+    }
+    if (reg < 4) {
+        sim->regs[reg] = value;
+    }
+    monitor_sim_update(sim, now);
+    pthread_mutex_unlock(&sim->lock);
+
+}
+
+/*
+* Monitor simulated device wait function
+*
+* This function waits for the done interrupt (the end of an acquisition
+* that has not been waited for yet), as poll() with POLLIRQ does.
+*
+* @sim : simulated device
+*
+*/
+void monitor_sim_wait(struct monitorSim_t *sim) {
+    struct timespec deadline;
+    uint64_t t_end;
+
+    pthread_mutex_lock(&sim->lock);
+    for (;;) {
+        monitor_sim_update(sim, monitor_sim_now());
+        if (sim->pending) {
+            sim->pending = 0;
+            break;
+        }
+        if (sim->state == MONITOR_SIM_RUNNING && sim->end != MONITOR_SIM_NEVER) {
+            // Sleep until the last cycle (unless stopped before)
+            t_end = sim->t_start + monitor_sim_ns(sim, sim->end);
+            deadline.tv_sec = t_end / 1000000000ULL;
+            deadline.tv_nsec = t_end % 1000000000ULL;
+            pthread_cond_timedwait(&sim->irq, &sim->lock, &deadline);
+        }
+        else {
+            pthread_cond_wait(&sim->irq, &sim->lock);
+        }
+    }
+    pthread_mutex_unlock(&sim->lock);
+
+}
+
+/*
+* Monitor simulated device copy function
+*
+* This function copies @size bytes of a memory bank with @available bytes
+* written into @dst (the rest reads as zero).
+*
+*/
+static inline void monitor_sim_copy(void *dst, size_t size, const void *src, size_t available) {
+
+    if (available > size) {
+        available = size;
+    }
+    if (available) {
+        memcpy(dst, src, available);
+    }
+    memset((char *)dst + available, 0, size - available);
+
+}
+
+/*
+* Monitor simulated device DMA function
+*
+* This function copies the first @size bytes of a memory bank into @dst.
+*
+* @sim     : simulated device
+* @regtype : memory bank type (power or traces)
+* @dst     : destination buffer
+* @size    : number of bytes to be transferred
+*
+* Return : 0 on success, error code otherwise
+*
+*/
+int monitor_sim_dma(struct monitorSim_t *sim, enum monitorregtype_t regtype, void *dst, size_t size) {
+    int ret = 0;
+
+    pthread_mutex_lock(&sim->lock);
+    if (regtype == MONITOR_REG_POWER) {
+        if (size > (size_t)sim->config.power_depth * sizeof(monitorpdata_t)) {
+            monitor_print_error("[monitor-sim] DMA transfer beyond the power memory bank\n");
+            ret = -EINVAL;
+        }
+        else {
+            monitor_sim_power(sim);
+            monitor_sim_copy(dst, size, sim->power_src, (size_t)sim->generated * sizeof(monitorpdata_t));
+        }
+    }
+    else {
+        if (size > (size_t)sim->config.traces_depth * sizeof(struct monitorAxiTrace_t)) {
+            monitor_print_error("[monitor-sim] DMA transfer beyond the traces memory bank\n");
+            ret = -EINVAL;
+        }
+        else {
+            monitor_sim_copy(dst, size, sim->traces_src, sim->ntraces * sim->record_size);
+        }
+    }
+    pthread_mutex_unlock(&sim->lock);
+
+    return ret;
+}
@@ -0,0 +1,197 @@
+/*
+ * Monitor simulated device API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor simulated device API, which
+ *               opens a Monitor instance backed by a user-space model of
+ *               the Monitor infrastructure instead of /dev/monitor (or
+ *               /dev/xdma<N>_user), so that the library and the
+ *               applications built on it can run on any Linux machine,
+ *               either with synthetic data or replaying recorded captures.
+ *
+ */
+
+
+ #ifndef _MONITOR_SIM_H_
+ #define _MONITOR_SIM_H_
+
+ #include <stdint.h> // uint32_t
+ #include <limits.h> // PATH_MAX
+
+ #include "monitor.h"
+
+
+ /*
+  * Simulated device name
+  *
+  * Any devname of the form "sim" or "sim:<options>" (see
+  * monitor_sim_config_parse()) opens a simulated Monitor, e.g.,
+  *
+  *     monitor_t *monitor = monitor_dev_open("sim:duration_us=2000,waveform=square");
+  *
+  * The default instance (monitor_init()) and every monitor_dev_open(NULL)
+  * use the MONITOR_DEVICE environment variable when it is set, so existing
+  * applications can be run against the model without any change:
+  *
+  *     $ MONITOR_DEVICE=sim:speed=0 ./matmul
+  *
+  */
+ #define MONITOR_SIM_DEVICE "sim"
+
+
+ /*
+  * Replay device name
+  *
+  * Any devname of the form "replay:<file>[,<options>]" opens a simulated
+  * Monitor that replays the captures recorded in <file> (see the replay
+  * field of monitorSimConfig_t), with the same options as "sim:", e.g.,
+  *
+  *     $ MONITOR_DEVICE=replay:field.mona,speed=10 ./pipeline
+  *     $ MONITOR_DEVICE=replay:CON.BIN,replay_traces=SIG.BIN,speed=0 ./pipeline
+  *
+  */
+ #define MONITOR_REPLAY_DEVICE "replay"
+
+
+ /*
+  * Default simulated memory bank depths (POWER_DEPTH and TRACES_DEPTH in
+  * monitor_v1_0.vhd)
+  *
+  */
+ #define MONITOR_SIM_POWER_DEPTH  (65536)
+ #define MONITOR_SIM_TRACES_DEPTH (16384)
+
+
+ /*
+  * MONITOR simulated waveform type
+  *
+  * Shape of the power drawn by the simulated accelerator while it runs.
+  *
+  * MONITOR_SIM_CONSTANT - constant power
+  * MONITOR_SIM_SQUARE   - on during the first half of every period
+  * MONITOR_SIM_TRIANGLE - linear rise and fall over every period
+  * MONITOR_SIM_SAWTOOTH - linear rise over every period
+  *
+  */
+ enum monitorSimWaveform_t {MONITOR_SIM_CONSTANT, MONITOR_SIM_SQUARE, MONITOR_SIM_TRIANGLE, MONITOR_SIM_SAWTOOTH};
+
+
+ /*
+  * MONITOR simulated device configuration type
+  *
+  * Every capture models an accelerator that runs for @duration_us from the
+  * monitor start: the probes of the triggering mask (monitor_set_mask())
+  * are high while it runs and fall at the end. The probes of @probes toggle
+  * at random times in between (one trace record per toggle), and the ADC
+  * codes follow @waveform on top of @baseline. As on the hardware
+  * (monitor.vhd), the acquisition only ends, setting the done bit and
+  * raising the done interrupt, when either memory bank is full (i.e., after
+  * @power_depth samples on Zynq boards) or, on Alveo boards, when it is
+  * stopped. A stop command discards an acquisition in progress on Zynq
+  * boards.
+  *
+  * When @replay is set, every capture replays the next capture recorded in
+  * that file instead (wrapping around after the last one): its power
+  * samples (ADC codes, as recorded), trace records and elapsed cycles are
+  * served by the memory banks and registers as the acquisition advances,
+  * and the triggering mask, the voltage reference and the synthetic data
+  * fields are ignored. The file can be a capture archive, a capture file
+  * (see monitor_file.h) or a raw CON.BIN as written by the demos (power
+  * samples followed by the 32-bit elapsed time on Zynq boards), with its
+  * SIG.BIN in @replay_traces. The memory banks grow to fit the largest
+  * recorded capture, and CMS power (AU250) is not replayed.
+  *
+  * The option names of monitor_sim_config_parse() are the field names.
+  *
+  * @power_depth   : power memory bank depth (samples)
+  * @traces_depth  : traces memory bank depth (records)
+  * @sample_hz     : power sampling rate (Hz)
+  * @duration_us   : accelerator run time of every capture (us)
+  * @waveform      : power waveform while the accelerator runs
+  * @baseline      : idle ADC code (with the 2.5V reference)
+  * @amplitude     : ADC code added at the peak of @waveform
+  * @period_us     : period of @waveform (us)
+  * @noise         : maximum noise added to every sample (ADC codes)
+  * @probes        : mask of the probes that toggle while the accelerator runs
+  * @toggle_cycles : mean time between two probe toggles (cycles)
+  * @speed         : simulated time over host time (1.0 for real time,
+  *                  N for N times faster, 0 to finish every capture as soon
+  *                  as it is started)
+  * @seed          : seed of the synthetic data (every capture differs)
+  * @replay        : file with the recorded captures to replay (empty for
+  *                  synthetic data)
+  * @replay_traces : raw SIG.BIN of a raw CON.BIN @replay (empty for none)
+  *
+  */
+ struct monitorSimConfig_t {
+     unsigned int power_depth;
+     unsigned int traces_depth;
+     unsigned long sample_hz;
+     unsigned long duration_us;
+     enum monitorSimWaveform_t waveform;
+     unsigned int baseline;
+     unsigned int amplitude;
+     unsigned long period_us;
+     unsigned int noise;
+     uint32_t probes;
+     unsigned long toggle_cycles;
+     double speed;
+     unsigned int seed;
+     char replay[PATH_MAX];
+     char replay_traces[PATH_MAX];
+ };
+
+
+ /*
+  * Monitor simulated device default configuration function
+  *
+  * This function fills @config with the default configuration: 64Ki power
+  * samples and 16Ki trace records, 1 MHz sampling, a 10 ms square wave
+  * (1 ms period) and 3 toggling probes, in real time.
+  *
+  * @config : configuration to be filled
+  *
+  */
+ void monitor_sim_config_default(struct monitorSimConfig_t *config);
+
+
+ /*
+  * Monitor simulated device configuration parse function
+  *
+  * This function parses a comma-separated list of <field>=<value> options
+  * (see monitorSimConfig_t) into @config, which keeps its previous value in
+  * every field that is not listed. Waveforms are given by name (constant,
+  * square, triangle or sawtooth) and files by path (which cannot contain
+  * commas).
+  *
+  *     struct monitorSimConfig_t config;
+  *     monitor_sim_config_default(&config);
+  *     monitor_sim_config_parse("sample_hz=500000,probes=0xff,speed=10", &config);
+  *
+  * @options : options (NULL or empty for none)
+  * @config  : configuration to be updated
+  *
+  * Return : 0 on success, -EINVAL on unknown options or invalid values
+  *
+  */
+ int monitor_sim_config_parse(const char *options, struct monitorSimConfig_t *config);
+
+
+ /*
+  * Monitor simulated device open function
+  *
+  * This function opens a simulated Monitor instance (see
+  * monitor_dev_open_capacity()). It can be used with the whole
+  * multi-instance API, and closed with monitor_dev_close().
+  *
+  * @config          : simulated device configuration (NULL for the default one)
+  * @power_capacity  : maximum number of power samples to be read (0 to allocate on first read)
+  * @traces_capacity : maximum number of traces samples to be read (0 to allocate on first read)
+  *
+  * Return : Monitor handle on success, NULL otherwise
+  *
+  */
+ monitor_t *monitor_dev_open_sim(const struct monitorSimConfig_t *config, unsigned int power_capacity, unsigned int traces_capacity);
+
+
+ #endif /* _MONITOR_SIM_H_ */
@@ -0,0 +1,831 @@
+/*
+ * Monitor traces API
+*
+* Date        : October 2026
+* Description : This file contains the Monitor traces API, which turns
+*               the raw records drained from the traces memory bank into
+*               data that can be consumed directly by the applications.
+*
+*/
+
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MONITOR_TRACES_NEON
+#endif
+
+#include "monitor.h"
+#include "monitor_traces.h"
+
+#define MONITOR_COUNTER_PERIOD (1ULL << MONITOR_COUNTER_BITS)
+#define MONITOR_COUNTER_MASK   (MONITOR_COUNTER_PERIOD - 1)
+
+/*
+* Monitor elapsed cycles extension function
+*
+* This function extends the (wrapping) elapsed-cycles register to 64 bits,
+* returning the value congruent with @elapsed that is closest to @approx.
+*
+* @elapsed : elapsed cycles register value
+* @approx  : approximate elapsed cycles (e.g., measured by the host)
+*
+* Return : 64-bit elapsed cycles
+*
+*/
+uint64_t monitor_elapsed_extend(uint32_t elapsed, uint64_t approx) {
+    uint64_t value = (approx & ~MONITOR_COUNTER_MASK) | elapsed;
+
+    // Pick the closest candidate among the adjacent counter periods
+    if ((value > approx) && (value - approx > MONITOR_COUNTER_PERIOD / 2) && (value >= MONITOR_COUNTER_PERIOD)) {
+        value -= MONITOR_COUNTER_PERIOD;
+    }
+    else if ((value < approx) && (approx - value > MONITOR_COUNTER_PERIOD / 2)) {
+        value += MONITOR_COUNTER_PERIOD;
+    }
+
+    return value;
+}
+
+/*
+* Monitor traces timestamps function
+*
+* This function reconstructs the 64-bit monotonic timestamps of a capture.
+*
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @elapsed    : 64-bit elapsed cycles of the capture (0 if unknown)
+* @origin     : 64-bit time of the beginning of the capture
+* @timestamps : reconstructed timestamps (@ndata elements)
+*
+* Return : number of counter wraps that could not be placed, -ERANGE if the
+*          records do not fit in @elapsed
+*
+*/
+int monitor_traces_timestamps(const monitortdata_t *traces, unsigned int ndata, uint64_t elapsed, uint64_t origin, uint64_t *timestamps) {
+    uint64_t high = 0;
+    uint32_t prev = 0;
+    uint32_t ts;
+    unsigned int i;
+
+    for (i = 0; i < ndata; i++) {
+        // Timestamp in the lower half of the record
+        ts = (uint32_t)traces[i];
+        if (ts < prev) {
+            high += MONITOR_COUNTER_PERIOD;
+        }
+        prev = ts;
+        timestamps[i] = origin + high + ts;
+    }
+
+    if (!elapsed || !ndata) {
+        return 0;
+    }
+
+    // Anchor: the last event cannot happen after the end of the capture
+    if (high + prev > elapsed) {
+        return -ERANGE;
+    }
+
+    // Full counter periods without any event in between
+    return (elapsed - (high + prev)) >> MONITOR_COUNTER_BITS;
+}
+
+/*
+* Monitor timeline init function
+*
+* This function starts an empty timeline (origin at cycle 0).
+*
+* @timeline : timeline to be initialized
+*
+*/
+void monitor_timeline_init(struct monitorTimeline_t *timeline) {
+
+    timeline->origin = 0;
+    timeline->captures = 0;
+
+}
+
+/*
+* Monitor timeline add function
+*
+* This function reconstructs the timestamps of a capture relative to the
+* timeline origin, and then moves the origin to the end of the capture.
+*
+* @timeline   : timeline
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @elapsed    : 64-bit elapsed cycles of the capture (0 to use the last timestamp)
+* @timestamps : reconstructed timestamps (@ndata elements)
+*
+* Return : number of counter wraps that could not be placed, error code otherwise
+*
+*/
+int monitor_timeline_add(struct monitorTimeline_t *timeline, const monitortdata_t *traces, unsigned int ndata, uint64_t elapsed, uint64_t *timestamps) {
+    int ret;
+
+    ret = monitor_traces_timestamps(traces, ndata, elapsed, timeline->origin, timestamps);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Next capture starts where this one ended
+    if (elapsed) {
+        timeline->origin += elapsed;
+    }
+    else if (ndata) {
+        timeline->origin = timestamps[ndata - 1];
+    }
+    timeline->captures++;
+
+    return ret;
+}
+
+/*
+* Monitor timeline skip function
+*
+* This function moves the timeline origin forward.
+*
+* @timeline : timeline
+* @cycles   : cycles to skip
+*
+*/
+void monitor_timeline_skip(struct monitorTimeline_t *timeline, uint64_t cycles) {
+
+    timeline->origin += cycles;
+
+}
+
+/*
+* Monitor traces unpack function (scalar)
+*
+* This function splits trace records [@first, @ndata) into timestamps and
+* probes arrays, one record at a time.
+*
+*/
+static void monitor_traces_unpack_scalar(const monitortdata_t *traces, unsigned int first, unsigned int ndata, uint32_t *timestamps, uint32_t *probes) {
+    unsigned int i;
+
+    for (i = first; i < ndata; i++) {
+        timestamps[i] = (uint32_t)traces[i];
+        probes[i] = (uint32_t)(traces[i] >> 32);
+    }
+
+}
+
+/*
+* Monitor AXI traces unpack function (scalar)
+*
+* This function splits AXI trace records [@first, @ndata) into timestamps,
+* AXI and probes arrays, one record at a time.
+*
+*/
+static void monitor_traces_unpack_axi_scalar(const struct monitorAxiTrace_t *traces, unsigned int first, unsigned int ndata, uint32_t *timestamps, uint32_t *axi, uint32_t *probes) {
+    unsigned int i;
+
+    for (i = first; i < ndata; i++) {
+        timestamps[i] = traces[i].timestamp;
+        axi[i] = traces[i].axi;
+        probes[i] = traces[i].probes;
+    }
+
+}
+
+#ifdef MONITOR_TRACES_NEON
+/*
+* Monitor traces unpack function (NEON)
+*
+* This function splits 4 records per iteration with a de-interleaving load.
+*
+* Return : number of records processed
+*
+*/
+static unsigned int monitor_traces_unpack_neon(const monitortdata_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *probes) {
+    uint32x4x2_t v;
+    unsigned int i;
+
+    for (i = 0; i + 4 <= ndata; i += 4) {
+        v = vld2q_u32((const uint32_t *)&traces[i]);
+        vst1q_u32(&timestamps[i], v.val[0]);
+        vst1q_u32(&probes[i], v.val[1]);
+    }
+
+    return i;
+}
+
+/*
+* Monitor AXI traces unpack function (NEON)
+*
+* This function splits 4 records per iteration with a de-interleaving load.
+*
+* Return : number of records processed
+*
+*/
+static unsigned int monitor_traces_unpack_axi_neon(const struct monitorAxiTrace_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *axi, uint32_t *probes) {
+    uint32x4x4_t v;
+    unsigned int i;
+
+    for (i = 0; i + 4 <= ndata; i += 4) {
+        v = vld4q_u32((const uint32_t *)&traces[i]);
+        vst1q_u32(&timestamps[i], v.val[0]);
+        vst1q_u32(&axi[i], v.val[2]);
+        vst1q_u32(&probes[i], v.val[3]);
+    }
+
+    return i;
+}
+#endif
+
+/*
+* Monitor traces unpack function
+*
+* This function splits trace records into a timestamps array and a probes
+* array (structure-of-arrays).
+*
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @timestamps : 32-bit timestamps (@ndata elements)
+* @probes     : probes (@ndata elements)
+*
+*/
+void monitor_traces_unpack(const monitortdata_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *probes) {
+    unsigned int done = 0;
+
+    #if defined(MONITOR_TRACES_NEON)
+    done = monitor_traces_unpack_neon(traces, ndata, timestamps, probes);
+    #endif
+
+    // Remaining records (and whole buffer without NEON)
+    monitor_traces_unpack_scalar(traces, done, ndata, timestamps, probes);
+
+}
+
+/*
+* Monitor AXI traces unpack function
+*
+* This function splits AXI trace records into timestamps, AXI and probes arrays.
+*
+* @traces     : raw AXI trace records
+* @ndata      : number of trace records
+* @timestamps : 32-bit timestamps (@ndata elements)
+* @axi        : AXI transactions (@ndata elements)
+* @probes     : probes (@ndata elements)
+*
+*/
+void monitor_traces_unpack_axi(const struct monitorAxiTrace_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *axi, uint32_t *probes) {
+    unsigned int done = 0;
+
+    #if defined(MONITOR_TRACES_NEON)
+    done = monitor_traces_unpack_axi_neon(traces, ndata, timestamps, axi, probes);
+    #endif
+
+    // Remaining records (and whole buffer without NEON)
+    monitor_traces_unpack_axi_scalar(traces, done, ndata, timestamps, axi, probes);
+
+}
+
+/*
+* Monitor traces SIMD extension function
+*
+* This function gets the name of the SIMD extension used by the traces kernels.
+*
+* Return : SIMD extension name
+*
+*/
+const char *monitor_traces_simd() {
+
+    #if defined(MONITOR_TRACES_NEON)
+    return "neon";
+    #else
+    return "scalar";
+    #endif
+
+}
+
+/*
+* Monitor edges emit function
+*
+* This function appends one edge per set bit of @mask (lowest channel first)
+* and updates @levels accordingly.
+*
+* Return : number of edges
+*
+*/
+static inline unsigned int monitor_edges_emit(uint64_t mask, uint64_t timestamp, uint64_t *levels, struct monitorEdge_t *edges) {
+    unsigned int n = 0;
+    unsigned int channel;
+
+    *levels ^= mask;
+    while (mask) {
+        channel = __builtin_ctzll(mask);
+        edges[n].timestamp = timestamp;
+        edges[n].channel = channel;
+        edges[n].rising = (*levels >> channel) & 1;
+        n++;
+        mask &= mask - 1;
+    }
+
+    return n;
+}
+
+/*
+* Monitor traces edges function
+*
+* This function extracts the probe transitions of a capture, in time order.
+*
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+* @levels     : probe levels at the end of the capture (can be NULL)
+* @edges      : extracted edges
+* @nedges     : capacity of @edges
+*
+* Return : number of edges, -ENOSPC if they do not fit in @edges
+*
+*/
+int monitor_traces_edges(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t *levels, struct monitorEdge_t *edges, unsigned int nedges) {
+    uint64_t state, mask;
+    unsigned int i, n = 0;
+
+    if (!ndata) {
+        return 0;
+    }
+
+    // First record holds the initial levels
+    state = traces[0] >> 32;
+
+    for (i = 1; i < ndata; i++) {
+        mask = traces[i] >> 32;
+        if ((unsigned int)__builtin_popcountll(mask) > nedges - n) {
+            return -ENOSPC;
+        }
+        n += monitor_edges_emit(mask, timestamps ? timestamps[i] : (uint32_t)traces[i], &state, &edges[n]);
+    }
+
+    if (levels) {
+        *levels = state;
+    }
+
+    return n;
+}
+
+/*
+* Monitor AXI traces edges function
+*
+* This function extracts the probe and AXI sniffer transitions of a capture.
+*
+* @traces     : raw AXI trace records
+* @ndata      : number of trace records
+* @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+* @levels     : probe and AXI levels at the end of the capture (can be NULL)
+* @edges      : extracted edges
+* @nedges     : capacity of @edges
+*
+* Return : number of edges, -ENOSPC if they do not fit in @edges
+*
+*/
+int monitor_traces_edges_axi(const struct monitorAxiTrace_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t *levels, struct monitorEdge_t *edges, unsigned int nedges) {
+    uint64_t state, mask;
+    unsigned int i, n = 0;
+
+    if (!ndata) {
+        return 0;
+    }
+
+    // First record holds the initial levels
+    state = traces[0].probes | ((uint64_t)traces[0].axi << MONITOR_EDGE_PROBES);
+
+    for (i = 1; i < ndata; i++) {
+        mask = traces[i].probes | ((uint64_t)traces[i].axi << MONITOR_EDGE_PROBES);
+        if ((unsigned int)__builtin_popcountll(mask) > nedges - n) {
+            return -ENOSPC;
+        }
+        n += monitor_edges_emit(mask, timestamps ? timestamps[i] : traces[i].timestamp, &state, &edges[n]);
+    }
+
+    if (levels) {
+        *levels = state;
+    }
+
+    return n;
+}
+
+/*
+* Monitor edges group function
+*
+* This function groups a list of edges per channel (counting sort, so the
+* time order is kept within each channel).
+*
+* @edges   : edges, in time order
+* @nedges  : number of edges
+* @grouped : edges grouped per channel (@nedges elements)
+* @offsets : first edge of every channel (MONITOR_EDGE_CHANNELS + 1 elements)
+*
+*/
+void monitor_edges_group(const struct monitorEdge_t *edges, unsigned int nedges, struct monitorEdge_t *grouped, unsigned int *offsets) {
+    unsigned int next[MONITOR_EDGE_CHANNELS];
+    unsigned int i, c;
+
+    for (c = 0; c <= MONITOR_EDGE_CHANNELS; c++) {
+        offsets[c] = 0;
+    }
+    for (i = 0; i < nedges; i++) {
+        offsets[edges[i].channel + 1]++;
+    }
+    for (c = 0; c < MONITOR_EDGE_CHANNELS; c++) {
+        offsets[c + 1] += offsets[c];
+        next[c] = offsets[c];
+    }
+    for (i = 0; i < nedges; i++) {
+        grouped[next[edges[i].channel]++] = edges[i];
+    }
+
+}
+
+/*
+* Monitor statistics init function
+*
+* This function clears the statistics.
+*
+* @stats : statistics to be initialized
+*
+*/
+void monitor_stats_init(struct monitorStats_t *stats) {
+
+    memset(stats, 0, sizeof *stats);
+
+}
+
+/*
+* Monitor statistics pulse function
+*
+* This function accounts a complete pulse of a probe.
+*
+*/
+static inline void monitor_stats_pulse(struct monitorProbeStats_t *probe, uint64_t width) {
+    unsigned int bucket;
+
+    if (!probe->pulses || width < probe->width_min) {
+        probe->width_min = width;
+    }
+    if (width > probe->width_max) {
+        probe->width_max = width;
+    }
+    probe->width_sum += width;
+    probe->pulses++;
+
+    bucket = width ? 63 - __builtin_clzll(width) : 0;
+    probe->histogram[bucket < MONITOR_STATS_BUCKETS ? bucket : MONITOR_STATS_BUCKETS - 1]++;
+}
+
+/*
+* Monitor statistics add function
+*
+* This function accumulates the probe statistics of a capture in a single
+* pass over its records (only the toggled probes are visited).
+*
+* @stats      : statistics
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+* @end        : time of the end of the capture, or 0 to end at the last record
+*
+* Return : 0 on success, -ERANGE if @end is before the last record (@stats is left untouched)
+*
+*/
+int monitor_stats_add(struct monitorStats_t *stats, const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t end) {
+    uint64_t rise[MONITOR_EDGE_PROBES];
+    uint64_t start, ts, width;
+    uint32_t state, cut, mask, bit;
+    struct monitorProbeStats_t *probe;
+    unsigned int i, c;
+
+    if (!ndata) {
+        return 0;
+    }
+
+    // Check the end of the capture before anything is accumulated
+    ts = timestamps ? timestamps[ndata - 1] : (uint32_t)traces[ndata - 1];
+    if (!end) {
+        end = ts;
+    }
+    else if (end < ts) {
+        return -ERANGE;
+    }
+
+    // First record holds the initial levels (those pulses are cut)
+    start = ts = timestamps ? timestamps[0] : (uint32_t)traces[0];
+    state = cut = traces[0] >> 32;
+    for (c = 0; c < MONITOR_EDGE_PROBES; c++) {
+        rise[c] = start;
+    }
+
+    for (i = 1; i < ndata; i++) {
+        ts = timestamps ? timestamps[i] : (uint32_t)traces[i];
+        mask = traces[i] >> 32;
+        state ^= mask;
+        while (mask) {
+            c = __builtin_ctz(mask);
+            bit = 1U << c;
+            if (state & bit) {
+                rise[c] = ts;
+            }
+            else {
+                width = ts - rise[c];
+                probe = &stats->probe[c];
+                probe->high += width;
+                if (!(cut & bit)) {
+                    monitor_stats_pulse(probe, width);
+                }
+                cut &= ~bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    // Probes that are still high at the end of the capture
+    while (state) {
+        c = __builtin_ctz(state);
+        stats->probe[c].high += end - rise[c];
+        state &= state - 1;
+    }
+
+    stats->cycles += end - start;
+    stats->captures++;
+
+    for (c = 0; c < MONITOR_EDGE_PROBES; c++) {
+        probe = &stats->probe[c];
+        probe->duty = stats->cycles ? (double)probe->high / stats->cycles : 0.0;
+        probe->width_mean = probe->pulses ? (double)probe->width_sum / probe->pulses : 0.0;
+    }
+
+    return 0;
+}
+
+/*
+* Monitor level intervals function
+*
+* This function finds the intervals of a capture in which a probe is at a
+* given level, in time order.
+*
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+* @end        : time of the end of the capture (0 to end at the last record)
+* @probe      : probe (0..31)
+* @level      : probe level (0 or 1)
+* @intervals  : intervals found
+* @nintervals : capacity of @intervals
+*
+* Return : number of intervals, -EINVAL on invalid probe, -ENOSPC if they
+*          do not fit in @intervals
+*
+*/
+int monitor_intervals_level(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t end, unsigned int probe, int level, struct monitorInterval_t *intervals, unsigned int nintervals) {
+    uint64_t ts, start;
+    unsigned int i, n = 0;
+    int open;
+
+    if (probe >= MONITOR_EDGE_PROBES) {
+        return -EINVAL;
+    }
+    if (!ndata) {
+        return 0;
+    }
+
+    // First record holds the initial levels
+    start = ts = timestamps ? timestamps[0] : (uint32_t)traces[0];
+    open = ((traces[0] >> (32 + probe)) & 1) == (level != 0);
+
+    for (i = 1; i < ndata; i++) {
+        if (!((traces[i] >> (32 + probe)) & 1)) {
+            continue;
+        }
+        ts = timestamps ? timestamps[i] : (uint32_t)traces[i];
+        if (open) {
+            if (n == nintervals) {
+                return -ENOSPC;
+            }
+            intervals[n].start = start;
+            intervals[n].end = ts;
+            n++;
+        }
+        else {
+            start = ts;
+        }
+        open = !open;
+    }
+
+    if (open) {
+        if (n == nintervals) {
+            return -ENOSPC;
+        }
+        if (!end) {
+            end = timestamps ? timestamps[ndata - 1] : (uint32_t)traces[ndata - 1];
+        }
+        intervals[n].start = start;
+        intervals[n].end = end > start ? end : start;
+        n++;
+    }
+
+    return n;
+}
+
+/*
+* Monitor edge intervals function
+*
+* This function finds the intervals of a capture that go from an edge of a
+* probe to the next edge of another (or the same) probe, in time order.
+*
+* @traces       : raw trace records
+* @ndata        : number of trace records
+* @timestamps   : 64-bit timestamps, or NULL to use the 32-bit ones
+* @start_probe  : probe (0..31) that opens an interval
+* @start_rising : 1 to open on a rising edge, 0 on a falling edge
+* @end_probe    : probe (0..31) that closes an interval
+* @end_rising   : 1 to close on a rising edge, 0 on a falling edge
+* @intervals    : intervals found
+* @nintervals   : capacity of @intervals
+*
+* Return : number of intervals, -EINVAL on invalid probes, -ENOSPC if they
+*          do not fit in @intervals
+*
+*/
+int monitor_intervals_edges(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, unsigned int start_probe, int start_rising, unsigned int end_probe, int end_rising, struct monitorInterval_t *intervals, unsigned int nintervals) {
+    uint32_t state, mask;
+    uint64_t ts, start = 0;
+    unsigned int i, n = 0;
+    int open = 0;
+
+    if (start_probe >= MONITOR_EDGE_PROBES || end_probe >= MONITOR_EDGE_PROBES) {
+        return -EINVAL;
+    }
+    if (!ndata) {
+        return 0;
+    }
+
+    // First record holds the initial levels
+    state = traces[0] >> 32;
+
+    for (i = 1; i < ndata; i++) {
+        mask = traces[i] >> 32;
+        if (!mask) {
+            continue;
+        }
+        state ^= mask;
+        ts = timestamps ? timestamps[i] : (uint32_t)traces[i];
+
+        // Close first, so that an interval can start where the previous one ends
+        if (open && ((mask >> end_probe) & 1) && ((state >> end_probe) & 1) == (end_rising != 0)) {
+            if (n == nintervals) {
+                return -ENOSPC;
+            }
+            intervals[n].start = start;
+            intervals[n].end = ts;
+            n++;
+            open = 0;
+        }
+        else if (!open && ((mask >> start_probe) & 1) && ((state >> start_probe) & 1) == (start_rising != 0)) {
+            start = ts;
+            open = 1;
+        }
+    }
+
+    return n;
+}
+
+/*
+* Monitor invocations function
+*
+* This function builds the table of accelerator invocations of a capture,
+* for several start/end probe pairs at once, in a single pass over its
+* records (records that do not toggle any of the probes are skipped).
+*
+* @traces       : raw trace records
+* @ndata        : number of trace records
+* @timestamps   : 64-bit timestamps, or NULL to use the 32-bit ones
+* @probes       : start/end probes of every accelerator
+* @nprobes      : number of probe pairs (up to MONITOR_EDGE_PROBES)
+* @invocations  : invocations found
+* @ninvocations : capacity of @invocations
+*
+* Return : number of invocations, -EINVAL on invalid probes, -ENOSPC if
+*          they do not fit in @invocations
+*
+*/
+int monitor_invocations(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, const struct monitorInvocationProbes_t *probes, unsigned int nprobes,
+                        struct monitorInvocation_t *invocations, unsigned int ninvocations) {
+    uint64_t start[MONITOR_EDGE_PROBES];
+    uint32_t state, mask, watched = 0, running = 0;
+    const struct monitorInvocationProbes_t *pair;
+    struct monitorInvocation_t *inv;
+    unsigned int i, p, n = 0;
+    uint64_t ts;
+
+    if (nprobes > MONITOR_EDGE_PROBES) {
+        return -EINVAL;
+    }
+    for (p = 0; p < nprobes; p++) {
+        if (probes[p].start_probe >= MONITOR_EDGE_PROBES || probes[p].end_probe >= MONITOR_EDGE_PROBES) {
+            return -EINVAL;
+        }
+        watched |= (1U << probes[p].start_probe) | (1U << probes[p].end_probe);
+    }
+    if (!ndata) {
+        return 0;
+    }
+
+    // First record holds the initial levels
+    state = traces[0] >> 32;
+
+    for (i = 1; i < ndata; i++) {
+        mask = traces[i] >> 32;
+        state ^= mask;
+        if (!(mask & watched)) {
+            continue;
+        }
+        ts = timestamps ? timestamps[i] : (uint32_t)traces[i];
+
+        for (p = 0; p < nprobes; p++) {
+            pair = &probes[p];
+            // End first, so that an invocation can start where the previous one ends
+            if ((running >> p) & 1) {
+                if (((mask >> pair->end_probe) & 1) && ((state >> pair->end_probe) & 1) == (pair->end_rising != 0)) {
+                    if (n == ninvocations) {
+                        return -ENOSPC;
+                    }
+                    inv = &invocations[n++];
+                    inv->start = start[p];
+                    inv->end = ts;
+                    inv->duration = ts - start[p];
+                    inv->probes = p;
+                    inv->energy = 0.0;
+                    inv->power_avg = 0.0;
+                    inv->power_peak = 0;
+                    running &= ~(1U << p);
+                }
+            }
+            else if (((mask >> pair->start_probe) & 1) && ((state >> pair->start_probe) & 1) == (pair->start_rising != 0)) {
+                start[p] = ts;
+                running |= 1U << p;
+            }
+        }
+    }
+
+    return n;
+}
+
+/*
+* Monitor traces lower bound function
+*
+* This function finds the first record whose timestamp is not before @time.
+*
+*/
+static unsigned int monitor_traces_lower_bound(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t time) {
+    unsigned int lo = 0, hi = ndata, mid;
+    uint64_t ts;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        ts = timestamps ? timestamps[mid] : (uint32_t)traces[mid];
+        if (ts < time) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*
+* Monitor traces range function
+*
+* This function finds the trace records of the time window [@start, @end)
+* with a binary search.
+*
+* @traces     : raw trace records
+* @ndata      : number of trace records
+* @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+* @start      : first cycle of the window
+* @end        : first cycle after the window
+* @first      : first record in the window
+*
+* Return : number of records in the window
+*
+*/
+unsigned int monitor_traces_range(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t start, uint64_t end, unsigned int *first) {
+    unsigned int last;
+
+    *first = monitor_traces_lower_bound(traces, ndata, timestamps, start);
+    if (end <= start) {
+        return 0;
+    }
+    last = monitor_traces_lower_bound(traces, ndata, timestamps, end);
+
+    return last - *first;
+}
@@ -0,0 +1,518 @@
+/*
+ * Monitor traces API
+ *
+ * Date        : October 2026
+ * Description : This file contains the Monitor traces API, which turns
+ *               the raw records drained from the traces memory bank into
+ *               data that can be consumed directly by the applications.
+ *
+ */
+
+
+ #ifndef _MONITOR_TRACES_H_
+ #define _MONITOR_TRACES_H_
+
+ #include <stdint.h> // uint64_t
+
+ #include "monitor.h"
+
+
+ /*
+  * Width of the hardware timestamp counter (COUNTER_BITS in monitor.vhd)
+  *
+  */
+ #define MONITOR_COUNTER_BITS (32)
+
+
+ /*
+  * MONITOR AXI trace type
+  *
+  * Layout of the 128-bit records stored in the traces memory bank when the
+  * AXI sniffer is enabled (read them as an array of this type).
+  *
+  */
+ struct monitorAxiTrace_t {
+     uint32_t timestamp;
+     uint32_t pad;
+     uint32_t axi;
+     uint32_t probes;
+ };
+
+
+ /*
+  * Edge channels: probes 0..31, then AXI sniffer bits 0..31
+  *
+  */
+ #define MONITOR_EDGE_PROBES   (32)
+ #define MONITOR_EDGE_CHANNELS (64)
+ #define MONITOR_EDGE_AXI(bit) (MONITOR_EDGE_PROBES + (bit))
+
+
+ /*
+  * MONITOR edge type
+  *
+  * @timestamp : time of the transition (cycles)
+  * @channel   : probe (0..31) or AXI sniffer bit (MONITOR_EDGE_AXI(0..31))
+  * @rising    : 1 for a rising edge, 0 for a falling edge
+  *
+  */
+ struct monitorEdge_t {
+     uint64_t timestamp;
+     uint8_t channel;
+     uint8_t rising;
+ };
+
+
+ /*
+  * MONITOR interval type
+  *
+  * @start : first cycle of the interval
+  * @end   : first cycle after the interval
+  *
+  */
+ struct monitorInterval_t {
+     uint64_t start;
+     uint64_t end;
+ };
+
+
+ /*
+  * MONITOR invocation probes type
+  *
+  * Probes that delimit the invocations of an accelerator, e.g., a start
+  * pulse on one probe and a done pulse on another one.
+  *
+  * @start_probe  : probe (0..31) that starts an invocation
+  * @start_rising : 1 to start on a rising edge, 0 on a falling edge
+  * @end_probe    : probe (0..31) that ends an invocation
+  * @end_rising   : 1 to end on a rising edge, 0 on a falling edge
+  *
+  */
+ struct monitorInvocationProbes_t {
+     unsigned int start_probe;
+     int start_rising;
+     unsigned int end_probe;
+     int end_rising;
+ };
+
+
+ /*
+  * MONITOR invocation type
+  *
+  * @start      : first cycle of the invocation
+  * @end        : first cycle after the invocation
+  * @duration   : @end - @start (cycles)
+  * @probes     : index of the probes (monitorInvocationProbes_t) that
+  *               delimit the invocation
+  * @energy     : energy (in mJ, see monitor_invocations_energy())
+  * @power_avg  : average power (in mW)
+  * @power_peak : peak power (in mW)
+  *
+  */
+ struct monitorInvocation_t {
+     uint64_t start;
+     uint64_t end;
+     uint64_t duration;
+     unsigned int probes;
+     double energy;
+     double power_avg;
+     uint32_t power_peak;
+ };
+
+
+ /*
+  * Number of buckets of the pulse-width histograms (bucket b counts widths
+  * in [2^b, 2^(b+1)) cycles, the last one also counts the wider ones)
+  *
+  */
+ #define MONITOR_STATS_BUCKETS (32)
+
+
+ /*
+  * MONITOR probe statistics type
+  *
+  * A pulse is a high level between a rising and a falling edge. Pulses cut
+  * by the beginning or the end of a capture add to @high, but they are not
+  * counted as pulses.
+  *
+  * @high       : cycles at high level
+  * @duty       : @high over the observed cycles
+  * @pulses     : number of pulses
+  * @width_min  : minimum pulse width (cycles)
+  * @width_max  : maximum pulse width (cycles)
+  * @width_sum  : sum of the pulse widths (cycles)
+  * @width_mean : mean pulse width (cycles)
+  * @histogram  : pulse-width histogram (log2 buckets)
+  *
+  */
+ struct monitorProbeStats_t {
+     uint64_t high;
+     double duty;
+     unsigned int pulses;
+     uint64_t width_min;
+     uint64_t width_max;
+     uint64_t width_sum;
+     double width_mean;
+     unsigned int histogram[MONITOR_STATS_BUCKETS];
+ };
+
+
+ /*
+  * MONITOR statistics type
+  *
+  * Per-probe activity statistics, accumulated over one or more captures.
+  *
+  *     struct monitorStats_t stats;
+  *     monitor_stats_init(&stats);
+  *     ...
+  *     monitor_read_traces(ndata);
+  *     monitor_stats_add(&stats, traces, ndata, NULL, monitor_get_elapsed());
+  *     printf("%f\n", stats.probe[3].duty);
+  *
+  * @cycles   : observed cycles
+  * @captures : number of captures added so far
+  * @probe    : statistics of every probe
+  *
+  */
+ struct monitorStats_t {
+     uint64_t cycles;
+     unsigned int captures;
+     struct monitorProbeStats_t probe[MONITOR_EDGE_PROBES];
+ };
+
+
+ /*
+  * MONITOR timeline type
+  *
+  * Keeps the 64-bit time origin of a sequence of acquisitions, so that the
+  * timestamps of every capture in a session are placed one after the other
+  * (the hardware counter is cleared at the beginning of each capture).
+  *
+  *     struct monitorTimeline_t timeline;
+  *     monitor_timeline_init(&timeline);
+  *     for (...) {
+  *         ...
+  *         monitor_timeline_add(&timeline, traces, ndata, monitor_get_elapsed(), timestamps);
+  *     }
+  *
+  * @origin   : 64-bit time (in cycles) of the beginning of the next capture
+  * @captures : number of captures added so far
+  *
+  */
+ struct monitorTimeline_t {
+     uint64_t origin;
+     unsigned int captures;
+ };
+
+
+ /*
+  * Monitor elapsed cycles extension function
+  *
+  * This function extends the (wrapping) elapsed-cycles register to 64 bits,
+  * returning the value congruent with @elapsed that is closest to @approx.
+  *
+  * @elapsed : elapsed cycles register value
+  * @approx  : approximate elapsed cycles (e.g., measured by the host)
+  *
+  * Return : 64-bit elapsed cycles
+  *
+  */
+ uint64_t monitor_elapsed_extend(uint32_t elapsed, uint64_t approx);
+
+
+ /*
+  * Monitor traces timestamps function
+  *
+  * This function reconstructs the 64-bit monotonic timestamps of a capture.
+  * A counter wrap is detected whenever a timestamp is lower than the
+  * previous one. If the 64-bit elapsed cycles of the capture are known (see
+  * monitor_get_elapsed()), they are used as an anchor to find out whether
+  * some gap between consecutive events spanned more than a full counter
+  * period (which cannot be detected from the records themselves).
+  *
+  * @traces     : raw trace records
+  * @ndata      : number of valid trace records (see monitorStatus_t)
+  * @elapsed    : 64-bit elapsed cycles of the capture (0 if unknown)
+  * @origin     : 64-bit time of the beginning of the capture
+  * @timestamps : reconstructed timestamps (@ndata elements)
+  *
+  * Return : number of counter wraps that could not be placed (0 if every
+  *          timestamp is exact), -ERANGE if the records do not fit in @elapsed
+  *
+  */
+ int monitor_traces_timestamps(const monitortdata_t *traces, unsigned int ndata, uint64_t elapsed, uint64_t origin, uint64_t *timestamps);
+
+
+ /*
+  * Monitor timeline init function
+  *
+  * This function starts an empty timeline (origin at cycle 0).
+  *
+  * @timeline : timeline to be initialized
+  *
+  */
+ void monitor_timeline_init(struct monitorTimeline_t *timeline);
+
+
+ /*
+  * Monitor timeline add function
+  *
+  * This function reconstructs the timestamps of a capture relative to the
+  * timeline origin (see monitor_traces_timestamps()), and then moves the
+  * origin to the end of the capture.
+  *
+  * @timeline   : timeline
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @elapsed    : 64-bit elapsed cycles of the capture (0 to use the last timestamp)
+  * @timestamps : reconstructed timestamps (@ndata elements)
+  *
+  * Return : number of counter wraps that could not be placed, error code otherwise
+  *
+  */
+ int monitor_timeline_add(struct monitorTimeline_t *timeline, const monitortdata_t *traces, unsigned int ndata, uint64_t elapsed, uint64_t *timestamps);
+
+
+ /*
+  * Monitor timeline skip function
+  *
+  * This function moves the timeline origin forward, e.g., to account for
+  * the (host-measured) idle time between two captures.
+  *
+  * @timeline : timeline
+  * @cycles   : cycles to skip
+  *
+  */
+ void monitor_timeline_skip(struct monitorTimeline_t *timeline, uint64_t cycles);
+
+
+ /*
+  * Monitor traces unpack function
+  *
+  * This function splits trace records into a timestamps array and a probes
+  * array (structure-of-arrays), using NEON when available (elsewhere, the
+  * plain loop is left to the compiler, which vectorizes it at -O3).
+  *
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @timestamps : 32-bit timestamps (@ndata elements)
+  * @probes     : probes (@ndata elements)
+  *
+  */
+ void monitor_traces_unpack(const monitortdata_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *probes);
+
+
+ /*
+  * Monitor AXI traces unpack function
+  *
+  * This function splits AXI trace records into timestamps, AXI and probes
+  * arrays (see monitor_traces_unpack()).
+  *
+  * @traces     : raw AXI trace records
+  * @ndata      : number of trace records
+  * @timestamps : 32-bit timestamps (@ndata elements)
+  * @axi        : AXI transactions (@ndata elements)
+  * @probes     : probes (@ndata elements)
+  *
+  */
+ void monitor_traces_unpack_axi(const struct monitorAxiTrace_t *traces, unsigned int ndata, uint32_t *timestamps, uint32_t *axi, uint32_t *probes);
+
+
+ /*
+  * Monitor traces SIMD extension function
+  *
+  * This function gets the name of the SIMD extension used by the traces
+  * kernels on this machine ("neon" or "scalar").
+  *
+  * Return : SIMD extension name
+  *
+  */
+ const char *monitor_traces_simd();
+
+
+ /*
+  * Monitor traces edges function
+  *
+  * This function extracts the probe transitions of a capture, in time order.
+  * The first record holds the initial levels, and every other record holds
+  * the mask of probes that toggled, so the cost depends on the number of
+  * transitions rather than on the number of records times the probes.
+  *
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @timestamps : 64-bit timestamps (see monitor_traces_timestamps()), or NULL
+  *               to use the 32-bit timestamps of the records
+  * @levels     : probe levels at the end of the capture (can be NULL)
+  * @edges      : extracted edges
+  * @nedges     : capacity of @edges
+  *
+  * Return : number of edges, -ENOSPC if they do not fit in @edges
+  *
+  */
+ int monitor_traces_edges(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t *levels, struct monitorEdge_t *edges, unsigned int nedges);
+
+
+ /*
+  * Monitor AXI traces edges function
+  *
+  * This function extracts the probe and AXI sniffer transitions of a capture
+  * (see monitor_traces_edges()). The AXI bits are MONITOR_EDGE_AXI(n) in
+  * the edges and bits 32..63 in @levels.
+  *
+  * @traces     : raw AXI trace records
+  * @ndata      : number of trace records
+  * @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+  * @levels     : probe and AXI levels at the end of the capture (can be NULL)
+  * @edges      : extracted edges
+  * @nedges     : capacity of @edges
+  *
+  * Return : number of edges, -ENOSPC if they do not fit in @edges
+  *
+  */
+ int monitor_traces_edges_axi(const struct monitorAxiTrace_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t *levels, struct monitorEdge_t *edges, unsigned int nedges);
+
+
+ /*
+  * Monitor edges group function
+  *
+  * This function groups a list of edges per channel, keeping them in time
+  * order within each channel. The edges of channel c are then
+  * @grouped[@offsets[c]] to @grouped[@offsets[c + 1] - 1].
+  *
+  * @edges   : edges, in time order
+  * @nedges  : number of edges
+  * @grouped : edges grouped per channel (@nedges elements)
+  * @offsets : first edge of every channel (MONITOR_EDGE_CHANNELS + 1 elements)
+  *
+  */
+ void monitor_edges_group(const struct monitorEdge_t *edges, unsigned int nedges, struct monitorEdge_t *grouped, unsigned int *offsets);
+
+
+ /*
+  * Monitor statistics init function
+  *
+  * This function clears the statistics.
+  *
+  * @stats : statistics to be initialized
+  *
+  */
+ void monitor_stats_init(struct monitorStats_t *stats);
+
+
+ /*
+  * Monitor statistics add function
+  *
+  * This function accumulates the probe statistics of a capture in a single
+  * pass over its records.
+  *
+  * @stats      : statistics
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @timestamps : 64-bit timestamps (see monitor_traces_timestamps()), or NULL
+  *               to use the 32-bit timestamps of the records
+  * @end        : time of the end of the capture in the same time base as the
+  *               timestamps (e.g., monitor_get_elapsed() for the 32-bit
+  *               ones), or 0 to end at the last record
+  *
+  * Return : 0 on success, -ERANGE if @end is before the last record (@stats is left untouched)
+  *
+  */
+ int monitor_stats_add(struct monitorStats_t *stats, const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t end);
+
+
+ /*
+  * Monitor level intervals function
+  *
+  * This function finds the intervals of a capture in which a probe is at a
+  * given level (e.g., "while probe 0 is high"), in time order.
+  *
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+  * @end        : time of the end of the capture (0 to end at the last record)
+  * @probe      : probe (0..31)
+  * @level      : probe level (0 or 1)
+  * @intervals  : intervals found
+  * @nintervals : capacity of @intervals
+  *
+  * Return : number of intervals, -EINVAL on invalid probe, -ENOSPC if they
+  *          do not fit in @intervals
+  *
+  */
+ int monitor_intervals_level(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t end, unsigned int probe, int level, struct monitorInterval_t *intervals, unsigned int nintervals);
+
+
+ /*
+  * Monitor edge intervals function
+  *
+  * This function finds the intervals of a capture that go from an edge of a
+  * probe to the next edge of another (or the same) probe, e.g., "between the
+  * rising edge of probe 2 and the falling edge of probe 3", in time order.
+  * Start edges found while an interval is open are ignored, and an interval
+  * still open at the end of the capture is discarded.
+  *
+  * @traces       : raw trace records
+  * @ndata        : number of trace records
+  * @timestamps   : 64-bit timestamps, or NULL to use the 32-bit ones
+  * @start_probe  : probe (0..31) that opens an interval
+  * @start_rising : 1 to open on a rising edge, 0 on a falling edge
+  * @end_probe    : probe (0..31) that closes an interval
+  * @end_rising   : 1 to close on a rising edge, 0 on a falling edge
+  * @intervals    : intervals found
+  * @nintervals   : capacity of @intervals
+  *
+  * Return : number of intervals, -EINVAL on invalid probes, -ENOSPC if they
+  *          do not fit in @intervals
+  *
+  */
+ int monitor_intervals_edges(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, unsigned int start_probe, int start_rising, unsigned int end_probe, int end_rising, struct monitorInterval_t *intervals, unsigned int nintervals);
+
+
+ /*
+  * Monitor invocations function
+  *
+  * This function builds the table of accelerator invocations of a capture,
+  * for several start/end probe pairs at once, in a single pass over its
+  * records. Invocations are stored in order of completion. For every pair,
+  * start edges found during an invocation are ignored, and an invocation
+  * still running at the end of the capture is discarded (see
+  * monitor_intervals_edges()). The energy fields are cleared, use
+  * monitor_invocations_energy() to fill them in.
+  *
+  * @traces       : raw trace records
+  * @ndata        : number of trace records
+  * @timestamps   : 64-bit timestamps, or NULL to use the 32-bit ones
+  * @probes       : start/end probes of every accelerator
+  * @nprobes      : number of probe pairs (up to MONITOR_EDGE_PROBES)
+  * @invocations  : invocations found
+  * @ninvocations : capacity of @invocations
+  *
+  * Return : number of invocations, -EINVAL on invalid probes, -ENOSPC if
+  *          they do not fit in @invocations
+  *
+  */
+ int monitor_invocations(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, const struct monitorInvocationProbes_t *probes, unsigned int nprobes,
+                         struct monitorInvocation_t *invocations, unsigned int ninvocations);
+
+
+ /*
+  * Monitor traces range function
+  *
+  * This function finds the trace records of the time window [@start, @end)
+  * with a binary search. The 32-bit timestamps are only sorted if the
+  * counter did not wrap during the capture, use the 64-bit ones otherwise.
+  *
+  * @traces     : raw trace records
+  * @ndata      : number of trace records
+  * @timestamps : 64-bit timestamps, or NULL to use the 32-bit ones
+  * @start      : first cycle of the window
+  * @end        : first cycle after the window
+  * @first      : first record in the window
+  *
+  * Return : number of records in the window
+  *
+  */
+ unsigned int monitor_traces_range(const monitortdata_t *traces, unsigned int ndata, const uint64_t *timestamps, uint64_t start, uint64_t end, unsigned int *first);
+
+
+ #endif /* _MONITOR_TRACES_H_ */
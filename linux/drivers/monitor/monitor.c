@@ -40,9 +40,13 @@
 #include <linux/ioport.h>
 #include <linux/completion.h>
 #include <linux/version.h>
+#include <linux/idr.h>
 
 #include "monitor.h"
 #define DRIVER_NAME "monitor"
+#define MONITOR_DMA_MAX_BATCH 2
+#define MONITOR_MAX_DEVICES 8
+#define MONITOR_DMA_CLOSE_TIMEOUT_MS 1000
 
 #define dev_info(...)
 #define pr_info(...)
@@ -56,11 +60,13 @@ MODULE_LICENSE("GPL");
 struct monitor_hw {
     void __iomem *regs;        		// Hardware registers in Monitor
     uint32_t done_bit;     			// Current done bit value
-    uint32_t dma_irq_flag;
+    uint32_t dma_irq_flag;          // Last DMA transfer finished (kept until the next one is submitted)
+    uint32_t dma_busy;              // DMA transfer in flight
 };
 
 // Custom monitor device data structure
 struct monitor_device {
+    int id;
     dev_t devt;
     struct cdev cdev;
     struct device *dev;
@@ -82,13 +88,14 @@ struct monitor_vm_list {
     void *addr_ker;
     dma_addr_t addr_phy;
     size_t size;
-    pid_t pid;
+    pid_t pid;                      // Owner process (thread group id, shared by all its threads)
     struct list_head list;
 };
 
-// Char device parameters
+// Char device parameters (one minor per Monitor instance in the device tree)
 static dev_t devt;
 static struct class *monitor_class;
+static DEFINE_IDA(monitor_ida);
 
 
 /* IRQ MANAGEMENT */
@@ -122,63 +129,117 @@ static irqreturn_t monitor_isr(unsigned int irq, void *data) {
 // DMA asynchronous callback function
 static void monitor_dma_callback(void *data) {
 	struct monitor_device *monitor_dev = data;
+	unsigned long flags;
 	dev_info(monitor_dev->dev,"[ ] monitor_dma_callback()");
-	// Inform poll() queue
+	spin_lock_irqsave(&monitor_dev->lock, flags);
 	monitor_dev->hw.dma_irq_flag = 1;
+	monitor_dev->hw.dma_busy = 0;
+	spin_unlock_irqrestore(&monitor_dev->lock, flags);
+	// Inform poll() queue (and any ioctl() waiting for the DMA engine)
 	wake_up(&monitor_dev->queue);
 	dev_info(monitor_dev->dev,"[+] monitor_dma_callback()");
 }
 
-// DMA transfer function
-static int monitor_dma_transfer(struct monitor_device *monitor_dev, dma_addr_t dst, dma_addr_t src, size_t len) {
+// Reserve the DMA engine for a new transfer (sleeps while another one is in flight)
+static int monitor_dma_reserve(struct monitor_device *monitor_dev) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&monitor_dev->lock, flags);
+    while (monitor_dev->hw.dma_busy) {
+        spin_unlock_irqrestore(&monitor_dev->lock, flags);
+        if (wait_event_interruptible(monitor_dev->queue, !READ_ONCE(monitor_dev->hw.dma_busy)))
+            return -ERESTARTSYS;
+        spin_lock_irqsave(&monitor_dev->lock, flags);
+    }
+    // Completion of the previous transfer is no longer reported from now on
+    monitor_dev->hw.dma_busy = 1;
+    monitor_dev->hw.dma_irq_flag = 0;
+    spin_unlock_irqrestore(&monitor_dev->lock, flags);
+
+    return 0;
+}
+
+// Give the DMA engine back when a transfer could not be submitted
+static void monitor_dma_unreserve(struct monitor_device *monitor_dev) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&monitor_dev->lock, flags);
+    monitor_dev->hw.dma_busy = 0;
+    spin_unlock_irqrestore(&monitor_dev->lock, flags);
+    wake_up(&monitor_dev->queue);
+}
+
+// DMA transfer function (several back-to-back copies, completion is signaled once)
+static int monitor_dma_transfer_batch(struct monitor_device *monitor_dev, const dma_addr_t *dst, const dma_addr_t *src, const size_t *len, int n) {
     struct dma_device *dma_dev = monitor_dev->chan->device;
-    struct dma_async_tx_descriptor *tx = NULL;
+    struct dma_async_tx_descriptor *tx[MONITOR_DMA_MAX_BATCH];
+    dma_cookie_t cookie = 0;
 
-    enum dma_ctrl_flags flags = DMA_CTRL_ACK | DMA_PREP_INTERRUPT;
+    enum dma_ctrl_flags flags;
     int res = 0;
+    int i;
 
     dev_info(dma_dev->dev, "[ ] DMA transfer");
-    dev_info(dma_dev->dev, "[i] source address      = %p", (void *)src);
-    dev_info(dma_dev->dev, "[i] destination address = %p", (void *)dst);
-    dev_info(dma_dev->dev, "[i] transfer length     = %d bytes", len);
-    dev_info(dma_dev->dev, "[i] aligned transfer?   = %d", is_dma_copy_aligned(dma_dev, src, dst, len));
-
-    // Initialize asynchronous DMA descriptor
-    dev_info(dma_dev->dev, "[ ] device_prep_dma_memcpy()");
-    tx = dma_dev->device_prep_dma_memcpy(monitor_dev->chan, dst, src, len, flags);
-    if (!tx) {
-        dev_err(dma_dev->dev, "[X] device_prep_dma_memcpy()");
-        res = -ENOMEM;
-        goto err_tx;
+
+    if (n < 1 || n > MONITOR_DMA_MAX_BATCH)
+        return -EINVAL;
+
+    // Initialize asynchronous DMA descriptors
+    for (i = 0; i < n; i++) {
+        dev_info(dma_dev->dev, "[i] #%d source address      = %p", i, (void *)src[i]);
+        dev_info(dma_dev->dev, "[i] #%d destination address = %p", i, (void *)dst[i]);
+        dev_info(dma_dev->dev, "[i] #%d transfer length     = %d bytes", i, len[i]);
+        dev_info(dma_dev->dev, "[i] #%d aligned transfer?   = %d", i, is_dma_copy_aligned(dma_dev, src[i], dst[i], len[i]));
+
+        // Only the last descriptor raises an interrupt (channel order is preserved)
+        flags = (i == n - 1) ? (DMA_CTRL_ACK | DMA_PREP_INTERRUPT) : DMA_CTRL_ACK;
+
+        dev_info(dma_dev->dev, "[ ] device_prep_dma_memcpy()");
+        tx[i] = dma_dev->device_prep_dma_memcpy(monitor_dev->chan, dst[i], src[i], len[i], flags);
+        if (!tx[i]) {
+            dev_err(dma_dev->dev, "[X] device_prep_dma_memcpy()");
+            // Descriptors are prepared with DMA_CTRL_ACK (not reusable), so the channel
+            // owns the ones prepared so far and reclaims them when it is terminated
+            dmaengine_terminate_sync(monitor_dev->chan);
+            res = -ENOMEM;
+            goto err_tx;
+        }
+        dev_info(dma_dev->dev, "[+] device_prep_dma_memcpy()");
     }
-    dev_info(dma_dev->dev, "[+] device_prep_dma_memcpy()");
 
     // Set asynchronous DMA transfer callback
-    tx->callback = monitor_dma_callback;
-    tx->callback_param = monitor_dev;
-
-    // Submit DMA transfer
-    dev_info(dma_dev->dev, "[ ] dmaengine_submit()");
-    monitor_dev->cookie = dmaengine_submit(tx);
-    res = dma_submit_error(monitor_dev->cookie);
-    if (res) {
-        dev_err(dma_dev->dev, "[X] dmaengine_submit()");
-        goto err_cookie;
+    tx[n - 1]->callback = monitor_dma_callback;
+    tx[n - 1]->callback_param = monitor_dev;
+
+    // Submit DMA transfers
+    for (i = 0; i < n; i++) {
+        dev_info(dma_dev->dev, "[ ] dmaengine_submit()");
+        cookie = dmaengine_submit(tx[i]);
+        res = dma_submit_error(cookie);
+        if (res) {
+            dev_err(dma_dev->dev, "[X] dmaengine_submit()");
+            dmaengine_terminate_sync(monitor_dev->chan);
+            goto err_tx;
+        }
+        dev_info(dma_dev->dev, "[+] dmaengine_submit()");
     }
-    dev_info(dma_dev->dev, "[+] dmaengine_submit()");
+    monitor_dev->cookie = cookie;
 
-    // Start pending transfers
+    // Start pending transfers (acked descriptors are recycled by the channel once completed)
     dma_async_issue_pending(monitor_dev->chan);
 
-err_cookie:
-    // Free descriptors
-    dmaengine_desc_free(tx);
-
 err_tx:
     dev_info(dma_dev->dev, "[+] DMA transfer");
     return res;
 }
 
+// DMA transfer function
+static int monitor_dma_transfer(struct monitor_device *monitor_dev, dma_addr_t dst, dma_addr_t src, size_t len) {
+
+    return monitor_dma_transfer_batch(monitor_dev, &dst, &src, &len, 1);
+
+}
+
 // Set up DMA subsystem
 static int monitor_dma_init(struct platform_device *pdev) {
     int res;
@@ -255,16 +316,67 @@ monitor_release(struct inode *inodep, struct file *file)
     return 0;
 }
 
+// Validate a DMA token and translate it into physical addresses (monitor_dev->mutex must be held)
+static int monitor_dma_lookup(struct monitor_device *monitor_dev, struct dmaproxy_token *token, const char *region, dma_addr_t *dst, dma_addr_t *src) {
+    struct monitor_vm_list *vm_list, *backup;
+    struct platform_device *pdev = monitor_dev->pdev;
+    resource_size_t address, size;
+    struct resource *rsrc;
+
+    dev_info(monitor_dev->dev, "[i] DMA from hardware (%s) to memory", region);
+    dev_info(monitor_dev->dev, "[i] DMA -> memory address   = %p", token->memaddr);
+    dev_info(monitor_dev->dev, "[i] DMA -> memory offset    = %p", (void *)token->memoff);
+    dev_info(monitor_dev->dev, "[i] DMA -> hardware address = %p", token->hwaddr);
+    dev_info(monitor_dev->dev, "[i] DMA -> hardware offset  = %p", (void *)token->hwoff);
+    dev_info(monitor_dev->dev, "[i] DMA -> transfer size    = %d bytes", token->size);
+
+    // Search if the requested memory region is allocated
+    list_for_each_entry_safe(vm_list, backup, &monitor_dev->head, list) {
+        if ((vm_list->pid == current->tgid) && (vm_list->addr_usr == token->memaddr)) {
+            // Memory check
+            if (vm_list->size < (token->memoff + token->size)) {
+                dev_err(monitor_dev->dev, "[X] DMA -> requested transfer out of memory region");
+                return -EINVAL;
+            }
+            // Get resource info
+            rsrc = platform_get_resource_byname(monitor_dev->pdev, IORESOURCE_MEM, region);
+            dev_info(&pdev->dev, "[i] resource name  = %s", rsrc->name);
+            dev_info(&pdev->dev, "[i] resource start = %lx", rsrc->start);
+            dev_info(&pdev->dev, "[i] resource end   = %lx", rsrc->end);
+            // Get memory map base address and size
+            address = rsrc->start;
+            size = rsrc->end - rsrc->start + 1;
+            // Hardware check
+            if (size < (token->hwoff + token->size)) {
+                dev_err(monitor_dev->dev, "[X] DMA Slave -> requested transfer out of hardware region");
+                return -EINVAL;
+            }
+            // Address check
+            dev_info(monitor_dev->dev, "[i] hardware memory map start = %x", address);
+            if ((void *)address != token->hwaddr) {
+                dev_err(monitor_dev->dev, "[X] DMA Slave -> hardware address does not match");
+                return -EINVAL;
+            }
+            *dst = vm_list->addr_phy + token->memoff;
+            *src = address + token->hwoff;
+            return 0;
+        }
+    }
+
+    dev_err(monitor_dev->dev, "[X] DMA -> memory region not found");
+    return -EINVAL;
+}
+
 // File operation on char device: ioctl
 static long monitor_ioctl(struct file *fp, unsigned int cmd, unsigned long arg) {
     struct monitor_device *monitor_dev = fp->private_data;
-    struct monitor_vm_list *vm_list, *backup;
     struct dmaproxy_token token;
-    struct platform_device *pdev = monitor_dev->pdev;
-    resource_size_t address, size;
+    struct dmaproxy_drain drain;
+    dma_addr_t dst[MONITOR_DMA_MAX_BATCH], src[MONITOR_DMA_MAX_BATCH];
+    size_t len[MONITOR_DMA_MAX_BATCH];
+    int n = 0;
     int res;
     int retval = 0;
-    struct resource *rsrc;
 
     dev_info(monitor_dev->dev, "[ ] ioctl()");
     dev_info(monitor_dev->dev, "[i] ioctl() -> magic   = '%c'", _IOC_TYPE(cmd));
@@ -286,9 +398,7 @@ static long monitor_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
     switch (cmd) {
 
         case MONITOR_IOC_DMA_HW2MEM_POWER:
-
-            // Lock mutex (released in monitor_poll() after DMA transfer)
-            mutex_lock(&monitor_dev->mutex);
+        case MONITOR_IOC_DMA_HW2MEM_TRACES:
 
             // Copy data from user
             dev_info(monitor_dev->dev, "[ ] copy_from_user()");
@@ -299,106 +409,69 @@ static long monitor_ioctl(struct file *fp, unsigned int cmd, unsigned long arg)
             }
             dev_info(monitor_dev->dev, "[+] copy_from_user() -> token");
 
-            dev_info(monitor_dev->dev, "[i] DMA from hardware to memory");
-            dev_info(monitor_dev->dev, "[i] DMA -> memory address   = %p", token.memaddr);
-            dev_info(monitor_dev->dev, "[i] DMA -> memory offset    = %p", (void *)token.memoff);
-            dev_info(monitor_dev->dev, "[i] DMA -> hardware address = %p", token.hwaddr);
-            dev_info(monitor_dev->dev, "[i] DMA -> hardware offset  = %p", (void *)token.hwoff);
-            dev_info(monitor_dev->dev, "[i] DMA -> transfer size    = %d bytes", token.size);
-
-            // Search if the requested memory region is allocated
-            list_for_each_entry_safe(vm_list, backup, &monitor_dev->head, list) {
-                if ((vm_list->pid == current->pid) && (vm_list->addr_usr == token.memaddr)) {
-                    // Memory check
-                    if (vm_list->size < (token.memoff + token.size)) {
-                        dev_err(monitor_dev->dev, "[X] DMA -> requested transfer out of memory region");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Get resource info
-                    rsrc = platform_get_resource_byname(monitor_dev->pdev, IORESOURCE_MEM, "power");
-                    dev_info(&pdev->dev, "[i] resource name  = %s", rsrc->name);
-                    dev_info(&pdev->dev, "[i] resource start = %lx", rsrc->start);
-                    dev_info(&pdev->dev, "[i] resource end   = %lx", rsrc->end);
-                    // Get memory map base address and size
-                    address = rsrc->start;
-                    size = rsrc->end - rsrc->start + 1;
-                    // Hardware check
-                    if (size < (token.hwoff + token.size)) {
-                        dev_err(monitor_dev->dev, "[X] DMA Slave -> requested transfer out of hardware region");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Address check
-                    dev_info(monitor_dev->dev, "[i] hardware memory map start = %x", address);
-                    if ((void *)address != token.hwaddr) {
-                        dev_err(monitor_dev->dev, "[X] DMA Slave -> hardware address does not match");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Perform transfer
-                    retval = monitor_dma_transfer(monitor_dev, vm_list->addr_phy + token.memoff, address + token.hwoff, token.size);
-                    break;
-                }
+            // Reserve DMA engine (released in monitor_dma_callback() after DMA transfer)
+            res = monitor_dma_reserve(monitor_dev);
+            if (res) {
+                return res;
             }
 
-            break;
+            // Critical section: translate the requested memory region
+            mutex_lock(&monitor_dev->mutex);
+            retval = monitor_dma_lookup(monitor_dev, &token, (cmd == MONITOR_IOC_DMA_HW2MEM_POWER) ? "power" : "traces", &dst[0], &src[0]);
+            if (!retval) {
+                // Perform transfer
+                retval = monitor_dma_transfer(monitor_dev, dst[0], src[0], token.size);
+            }
+            mutex_unlock(&monitor_dev->mutex);
 
-        case MONITOR_IOC_DMA_HW2MEM_TRACES:
+            // No transfer was issued, the DMA engine is free again
+            if (retval) {
+                monitor_dma_unreserve(monitor_dev);
+            }
 
-            // Lock mutex (released in monitor_poll() after DMA transfer)
-            mutex_lock(&monitor_dev->mutex);
+            break;
+
+        case MONITOR_IOC_DMA_HW2MEM_DRAIN:
 
             // Copy data from user
             dev_info(monitor_dev->dev, "[ ] copy_from_user()");
-            res = copy_from_user(&token, (void *)arg, sizeof token);
+            res = copy_from_user(&drain, (void *)arg, sizeof drain);
             if (res) {
                 dev_err(monitor_dev->dev, "[X] copy_from_user()");
                 return -ENOMEM;
             }
-            dev_info(monitor_dev->dev, "[+] copy_from_user() -> token");
+            dev_info(monitor_dev->dev, "[+] copy_from_user() -> drain");
+
+            if (!drain.power.size && !drain.traces.size) {
+                dev_err(monitor_dev->dev, "[X] ioctl() -> empty drain request");
+                return -EINVAL;
+            }
 
-            dev_info(monitor_dev->dev, "[i] DMA from hardware to memory");
-            dev_info(monitor_dev->dev, "[i] DMA -> memory address   = %p", token.memaddr);
-            dev_info(monitor_dev->dev, "[i] DMA -> memory offset    = %p", (void *)token.memoff);
-            dev_info(monitor_dev->dev, "[i] DMA -> hardware address = %p", token.hwaddr);
-            dev_info(monitor_dev->dev, "[i] DMA -> hardware offset  = %p", (void *)token.hwoff);
-            dev_info(monitor_dev->dev, "[i] DMA -> transfer size    = %d bytes", token.size);
-
-            // Search if the requested memory region is allocated
-            list_for_each_entry_safe(vm_list, backup, &monitor_dev->head, list) {
-                if ((vm_list->pid == current->pid) && (vm_list->addr_usr == token.memaddr)) {
-                    // Memory check
-                    if (vm_list->size < (token.memoff + token.size)) {
-                        dev_err(monitor_dev->dev, "[X] DMA -> requested transfer out of memory region");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Get resource info
-                    rsrc = platform_get_resource_byname(monitor_dev->pdev, IORESOURCE_MEM, "traces");
-                    dev_info(&pdev->dev, "[i] resource name  = %s", rsrc->name);
-                    dev_info(&pdev->dev, "[i] resource start = %lx", rsrc->start);
-                    dev_info(&pdev->dev, "[i] resource end   = %lx", rsrc->end);
-                    // Get memory map base address and size
-                    address = rsrc->start;
-                    size = rsrc->end - rsrc->start + 1;
-                    // Hardware check
-                    if (size < (token.hwoff + token.size)) {
-                        dev_err(monitor_dev->dev, "[X] DMA Slave -> requested transfer out of hardware region");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Address check
-                    dev_info(monitor_dev->dev, "[i] hardware memory map start = %x", address);
-                    if ((void *)address != token.hwaddr) {
-                        dev_err(monitor_dev->dev, "[X] DMA Slave -> hardware address does not match");
-                        retval = -EINVAL;
-                        break;
-                    }
-                    // Perform transfer
-                    retval = monitor_dma_transfer(monitor_dev, vm_list->addr_phy + token.memoff, address + token.hwoff, token.size);
-                    break;
-                }
+            // Reserve DMA engine (released in monitor_dma_callback() after both DMA transfers)
+            res = monitor_dma_reserve(monitor_dev);
+            if (res) {
+                return res;
+            }
+
+            // Critical section: translate the requested memory regions
+            mutex_lock(&monitor_dev->mutex);
+            if (drain.power.size) {
+                retval = monitor_dma_lookup(monitor_dev, &drain.power, "power", &dst[n], &src[n]);
+                len[n++] = drain.power.size;
+            }
+            if (!retval && drain.traces.size) {
+                retval = monitor_dma_lookup(monitor_dev, &drain.traces, "traces", &dst[n], &src[n]);
+                len[n++] = drain.traces.size;
+            }
+            if (!retval) {
+                // Queue both transfers back-to-back, completion is signaled once
+                retval = monitor_dma_transfer_batch(monitor_dev, dst, src, len, n);
+            }
+            mutex_unlock(&monitor_dev->mutex);
+
+            // No transfer was issued, the DMA engine is free again
+            if (retval) {
+                monitor_dma_unreserve(monitor_dev);
             }
 
             break;
@@ -424,6 +497,13 @@ static void monitor_mmap_dma_close(struct vm_area_struct *vma) {
     dev_info(monitor_dev->dev, "[i] vma->vm_end   = %p", (void *)vma->vm_end);
     dev_info(monitor_dev->dev, "[i] vma size      = %ld bytes", vma->vm_end - vma->vm_start);
 
+    // A transfer may still be writing into this buffer (e.g., closed after an asynchronous read)
+    if (!wait_event_timeout(monitor_dev->queue, !READ_ONCE(monitor_dev->hw.dma_busy), msecs_to_jiffies(MONITOR_DMA_CLOSE_TIMEOUT_MS))) {
+        dev_err(monitor_dev->dev, "[X] munmap() -> DMA transfer still in flight, terminating it");
+        dmaengine_terminate_sync(monitor_dev->chan);
+        monitor_dma_unreserve(monitor_dev);
+    }
+
     dma_free_coherent(dma_dev->dev, token->size, token->addr_ker, token->addr_phy);
 
     // Critical section: remove region from dynamic list
@@ -498,7 +578,7 @@ static int monitor_mmap_dma(struct file *fp, struct vm_area_struct *vma) {
     token->addr_ker = addr_vir;
     token->addr_phy = addr_phy;
     token->size = vma->vm_end - vma->vm_start;
-    token->pid = current->pid;
+    token->pid = current->tgid;
     //INIT_LIST_HEAD(&token->list); No tiene sentido crear esta lista
 
     // Critical section: add new region to dynamic list
@@ -596,22 +676,25 @@ static unsigned int monitor_poll(struct file *fp, struct poll_table_struct *wait
         // NOTE: this implementation does not consider errors in the data
         //       transfers.  If the callback is executed, it is assumed
         //       that the following check will always render DMA_COMPLETE.
+        //
+        //       POLLDMA is level-triggered: it is reported until the next
+        //       transfer is submitted, so that the same completion can be
+        //       observed by epoll()/select() and then by a blocking poll().
         status = dma_async_is_tx_complete(monitor_dev->chan, monitor_dev->cookie, NULL, NULL);
         if (monitor_dev->hw.dma_irq_flag == 1 && status == DMA_COMPLETE) {
             dev_info(monitor_dev->dev, "[i] poll() : ret |= POLLDMA");
             ret |= POLLDMA;
-		    monitor_dev->hw.dma_irq_flag = 0;
-            // Release mutex (acquired in monitor_ioctl() before DMA transfer)
-            mutex_unlock(&monitor_dev->mutex);
         }
 
         //
         // IRQ/Ready check
         //
+        // NOTE: the done event is only consumed by callers waiting for it
 		if (monitor_dev->hw.done_bit == 1) {
             dev_info(monitor_dev->dev, "[i] poll() : ret |= POLLIRQ");
             ret |= POLLIRQ;
-			monitor_dev->hw.done_bit = 0;
+            if (poll_requested_events(wait) & POLLIRQ)
+                monitor_dev->hw.done_bit = 0;
         }
     spin_unlock_irqrestore(&monitor_dev->lock, flags);
 
@@ -637,8 +720,15 @@ static int monitor_cdev_create(struct platform_device *pdev) {
 
     dev_info(&pdev->dev, "[ ] monitor_cdev_create()");
 
+    // Get a free instance identifier (used as minor number)
+    monitor_dev->id = ida_alloc_max(&monitor_ida, MONITOR_MAX_DEVICES - 1, GFP_KERNEL);
+    if (monitor_dev->id < 0) {
+        dev_err(&pdev->dev, "[X] ida_alloc_max() -> no free Monitor instance");
+        return monitor_dev->id;
+    }
+
     // Set device structure parameters
-    monitor_dev->devt = MKDEV(MAJOR(devt), 1);
+    monitor_dev->devt = MKDEV(MAJOR(devt), MINOR(devt) + monitor_dev->id);
 
     // Add char device to the system
     dev_info(&pdev->dev, "[ ] cdev_add()");
@@ -646,13 +736,18 @@ static int monitor_cdev_create(struct platform_device *pdev) {
     res = cdev_add(&monitor_dev->cdev, monitor_dev->devt, 1);
     if (res) {
         dev_err(&pdev->dev, "[X] cdev_add() -> %d:%d", MAJOR(monitor_dev->devt), MINOR(monitor_dev->devt));
-        return res;
+        goto err_cdev;
     }
     dev_info(&pdev->dev, "[+] cdev_add() -> %d:%d", MAJOR(monitor_dev->devt), MINOR(monitor_dev->devt));
 
-    // Create char device (initialization)
+    // Create char device (first instance keeps the /dev/monitor name, the rest are /dev/monitor<id>)
     dev_info(&pdev->dev, "[ ] device_create()");
-    monitor_dev->dev = device_create(monitor_class, &pdev->dev, monitor_dev->devt, monitor_dev, "%s", DRIVER_NAME);
+    if (monitor_dev->id == 0) {
+        monitor_dev->dev = device_create(monitor_class, &pdev->dev, monitor_dev->devt, monitor_dev, "%s", DRIVER_NAME);
+    }
+    else {
+        monitor_dev->dev = device_create(monitor_class, &pdev->dev, monitor_dev->devt, monitor_dev, "%s%d", DRIVER_NAME, monitor_dev->id);
+    }
     if (IS_ERR(monitor_dev->dev)) {
         dev_err(&pdev->dev, "[X] device_create() -> %d:%d", MAJOR(monitor_dev->devt), MINOR(monitor_dev->devt));
         res = PTR_ERR(monitor_dev->dev);
@@ -666,6 +761,9 @@ static int monitor_cdev_create(struct platform_device *pdev) {
 
 err_device:
     cdev_del(&monitor_dev->cdev);
+
+err_cdev:
+    ida_free(&monitor_ida, monitor_dev->id);
     return res;
 }
 
@@ -682,6 +780,7 @@ static void monitor_cdev_destroy(struct platform_device *pdev) {
     // Destroy device
     device_destroy(monitor_class, monitor_dev->devt);
     cdev_del(&monitor_dev->cdev);
+    ida_free(&monitor_ida, monitor_dev->id);
 
     dev_info(&pdev->dev, "[+] monitor_cdev_destroy()");
 }
@@ -695,13 +794,13 @@ static int monitor_cdev_init(void) {
 
     // Dynamically allocate major number for char device
     pr_info("[%s] [ ] alloc_chrdev_region()\n", DRIVER_NAME);
-    res = alloc_chrdev_region(&devt, 0, 1, DRIVER_NAME);
+    res = alloc_chrdev_region(&devt, 0, MONITOR_MAX_DEVICES, DRIVER_NAME);
     if (res < 0) {
         pr_err("[%s] [X] alloc_chrdev_region()\n", DRIVER_NAME);
         return res;
     }
 
-    pr_info("[%s] [+] alloc_chrdev_region()-> %d:%d-%d\n", DRIVER_NAME, MAJOR(devt), MINOR(devt), MINOR(devt));
+    pr_info("[%s] [+] alloc_chrdev_region()-> %d:%d-%d\n", DRIVER_NAME, MAJOR(devt), MINOR(devt), MINOR(devt) + MONITOR_MAX_DEVICES - 1);
 
     // create sysfs class
     pr_info("[%s] [ ] class_create()\n", DRIVER_NAME);
@@ -724,7 +823,7 @@ static int monitor_cdev_init(void) {
     return 0;
 
 err_class:
-    unregister_chrdev_region(devt, 1);
+    unregister_chrdev_region(devt, MONITOR_MAX_DEVICES);
     return res;
 }
 
@@ -737,7 +836,7 @@ static void monitor_cdev_exit(void) {
     class_destroy(monitor_class);
 
     // Unregister char device
-    unregister_chrdev_region(devt, 1);
+    unregister_chrdev_region(devt, MONITOR_MAX_DEVICES);
 
     pr_info("[%s] [+] monitor_cdev_exit()\n", DRIVER_NAME);
 }
@@ -757,7 +856,7 @@ static int monitor_probe(struct platform_device *pdev) {
     monitor_dev = kmalloc(sizeof *monitor_dev, GFP_KERNEL);
     if (!monitor_dev) {
         dev_err(&pdev->dev, "[X] kmalloc() -> monitor_dev");
-        res = -ENOMEM;
+        return -ENOMEM;
     }
     dev_info(&pdev->dev, "[+] kmalloc() -> monitor_dev");
 
@@ -805,6 +904,7 @@ static int monitor_probe(struct platform_device *pdev) {
 
     // DMA IRQ flag initialization
     monitor_dev->hw.dma_irq_flag = 0;
+    monitor_dev->hw.dma_busy = 0;
 
     // You can do an initialization of the regs (maybe place a triggering mask)
     dev_info(&pdev->dev, "[+] ioremap()");
@@ -817,7 +917,7 @@ static int monitor_probe(struct platform_device *pdev) {
     // dev_info(&pdev->dev, "[i] resource end   = %lx", rsrc->end);
     // monitor_dev->irq = rsrc->start;
     monitor_dev->irq = platform_get_irq_byname(monitor_dev->pdev, "irq");  // Workaround to platform_get_resource_byname()
-    res = request_irq(monitor_dev->irq, (irq_handler_t)monitor_isr, IRQF_TRIGGER_RISING, "monitor", monitor_dev);
+    res = request_irq(monitor_dev->irq, (irq_handler_t)monitor_isr, IRQF_TRIGGER_RISING, dev_name(monitor_dev->dev), monitor_dev);
     if (res) {
         dev_err(&pdev->dev, "[X] request_irq()");
         goto err_irq;
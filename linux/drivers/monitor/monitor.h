@@ -41,11 +41,25 @@ struct dmaproxy_token {
     size_t size;
 };
 
+/*
+ * Data structure to drain both Monitor memory banks with a single ioctl()
+ *
+ * @power  - power region transfer (size 0 to skip it)
+ * @traces - traces region transfer (size 0 to skip it)
+ *
+ */
+struct dmaproxy_drain {
+    struct dmaproxy_token power;
+    struct dmaproxy_token traces;
+};
+
 /*
  * IOCTL definitions for DMA proxy devices
  *
  * dma_hw2mem_power  - start transfer from power region of the hardware device to main memory
  * dma_hw2mem_traces - start transfer from traces region of the hardware device to main memory
+ * dma_hw2mem_drain  - start back-to-back transfers from power and traces regions to main memory
+ *                     (POLLDMA is signaled once, after both of them)
  *
  */
 
@@ -53,8 +67,9 @@ struct dmaproxy_token {
 
 #define MONITOR_IOC_DMA_HW2MEM_POWER  _IOW(MONITOR_IOC_MAGIC, 0, struct dmaproxy_token)
 #define MONITOR_IOC_DMA_HW2MEM_TRACES _IOW(MONITOR_IOC_MAGIC, 1, struct dmaproxy_token)
+#define MONITOR_IOC_DMA_HW2MEM_DRAIN  _IOW(MONITOR_IOC_MAGIC, 2, struct dmaproxy_drain)
 
-#define MONITOR_IOC_MAXNR 1
+#define MONITOR_IOC_MAXNR 2
 
 
 /*